@@ -24,6 +24,7 @@
 #include "../Audio/UI/PluginWindow.h"
 #include "../Audio/Filters/InternalFilters.h"
 #include "../Utilities/CabbageStrings.h"
+#include "../Utilities/CabbageTrace.h"
 
 class CabbageMainComponent::PluginListWindow  : public DocumentWindow
 {
@@ -111,6 +112,9 @@ wildcardFilter(new WildcardFileFilter("*.csd;*.sco;*.orc;*.txt;*.js;*.html;*.sna
         knownPluginList.addType (t);
     
     pluginSortMethod = (KnownPluginList::SortMethod) cabbageSettings->getUserSettings()->getIntValue ("pluginSortMethod", KnownPluginList::sortByManufacturer);
+
+    if (cabbageSettings->getUserSettings()->getBoolValue ("EnableTracing"))
+        CabbageTrace::setEnabled (true);
     
     knownPluginList.addChangeListener (this);
     
@@ -1112,6 +1116,8 @@ void CabbageMainComponent::createFilterGraph()
 	graphComponent->setSize(600, 400);
 	filterGraphWindow->setContentOwned(graphComponent, true);
 	getFilterGraph()->setCabbageSettings(cabbageSettings);
+	//the compile check worker starts up now, so the first play doesn't wait for it
+	compileChecker.launchWorker();
 }
 //==================================================================================
 void CabbageMainComponent::showGraph()
@@ -1998,30 +2004,15 @@ int CabbageMainComponent::sendToPort()
 
 int CabbageMainComponent::testFileForErrors (String file)
 {
-    //this method will start a Csound process and test it for i-time errors and possible infinite loops.
-    //It only runs 16 k-cycles, so it will not be able to detect perf-time hangs
-    ChildProcess process;
-    const String applicationDir = File::getSpecialLocation (File::currentExecutableFile).getParentDirectory().getFullPathName();
-    const String processName = applicationDir + "/CabbageCsoundCLI";
+    //this method will compile the file in a separate, resident Cabbage process and test it for i-time errors and
+    //possible infinite loops. It only runs 16 k-cycles, so it will not be able to detect perf-time hangs
+    const CabbageCompileChecker::Diagnostics diagnostics = compileChecker.check (File (file));
 
-    if (File (processName).existsAsFile())
+    if (! diagnostics.passed)
     {
-        const String output = process.readAllProcessOutput();
-
-        process.start (processName + " " + file);
-        process.waitForProcessToFinish(400);
-
-        const int exitCode = process.getExitCode();
-
-        if (exitCode == 1)
-        {
-            process.start ("csound " + file);
-            this->getCurrentOutputConsole()->setText (process.readAllProcessOutput());
-            stopCsoundForNode (file);
-            return 1;
-        }
-
-        process.kill();
+        this->getCurrentOutputConsole()->setText (diagnostics.output + diagnostics.getSummary());
+        stopCsoundForNode (file);
+        return 1;
     }
 
     return 0;
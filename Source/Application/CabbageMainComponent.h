@@ -38,6 +38,7 @@
 #include "../Audio/Plugins/GenericCabbagePluginProcessor.h"
 #include "../Audio/Plugins/CabbageInternalPluginFormat.h"
 #include "../Utilities/CabbagePluginList.h"
+#include "../Utilities/CabbageCompileChecker.h"
 
 class CabbageDocumentWindow;
 class FileTab;
@@ -294,6 +295,7 @@ private:
     std::unique_ptr<FindPanel> findPanel;
     bool shouldRecord = false;
     int bitDepth = 32;
+    CabbageCompileChecker compileChecker;
 
     GraphDocumentComponent* graphComponent = nullptr;
     std::unique_ptr<FilterGraphDocumentWindow> filterGraphWindow;
@@ -31,6 +31,7 @@
 #include "../../Settings/CabbageSettings.h"
 #include "../Plugins/CabbagePluginProcessor.h"
 #include "../Plugins/GenericCabbagePluginProcessor.h"
+#include "ParallelProcessorGraph.h"
 
 
 
@@ -42,7 +43,6 @@ class FilterGraph   : public FileBasedDocument,
                       public AudioProcessorListener,
                       private ChangeListener,
                       //RW
-                      public HighResolutionTimer,
                       public AudioPlayHead
 {
 
@@ -296,112 +296,116 @@ public:
 
     //RW
     CabbageSettings* settings;
-	int currentBPM = 60;
-	float PPQN = 24;
-	double ppqPosition = 1;
-	double subTicks = 0;
-	double timeInSeconds = 0;
-	bool isPlaying = false;
-	bool isLooping = false;
-	bool isRecording = false;
-
 	void bringAllPluginWindowsToFront()
 	{
 		for (auto* w : activePluginWindows)
 			w->toFront(true);
 	}
 
+    //==============================================================================
+    // IDE transport. Position is derived from the number of samples the graph has
+    // actually processed, see advancePlayHead(), so instruments see the same clock
+    // as the audio. The transport component only sets and displays it.
     bool getCurrentPosition (CurrentPositionInfo &result) override
     {
+        const SpinLock::ScopedLockType sl (playHeadLock);
         result = playHeadPositionInfo;
         return true;
     }
 
-    void setPlayHeadInfo(CurrentPositionInfo info)
+    CurrentPositionInfo getPlayHeadInfo()
     {
-        playHeadPositionInfo = info;
+        CurrentPositionInfo info;
+        getCurrentPosition (info);
+        return info;
     }
 
-    void setIsPlaying(bool val)
+    void setPlayHeadInfo(CurrentPositionInfo info)
     {
-        playHeadPositionInfo.isPlaying=val;
+        const SpinLock::ScopedLockType sl (playHeadLock);
+        playHeadPositionInfo = info;
     }
 
     void setIsRecording(bool val)
     {
+        const SpinLock::ScopedLockType sl (playHeadLock);
         playHeadPositionInfo.isRecording=val;
     }
 
-    void setTimeInSeconds(double val)
-    {
-        playHeadPositionInfo.timeInSeconds=val;
-    }
-
-    double getTimeInSeconds()
-    {
-        return playHeadPositionInfo.timeInSeconds;
-    }
-
-    void setPPQPosition(double val)
-    {
-        playHeadPositionInfo.ppqPosition=val;
-    }
-    int getPPQPosition()
-    {
-        return playHeadPositionInfo.ppqPosition;
-    }
+    //tempo changes come from the message thread, which has no sample position of its own, so
+    //they take effect from the first sample of the next block the graph processes. The playhead
+    //reports a single tempo per block, so that is also the earliest sample an instrument could see it
+	void setBPM(int bpm)
+	{
+        const SpinLock::ScopedLockType sl (playHeadLock);
+        playHeadPositionInfo.bpm = bpm;
+	}
 
-    void setBpm(int bpm)
+    //loop range in quarter notes. The audio callback splits blocks at the loop end, see advancePlayHead()
+    void setLoopRange(double ppqLoopStart, double ppqLoopEnd, bool isLooping)
     {
-        playHeadPositionInfo.bpm = bpm;
+        const SpinLock::ScopedLockType sl (playHeadLock);
+        playHeadPositionInfo.ppqLoopStart = ppqLoopStart;
+        playHeadPositionInfo.ppqLoopEnd = ppqLoopEnd;
+        playHeadPositionInfo.isLooping = isLooping && ppqLoopEnd > ppqLoopStart;
     }
 
-	void setBPM(int bpm)
+	void setIsHostPlaying(bool value, bool reset)
 	{
-		currentBPM = bpm;
-		setBpm(bpm);
+        const SpinLock::ScopedLockType sl (playHeadLock);
+        playHeadPositionInfo.isPlaying = value;
 
-		if(isTimerRunning())
+		if(reset==true)
 		{
-			stopTimer();
-			startTimer(10);
+            playHeadPositionInfo.timeInSamples = 0;
+            playHeadPositionInfo.timeInSeconds = 0;
+            playHeadPositionInfo.ppqPosition = 0;
+            playHeadPositionInfo.ppqPositionOfLastBarStart = 0;
+            samplesInLastBlock = 0;
 		}
 	}
 
-	void hiResTimerCallback() override
-	{
-		timeInSeconds+=(getTimerInterval()/1000.f);
-		setTimeInSeconds(timeInSeconds);
-        ppqPosition+=((float)getTimerInterval()/(1000.f)*(currentBPM/60));
-		setPPQPosition(ppqPosition);
-        playHeadPositionInfo.timeInSamples = timeInSeconds*graph.getSampleRate();
-		subTicks = (subTicks >= 1 ? 0 : (subTicks+(getTimerInterval()*0.001)*currentBPM/60));
-	}
+    //called from the audio callback before each block is processed. Moves the playhead on by
+    //the block that was just processed, at the tempo that block was processed with, and wraps it
+    //back to the loop start once it reaches the loop end. Returns how many of numSamples should be
+    //processed next: fewer than numSamples when the loop end falls inside the block, so that the
+    //caller can process the rest as a new block that starts at the loop start
+    int advancePlayHead(int numSamples)
+    {
+        const SpinLock::ScopedLockType sl (playHeadLock);
+        auto& info = playHeadPositionInfo;
+        const double sampleRate = graph.getSampleRate();
 
-	void setIsHostPlaying(bool value, bool reset)
-	{
-		setIsPlaying(value);
-		if(value == true)
-		{
-			startTimer(10);
-		}
-		else
-			stopTimer();
+        if (samplesInLastBlock > 0 && sampleRate > 0)
+        {
+            info.timeInSamples += samplesInLastBlock;
+            info.timeInSeconds = info.timeInSamples / sampleRate;
+            info.ppqPosition += samplesInLastBlock * bpmOfLastBlock / (60.0 * sampleRate);
 
-		if(reset==true)
-		{
-			timeInSeconds=0;
-			setPPQPosition(0);
-			setTimeInSeconds(0);
-			ppqPosition=0;
-			timeInSeconds=0;
+            if (info.isLooping && info.ppqPosition >= info.ppqLoopEnd)
+                info.ppqPosition = info.ppqLoopStart + std::fmod (info.ppqPosition - info.ppqLoopStart, info.ppqLoopEnd - info.ppqLoopStart);
 
-		}
-	}
+            const double quarterNotesPerBar = info.timeSigNumerator * 4.0 / jmax (1, info.timeSigDenominator);
+            info.ppqPositionOfLastBarStart = std::floor (info.ppqPosition / quarterNotesPerBar) * quarterNotesPerBar;
+        }
+
+        int samplesToProcess = numSamples;
+
+        if (info.isPlaying && info.isLooping && info.bpm > 0 && sampleRate > 0 && info.ppqPosition < info.ppqLoopEnd)
+        {
+            const double samplesToLoopEnd = std::ceil ((info.ppqLoopEnd - info.ppqPosition) * 60.0 * sampleRate / info.bpm);
+            samplesToProcess = (int) jlimit (1.0, (double) numSamples, samplesToLoopEnd);
+        }
+
+        samplesInLastBlock = info.isPlaying ? samplesToProcess : 0;
+        bpmOfLastBlock = info.bpm;
+        return samplesToProcess;
+    }
 
     void setCabbageSettings(CabbageSettings* cabbageSettings)
     {
         settings = cabbageSettings;
+        graph.setParallelProcessingEnabled (settings->getUserSettings()->getIntValue ("ParallelGraphProcessing", 1) == 1);
     }
 
 	void addCabbagePlugin(const PluginDescription& desc, juce::Point<double> pos)
@@ -565,7 +569,7 @@ public:
     static File getDefaultGraphDocumentOnMobile();
 
     //==============================================================================
-    AudioProcessorGraph graph;
+    ParallelProcessorGraph graph;
 	OwnedArray<PluginWindow> activePluginWindows;
 private:
     //==============================================================================
@@ -575,6 +579,9 @@ private:
     NodeID getNextUID() noexcept;
 //RW
     AudioPlayHead::CurrentPositionInfo playHeadPositionInfo;
+    SpinLock playHeadLock;
+    int samplesInLastBlock = 0;
+    double bpmOfLastBlock = 60;
     void createNodeFromXml (const XmlElement& xml);
     void addFilterCallback (AudioPluginInstance*, const String& error, juce::Point<double>);
     void changeListenerCallback (ChangeBroadcaster*) override;
@@ -0,0 +1,552 @@
+/*
+  Copyright (C) 2016 Rory Walsh
+
+  Cabbage is free software; you can redistribute it
+  and/or modify it under the terms of the GNU General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  Cabbage is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public
+  License along with Csound; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+  02111-1307 USA
+*/
+
+#include "ParallelProcessorGraph.h"
+#include "../Plugins/CsoundPluginProcessor.h"
+
+//==============================================================================
+// A snapshot of the graph, built on the message thread whenever its topology
+// changes. Every node gets its own buffers, so nodes in the same level never
+// share memory, and inputs are summed from their sources in connection order.
+// A source with less latency than the node's other inputs is delayed to match,
+// in a delay line that only the node it feeds ever touches.
+struct ParallelProcessorGraph::Schedule
+{
+    struct AudioSource
+    {
+        int sourceNode, sourceChannel, destChannel;
+        int delaySamples = 0, delayPosition = 0;
+        std::vector<float> delayLine;
+    };
+
+    struct ScheduledNode
+    {
+        Node::Ptr node;
+        AudioProcessor* processor = nullptr;
+        int ioType = -1;
+        int numInputs = 0, numOutputs = 0, numBufferChannels = 0;
+        int firstAudioSource = 0, numAudioSources = 0;
+        int firstMidiSource = 0, numMidiSources = 0;
+        int level = -1;
+        //this node's latency plus the most that any of its inputs arrive with
+        int totalLatency = 0;
+        bool runsOnWorker = false;
+        AudioBuffer<float> buffer;
+        MidiBuffer midi;
+        std::atomic<float> cpuLoad { -1.f };
+    };
+
+    struct Level
+    {
+        Array<int> audioThreadNodes, workerNodes;
+    };
+
+    OwnedArray<ScheduledNode> nodes;
+    std::vector<AudioSource> audioSources;
+    std::vector<int> midiSources;
+    Array<Level> levels;
+    HashMap<uint32, int> nodeIndexForId;
+    int maxBlockSize = 0;
+    int maxWorkersUseful = 0;
+    double sampleRate = 44100;
+};
+
+//==============================================================================
+class ParallelProcessorGraph::Worker : public Thread
+{
+public:
+    Worker (ParallelProcessorGraph& g, int index)
+        : Thread ("Cabbage graph worker " + String (index)), graph (g) {}
+
+    ~Worker() override
+    {
+        signalThreadShouldExit();
+        wakeUp.signal();
+        stopThread (2000);
+    }
+
+    void run() override
+    {
+        int idleSpins = 0;
+
+        while (! threadShouldExit())
+        {
+            if (graph.processNextNodeInLevel())
+            {
+                idleSpins = 0;
+                continue;
+            }
+
+            //a short spin catches the next level of the same block, after that it waits to be woken
+            if (++idleSpins < 64)
+            {
+                Thread::yield();
+                continue;
+            }
+
+            //the audio thread publishes a level before it checks isSleeping, so with both sequentially
+            //consistent, either it sees this worker asleep and signals, or the level is seen here
+            isSleeping.store (true);
+
+            if (! graph.hasNodeToClaim())
+                wakeUp.wait (10);
+
+            isSleeping.store (false);
+            idleSpins = 0;
+        }
+    }
+
+    void wakeIfSleeping()
+    {
+        if (isSleeping.load())
+            wakeUp.signal();
+    }
+
+private:
+    ParallelProcessorGraph& graph;
+    WaitableEvent wakeUp;
+    std::atomic<bool> isSleeping { false };
+};
+
+//==============================================================================
+ParallelProcessorGraph::ParallelProcessorGraph()
+{
+    addChangeListener (this);
+}
+
+ParallelProcessorGraph::~ParallelProcessorGraph()
+{
+    removeChangeListener (this);
+
+    for (auto* node : getNodes())
+        if (auto* processor = node->getProcessor())
+            processor->removeListener (this);
+
+    scheduleUpdater.cancelPendingUpdate();
+    workers.clear();
+}
+
+void ParallelProcessorGraph::prepareToPlay (double sampleRate, int estimatedSamplesPerBlock)
+{
+    AudioProcessorGraph::prepareToPlay (sampleRate, estimatedSamplesPerBlock);
+    isPreparedForSchedule = true;
+    updateScheduleNowOrLater();
+}
+
+void ParallelProcessorGraph::releaseResources()
+{
+    isPreparedForSchedule = false;
+    updateScheduleNowOrLater();
+    AudioProcessorGraph::releaseResources();
+}
+
+void ParallelProcessorGraph::updateScheduleNowOrLater()
+{
+    //the device can prepare the graph from its own thread, but nodes are only read on the
+    //message thread. Until then, blocks bigger than the old schedule go to AudioProcessorGraph
+    if (MessageManager::existsAndIsCurrentThread())
+        rebuildSchedule();
+    else
+        scheduleUpdater.triggerAsyncUpdate();
+}
+
+void ParallelProcessorGraph::setParallelProcessingEnabled (bool shouldBeEnabled)
+{
+    if (parallelProcessingEnabled != shouldBeEnabled)
+    {
+        parallelProcessingEnabled = shouldBeEnabled;
+        updateWorkers();
+    }
+}
+
+float ParallelProcessorGraph::getNodeCpuLoad (NodeID nodeID) const
+{
+    if (schedule != nullptr && schedule->nodeIndexForId.contains (nodeID.uid))
+        return schedule->nodes.getUnchecked (schedule->nodeIndexForId[nodeID.uid])->cpuLoad.load (std::memory_order_relaxed);
+
+    return -1.f;
+}
+
+void ParallelProcessorGraph::changeListenerCallback (ChangeBroadcaster*)
+{
+    //AudioProcessorGraph prepares new nodes in its own async update, which is already
+    //queued when the change is broadcast, so the schedule is rebuilt after that
+    scheduleUpdater.triggerAsyncUpdate();
+}
+
+void ParallelProcessorGraph::audioProcessorChanged (AudioProcessor*, const ChangeDetails& details)
+{
+    //the delays in the schedule were worked out from the latencies at the time it was built
+    if (details.latencyChanged)
+        scheduleUpdater.triggerAsyncUpdate();
+}
+
+//==============================================================================
+void ParallelProcessorGraph::rebuildSchedule()
+{
+    std::unique_ptr<Schedule> newSchedule;
+
+    if (isPreparedForSchedule)
+    {
+        newSchedule = std::make_unique<Schedule>();
+        auto& s = *newSchedule;
+        s.maxBlockSize = getBlockSize();
+        s.sampleRate = getSampleRate();
+
+        for (auto* node : getNodes())
+        {
+            auto* processor = node->getProcessor();
+
+            if (processor == nullptr)
+            {
+                newSchedule = nullptr;
+                break;
+            }
+
+            processor->addListener (this);
+
+            auto* scheduled = s.nodes.add (new Schedule::ScheduledNode());
+            scheduled->node = node;
+            scheduled->processor = processor;
+            scheduled->numInputs = processor->getTotalNumInputChannels();
+            scheduled->numOutputs = processor->getTotalNumOutputChannels();
+            scheduled->numBufferChannels = jmax (scheduled->numInputs, scheduled->numOutputs);
+            scheduled->buffer.setSize (scheduled->numBufferChannels, s.maxBlockSize);
+            scheduled->midi.ensureSize (2048);
+            scheduled->runsOnWorker = dynamic_cast<CsoundPluginProcessor*> (processor) != nullptr;
+
+            if (auto* ioProcessor = dynamic_cast<AudioGraphIOProcessor*> (processor))
+                scheduled->ioType = (int) ioProcessor->getType();
+
+            s.nodeIndexForId.set (node->nodeID.uid, s.nodes.size() - 1);
+        }
+    }
+
+    if (newSchedule != nullptr)
+    {
+        auto& s = *newSchedule;
+        const auto connections = getConnections();
+
+        for (int i = 0; i < s.nodes.size(); ++i)
+        {
+            auto* scheduled = s.nodes.getUnchecked (i);
+            scheduled->firstAudioSource = (int) s.audioSources.size();
+            scheduled->firstMidiSource = (int) s.midiSources.size();
+
+            for (auto& connection : connections)
+            {
+                if (connection.destination.nodeID != scheduled->node->nodeID
+                    || ! s.nodeIndexForId.contains (connection.source.nodeID.uid))
+                    continue;
+
+                const int sourceNode = s.nodeIndexForId[connection.source.nodeID.uid];
+
+                if (connection.destination.isMIDI())
+                    s.midiSources.push_back (sourceNode);
+                else if (isPositiveAndBelow (connection.destination.channelIndex, scheduled->numInputs)
+                         && isPositiveAndBelow (connection.source.channelIndex, s.nodes.getUnchecked (sourceNode)->numOutputs))
+                    s.audioSources.push_back ({ sourceNode, connection.source.channelIndex, connection.destination.channelIndex });
+            }
+
+            scheduled->numAudioSources = (int) s.audioSources.size() - scheduled->firstAudioSource;
+            scheduled->numMidiSources = (int) s.midiSources.size() - scheduled->firstMidiSource;
+        }
+
+        //a node's level is one more than the deepest of its sources. AudioProcessorGraph
+        //doesn't allow feedback, so each pass settles at least one more node
+        bool levelsChanged = true;
+
+        for (int pass = 0; levelsChanged && pass <= s.nodes.size(); ++pass)
+        {
+            levelsChanged = false;
+
+            for (auto* scheduled : s.nodes)
+            {
+                int level = 0;
+
+                for (int i = 0; i < scheduled->numAudioSources; ++i)
+                    level = jmax (level, s.nodes.getUnchecked (s.audioSources[(size_t) (scheduled->firstAudioSource + i)].sourceNode)->level + 1);
+
+                for (int i = 0; i < scheduled->numMidiSources; ++i)
+                    level = jmax (level, s.nodes.getUnchecked (s.midiSources[(size_t) (scheduled->firstMidiSource + i)])->level + 1);
+
+                if (level != scheduled->level)
+                {
+                    scheduled->level = level;
+                    levelsChanged = true;
+                }
+            }
+        }
+
+        if (levelsChanged)
+            newSchedule = nullptr;
+    }
+
+    if (newSchedule != nullptr)
+    {
+        auto& s = *newSchedule;
+
+        for (int i = 0; i < s.nodes.size(); ++i)
+        {
+            auto* scheduled = s.nodes.getUnchecked (i);
+
+            while (s.levels.size() <= scheduled->level)
+                s.levels.add ({});
+
+            auto& level = s.levels.getReference (scheduled->level);
+
+            if (scheduled->runsOnWorker)
+                level.workerNodes.add (i);
+            else
+                level.audioThreadNodes.add (i);
+        }
+
+        //sources are always in earlier levels, so their latency is known by the time a node is reached.
+        //As in AudioProcessorGraph, MIDI counts towards a node's latency but only audio is delayed
+        for (int levelIndex = 0; levelIndex < s.levels.size(); ++levelIndex)
+        {
+            for (auto* scheduled : s.nodes)
+            {
+                if (scheduled->level != levelIndex)
+                    continue;
+
+                int inputLatency = 0;
+
+                for (int i = 0; i < scheduled->numAudioSources; ++i)
+                    inputLatency = jmax (inputLatency, s.nodes.getUnchecked (s.audioSources[(size_t) (scheduled->firstAudioSource + i)].sourceNode)->totalLatency);
+
+                for (int i = 0; i < scheduled->numMidiSources; ++i)
+                    inputLatency = jmax (inputLatency, s.nodes.getUnchecked (s.midiSources[(size_t) (scheduled->firstMidiSource + i)])->totalLatency);
+
+                scheduled->totalLatency = inputLatency + (scheduled->ioType < 0 ? jmax (0, scheduled->processor->getLatencySamples()) : 0);
+
+                for (int i = 0; i < scheduled->numAudioSources; ++i)
+                {
+                    auto& source = s.audioSources[(size_t) (scheduled->firstAudioSource + i)];
+                    source.delaySamples = inputLatency - s.nodes.getUnchecked (source.sourceNode)->totalLatency;
+                    source.delayLine.assign ((size_t) source.delaySamples, 0.f);
+                }
+            }
+        }
+
+        for (auto& level : s.levels)
+        {
+            int numPluginNodes = level.workerNodes.size();
+
+            for (auto nodeIndex : level.audioThreadNodes)
+                if (s.nodes.getUnchecked (nodeIndex)->ioType < 0)
+                    ++numPluginNodes;
+
+            //the audio thread takes a share of each level too
+            if (level.workerNodes.size() > 0)
+                s.maxWorkersUseful = jmax (s.maxWorkersUseful, numPluginNodes - 1);
+        }
+    }
+
+    //old nodes and buffers are released here, never on the audio thread
+    {
+        const SpinLock::ScopedLockType sl (scheduleLock);
+        std::swap (schedule, newSchedule);
+    }
+
+    updateWorkers();
+}
+
+void ParallelProcessorGraph::updateWorkers()
+{
+    int numWorkers = 0;
+
+    if (parallelProcessingEnabled && schedule != nullptr)
+        numWorkers = jmin (schedule->maxWorkersUseful, SystemStats::getNumCpus() - 1, 15);
+
+    if (numWorkers == workers.size())
+        return;
+
+    //workers only look at a level while the audio thread holds the schedule, so holding
+    //it here means none of them are partway through a node
+    const SpinLock::ScopedLockType sl (scheduleLock);
+
+    while (workers.size() > numWorkers)
+        workers.removeLast();
+
+    while (workers.size() < numWorkers)
+        workers.add (new Worker (*this, workers.size() + 1))->startThread (Thread::realtimeAudioPriority);
+}
+
+//==============================================================================
+void ParallelProcessorGraph::processBlock (AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
+{
+    const SpinLock::ScopedTryLockType tl (scheduleLock);
+
+    if (! tl.isLocked() || schedule == nullptr || buffer.getNumSamples() > schedule->maxBlockSize)
+    {
+        AudioProcessorGraph::processBlock (buffer, midiMessages);
+        return;
+    }
+
+    renderSchedule (*schedule, buffer, midiMessages);
+}
+
+void ParallelProcessorGraph::renderSchedule (Schedule& s, AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
+{
+    const int numSamples = buffer.getNumSamples();
+    activeGraphBuffer = &buffer;
+    activeGraphMidi = &midiMessages;
+    activeSchedule.store (&s, std::memory_order_relaxed);
+    activeNumSamples.store (numSamples, std::memory_order_relaxed);
+
+    for (int levelIndex = 0; levelIndex < s.levels.size(); ++levelIndex)
+    {
+        auto& level = s.levels.getReference (levelIndex);
+        const int numWorkerNodes = level.workerNodes.size();
+
+        if (numWorkerNodes > 0)
+        {
+            activeLevel.store (levelIndex, std::memory_order_relaxed);
+            levelNodesRemaining.store (numWorkerNodes, std::memory_order_relaxed);
+            levelClaim.store (((uint64) ++levelTicket << 32) | (uint64) numWorkerNodes);
+
+            for (auto* worker : workers)
+                worker->wakeIfSleeping();
+        }
+
+        for (auto nodeIndex : level.audioThreadNodes)
+            processNode (s, nodeIndex, numSamples);
+
+        if (numWorkerNodes > 0)
+        {
+            while (processNextNodeInLevel())
+            {}
+
+            while (levelNodesRemaining.load (std::memory_order_acquire) > 0)
+            {}
+        }
+    }
+
+    buffer.clear();
+    midiMessages.clear();
+
+    for (auto* scheduled : s.nodes)
+    {
+        if (scheduled->ioType == AudioGraphIOProcessor::audioOutputNode)
+        {
+            for (int i = 0; i < jmin (scheduled->numInputs, buffer.getNumChannels()); ++i)
+                buffer.addFrom (i, 0, scheduled->buffer, i, 0, numSamples);
+        }
+        else if (scheduled->ioType == AudioGraphIOProcessor::midiOutputNode)
+        {
+            midiMessages.addEvents (scheduled->midi, 0, numSamples, 0);
+        }
+    }
+
+    activeGraphBuffer = nullptr;
+    activeGraphMidi = nullptr;
+}
+
+bool ParallelProcessorGraph::hasNodeToClaim() const
+{
+    const auto claim = levelClaim.load();
+    return ((claim >> 16) & 0xffff) < (claim & 0xffff);
+}
+
+bool ParallelProcessorGraph::processNextNodeInLevel()
+{
+    auto claim = levelClaim.load (std::memory_order_acquire);
+
+    for (;;)
+    {
+        const auto next = (uint32) ((claim >> 16) & 0xffff);
+
+        if (next >= (uint32) (claim & 0xffff))
+            return false;
+
+        //a stale claim from an earlier level has a different ticket, so it can never succeed
+        if (levelClaim.compare_exchange_weak (claim, claim + (1 << 16), std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            auto& s = *activeSchedule.load (std::memory_order_relaxed);
+            const auto& level = s.levels.getReference (activeLevel.load (std::memory_order_relaxed));
+            processNode (s, level.workerNodes.getUnchecked ((int) next), activeNumSamples.load (std::memory_order_relaxed));
+            levelNodesRemaining.fetch_sub (1, std::memory_order_release);
+            return true;
+        }
+    }
+}
+
+void ParallelProcessorGraph::processNode (Schedule& s, int nodeIndex, int numSamples)
+{
+    auto& scheduled = *s.nodes.getUnchecked (nodeIndex);
+    const auto startTicks = Time::getHighResolutionTicks();
+
+    scheduled.buffer.clear (0, numSamples);
+    scheduled.midi.clear();
+
+    for (int i = 0; i < scheduled.numAudioSources; ++i)
+    {
+        auto& source = s.audioSources[(size_t) (scheduled.firstAudioSource + i)];
+        const auto& sourceBuffer = s.nodes.getUnchecked (source.sourceNode)->buffer;
+
+        if (source.delaySamples == 0)
+        {
+            scheduled.buffer.addFrom (source.destChannel, 0, sourceBuffer, source.sourceChannel, 0, numSamples);
+            continue;
+        }
+
+        const float* in = sourceBuffer.getReadPointer (source.sourceChannel);
+        float* out = scheduled.buffer.getWritePointer (source.destChannel);
+
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            out[sample] += source.delayLine[(size_t) source.delayPosition];
+            source.delayLine[(size_t) source.delayPosition] = in[sample];
+
+            if (++source.delayPosition == source.delaySamples)
+                source.delayPosition = 0;
+        }
+    }
+
+    for (int i = 0; i < scheduled.numMidiSources; ++i)
+        scheduled.midi.addEvents (s.nodes.getUnchecked (s.midiSources[(size_t) (scheduled.firstMidiSource + i)])->midi, 0, numSamples, 0);
+
+    if (scheduled.ioType == AudioGraphIOProcessor::audioInputNode)
+    {
+        for (int i = 0; i < jmin (scheduled.numOutputs, activeGraphBuffer->getNumChannels()); ++i)
+            scheduled.buffer.copyFrom (i, 0, *activeGraphBuffer, i, 0, numSamples);
+    }
+    else if (scheduled.ioType == AudioGraphIOProcessor::midiInputNode)
+    {
+        scheduled.midi.addEvents (*activeGraphMidi, 0, numSamples, 0);
+    }
+    else if (scheduled.ioType < 0)
+    {
+        AudioBuffer<float> nodeBuffer (scheduled.buffer.getArrayOfWritePointers(), scheduled.numBufferChannels, numSamples);
+        const ScopedLock sl (scheduled.processor->getCallbackLock());
+
+        if (scheduled.processor->isSuspended())
+            nodeBuffer.clear();
+        else if (scheduled.node->isBypassed())
+            scheduled.processor->processBlockBypassed (nodeBuffer, scheduled.midi);
+        else
+            scheduled.processor->processBlock (nodeBuffer, scheduled.midi);
+
+        const double blockSeconds = numSamples / s.sampleRate;
+        const double seconds = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - startTicks);
+        const float previousLoad = jmax (0.f, scheduled.cpuLoad.load (std::memory_order_relaxed));
+        scheduled.cpuLoad.store (previousLoad + 0.1f * ((float) (seconds / blockSeconds) - previousLoad), std::memory_order_relaxed);
+    }
+}
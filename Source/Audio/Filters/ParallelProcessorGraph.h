@@ -0,0 +1,103 @@
+/*
+  Copyright (C) 2016 Rory Walsh
+
+  Cabbage is free software; you can redistribute it
+  and/or modify it under the terms of the GNU General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  Cabbage is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public
+  License along with Csound; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+  02111-1307 USA
+*/
+
+#ifndef PARALLELPROCESSORGRAPH_H_INCLUDED
+#define PARALLELPROCESSORGRAPH_H_INCLUDED
+
+#include "JuceHeader.h"
+
+//==============================================================================
+// The IDE's processor graph. Nodes are sorted into dependency levels, so that
+// every node in a level only reads from nodes in earlier levels, and the
+// Cabbage and Csound nodes in each level are shared out between the audio
+// thread and a pool of real-time worker threads. Any thread can claim the next
+// unprocessed node in a level with a single compare-and-swap, so an idle
+// thread takes work from a busy one without any locks. Other plugins always
+// run on the audio thread. With parallel processing turned off, the same
+// schedule is run entirely on the audio thread, node by node in a fixed order.
+// Latency is compensated as AudioProcessorGraph does it, by delaying the audio
+// from sources that have less of it than the other inputs to the same node.
+// Graphs the schedule can't reproduce exactly are rendered by
+// AudioProcessorGraph as before.
+//==============================================================================
+class ParallelProcessorGraph : public AudioProcessorGraph,
+                               private ChangeListener,
+                               private AudioProcessorListener
+{
+public:
+    ParallelProcessorGraph();
+    ~ParallelProcessorGraph() override;
+
+    void prepareToPlay (double sampleRate, int estimatedSamplesPerBlock) override;
+    void releaseResources() override;
+    void processBlock (AudioBuffer<float>& buffer, MidiBuffer& midiMessages) override;
+    using AudioProcessorGraph::processBlock;
+
+    void setParallelProcessingEnabled (bool shouldBeEnabled);
+    bool isParallelProcessingEnabled() const    {   return parallelProcessingEnabled;   }
+
+    //message thread. The share of each block spent processing a node, or -1 if the
+    //node isn't being timed because the graph is currently rendered by AudioProcessorGraph
+    float getNodeCpuLoad (NodeID nodeID) const;
+
+private:
+    struct Schedule;
+    class Worker;
+
+    struct ScheduleUpdater  : public AsyncUpdater
+    {
+        ScheduleUpdater (ParallelProcessorGraph& g) : graph (g) {}
+        void handleAsyncUpdate() override   {   graph.rebuildSchedule();   }
+        ParallelProcessorGraph& graph;
+    };
+
+    void changeListenerCallback (ChangeBroadcaster*) override;
+    //any thread, nodes report latency changes through these
+    void audioProcessorParameterChanged (AudioProcessor*, int, float) override {}
+    void audioProcessorChanged (AudioProcessor*, const ChangeDetails& details) override;
+    void updateScheduleNowOrLater();
+    void rebuildSchedule();
+    void updateWorkers();
+    void renderSchedule (Schedule& schedule, AudioBuffer<float>& buffer, MidiBuffer& midiMessages);
+    void processNode (Schedule& schedule, int nodeIndex, int numSamples);
+    bool processNextNodeInLevel();
+    bool hasNodeToClaim() const;
+
+    std::unique_ptr<Schedule> schedule;
+    SpinLock scheduleLock;
+    ScheduleUpdater scheduleUpdater { *this };
+    OwnedArray<Worker> workers;
+    bool parallelProcessingEnabled = true;
+    std::atomic<bool> isPreparedForSchedule { false };
+
+    //the level currently being processed. levelClaim packs a ticket that changes for every
+    //level, the index of the next node to claim, and the number of nodes in the level
+    std::atomic<uint64> levelClaim { 0 };
+    std::atomic<int> levelNodesRemaining { 0 };
+    std::atomic<Schedule*> activeSchedule { nullptr };
+    std::atomic<int> activeLevel { 0 };
+    std::atomic<int> activeNumSamples { 0 };
+    uint32 levelTicket = 0;
+    AudioBuffer<float>* activeGraphBuffer = nullptr;
+    MidiBuffer* activeGraphMidi = nullptr;
+
+    JUCE_DECLARE_NON_COPYABLE (ParallelProcessorGraph)
+};
+
+#endif  // PARALLELPROCESSORGRAPH_H_INCLUDED
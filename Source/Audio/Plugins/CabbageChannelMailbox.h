@@ -0,0 +1,156 @@
+/*
+  Copyright (C) 2016 Rory Walsh
+
+  Cabbage is free software; you can redistribute it
+  and/or modify it under the terms of the GNU General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  Cabbage is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public
+  License along with Csound; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+  02111-1307 USA
+*/
+
+#ifndef CABBAGECHANNELMAILBOX_H_INCLUDED
+#define CABBAGECHANNELMAILBOX_H_INCLUDED
+
+#include "JuceHeader.h"
+#include <csound.hpp>
+
+//==============================================================================
+// Latest-value-wins mailbox for control channels set by the editor, such as
+// MOUSE_X and MOUSE_Y. The message thread resolves a channel name to an
+// integer handle once, and after that setValue() only stores the value and
+// marks it dirty. The audio thread writes whatever is dirty straight into
+// Csound's channel memory at the next k-boundary, so however often a channel
+// is set, Csound sees at most one write per k-cycle and its channel lock is
+// never taken. Slots are preallocated, so handles can be added while the
+// audio thread is running. Channels that arrive once every slot is taken still
+// get a handle, but setValue() refuses it and the caller sets the channel by
+// name instead, see getChannelName().
+//==============================================================================
+class CabbageChannelMailbox
+{
+public:
+    static constexpr int maxChannels = 2048;
+
+    CabbageChannelMailbox() : slots ((size_t) maxChannels) {}
+
+    //message thread
+    int getHandle (const String& channelName, Csound* csound)
+    {
+        if (handles.contains (channelName))
+            return handles[channelName];
+
+        const int handle = numSlots.load();
+
+        if (handle >= maxChannels)
+        {
+            const int overflowHandle = maxChannels + overflowChannels.size();
+            overflowChannels.add (channelName);
+            handles.set (channelName, overflowHandle);
+            return overflowHandle;
+        }
+
+        slots[(size_t) handle].name = channelName;
+
+        if (csound != nullptr)
+            bindSlot (slots[(size_t) handle], *csound);
+
+        handles.set (channelName, handle);
+        numSlots = handle + 1;
+        return handle;
+    }
+
+    //message thread, after every compile. Channel memory belongs to the Csound instance
+    void bindAllChannels (Csound& csound)
+    {
+        for (int i = 0; i < numSlots.load(); ++i)
+            bindSlot (slots[(size_t) i], csound);
+    }
+
+    void unbindAllChannels()
+    {
+        for (int i = 0; i < numSlots.load(); ++i)
+            slots[(size_t) i].csoundChannel = nullptr;
+    }
+
+    //any thread, never allocates or blocks. Returns false for handles without a slot
+    bool setValue (int handle, float newValue)
+    {
+        if (! isPositiveAndBelow (handle, numSlots.load()))
+            return false;
+
+        slots[(size_t) handle].value.store (newValue, std::memory_order_relaxed);
+        dirty[handle >> 5].fetch_or (1u << (handle & 31), std::memory_order_release);
+        return true;
+    }
+
+    //message thread, empty for handles that were never given out
+    String getChannelName (int handle) const
+    {
+        if (isPositiveAndBelow (handle, numSlots.load()))
+            return slots[(size_t) handle].name;
+
+        return overflowChannels[handle - maxChannels];
+    }
+
+    //audio thread, at each k-boundary before Csound performs
+    void writeToCsound()
+    {
+        const int numWords = (numSlots.load (std::memory_order_acquire) + 31) / 32;
+
+        for (int word = 0; word < numWords; ++word)
+        {
+            uint32 bits = dirty[word].exchange (0, std::memory_order_acquire);
+
+            for (int bit = 0; bits != 0; ++bit, bits >>= 1)
+            {
+                if ((bits & 1u) == 0)
+                    continue;
+
+                auto& slot = slots[(size_t) (word * 32 + bit)];
+
+                if (MYFLT* csoundChannel = slot.csoundChannel.load (std::memory_order_acquire))
+                    *csoundChannel = (MYFLT) slot.value.load (std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct Slot
+    {
+        String name;
+        std::atomic<float> value { 0.f };
+        std::atomic<MYFLT*> csoundChannel { nullptr };
+    };
+
+    static void bindSlot (Slot& slot, Csound& csound)
+    {
+        MYFLT* channelPtr = nullptr;
+
+        if (csound.GetChannelPtr (channelPtr, slot.name.toUTF8().getAddress(),
+                                  CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL) != CSOUND_SUCCESS)
+            channelPtr = nullptr;
+
+        slot.csoundChannel = channelPtr;
+    }
+
+    std::vector<Slot> slots;
+    std::atomic<uint32> dirty[maxChannels / 32] = {};
+    std::atomic<int> numSlots { 0 };
+
+    //only touched by the message thread
+    HashMap<String, int> handles;
+    StringArray overflowChannels;
+
+    JUCE_DECLARE_NON_COPYABLE (CabbageChannelMailbox)
+};
+
+#endif  // CABBAGECHANNELMAILBOX_H_INCLUDED
@@ -0,0 +1,163 @@
+/*
+  Copyright (C) 2016 Rory Walsh
+
+  Cabbage is free software; you can redistribute it
+  and/or modify it under the terms of the GNU General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  Cabbage is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public
+  License along with Csound; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+  02111-1307 USA
+*/
+
+#ifndef CABBAGECSOUNDMESSAGELOG_H_INCLUDED
+#define CABBAGECSOUNDMESSAGELOG_H_INCLUDED
+
+#include "JuceHeader.h"
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+//==============================================================================
+// Bounded ring of Csound console messages. Csound's message callback writes
+// fixed-size records into a preallocated FIFO from whatever thread is running
+// Csound, and the message thread drains them into a String. Nothing on the
+// writing side allocates or blocks: if the ring is full, or another thread is
+// mid-write, the message is counted as dropped instead. Identical consecutive
+// lines are coalesced when drained.
+//==============================================================================
+class CabbageCsoundMessageLog
+{
+public:
+    static constexpr int maxMessageLength = 256;
+
+    explicit CabbageCsoundMessageLog (int capacity = 4096)
+        : fifo (capacity), records ((size_t) capacity)
+    {}
+
+    //called from Csound's message callback
+    void push (int attr, const char* format, va_list args)
+    {
+        const SpinLock::ScopedTryLockType lock (writeLock);
+
+        if (! lock.isLocked())
+        {
+            ++numDropped;
+            return;
+        }
+
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite (1, start1, size1, start2, size2);
+
+        if (size1 == 0)
+        {
+            ++numDropped;
+            return;
+        }
+
+        auto& record = records[(size_t) start1];
+        const int length = vsnprintf (record.text, maxMessageLength, format, args);
+
+        if (length <= 0 || isFiltered (record.text))
+            return;
+
+        record.attr = attr;
+        record.length = jmin (length, maxMessageLength - 1);
+
+        //truncated messages are terminated so they don't run into the next one
+        if (length >= maxMessageLength)
+            record.text[record.length - 1] = '\n';
+
+        fifo.finishedWrite (1);
+    }
+
+    //called from the message thread, returns everything logged since the last call
+    String drain()
+    {
+        MemoryOutputStream output;
+
+        if (const int dropped = numDropped.exchange (0))
+        {
+            flushRepeats (output);
+            output << "[Cabbage: " << dropped << " Csound messages dropped]\n";
+        }
+
+        int start1, size1, start2, size2;
+        fifo.prepareToRead (fifo.getNumReady(), start1, size1, start2, size2);
+
+        for (int i = 0; i < size1; ++i)
+            appendRecord (output, records[(size_t) (start1 + i)]);
+
+        for (int i = 0; i < size2; ++i)
+            appendRecord (output, records[(size_t) (start2 + i)]);
+
+        fifo.finishedRead (size1 + size2);
+        flushRepeats (output);
+
+        return output.toUTF8();
+    }
+
+private:
+    struct Record
+    {
+        int attr = 0;
+        int length = 0;
+        char text[maxMessageLength] = {};
+    };
+
+    //messages that are never shown in the console
+    static bool isFiltered (const char* text)
+    {
+        static const char* const filters[] = { "midi channel", "is muted", "Score finished in csoundPerformKsmps()" };
+
+        for (auto* filter : filters)
+            if (std::strstr (text, filter) != nullptr)
+                return true;
+
+        return false;
+    }
+
+    void appendRecord (MemoryOutputStream& output, const Record& record)
+    {
+        const bool isCompleteLine = record.text[record.length - 1] == '\n';
+
+        if (isCompleteLine && lastLine.getNumBytesAsUTF8() == (size_t) record.length
+            && std::memcmp (lastLine.toRawUTF8(), record.text, (size_t) record.length) == 0)
+        {
+            ++numRepeats;
+            return;
+        }
+
+        flushRepeats (output);
+        output.write (record.text, (size_t) record.length);
+        lastLine = isCompleteLine ? String::fromUTF8 (record.text, record.length) : String();
+    }
+
+    void flushRepeats (MemoryOutputStream& output)
+    {
+        if (numRepeats > 0)
+            output << "[Cabbage: last message repeated " << numRepeats << " times]\n";
+
+        numRepeats = 0;
+    }
+
+    AbstractFifo fifo;
+    std::vector<Record> records;
+    SpinLock writeLock;
+    std::atomic<int> numDropped { 0 };
+
+    //only touched by the draining thread
+    String lastLine;
+    int numRepeats = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (CabbageCsoundMessageLog)
+};
+
+#endif  // CABBAGECSOUNDMESSAGELOG_H_INCLUDED
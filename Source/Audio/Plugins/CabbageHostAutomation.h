@@ -0,0 +1,335 @@
+/*
+  Copyright (C) 2016 Rory Walsh
+
+  Cabbage is free software; you can redistribute it
+  and/or modify it under the terms of the GNU General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  Cabbage is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public
+  License along with Csound; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+  02111-1307 USA
+*/
+
+#ifndef CABBAGEHOSTAUTOMATION_H_INCLUDED
+#define CABBAGEHOSTAUTOMATION_H_INCLUDED
+
+#include "JuceHeader.h"
+#include <csound.hpp>
+
+//==============================================================================
+// Host parameter values on their way to Csound. Hosts set parameters from the
+// audio thread, so setValue() only stores the value and marks the channel as
+// dirty. Pending values are written straight into Csound's channel memory at
+// the next k-boundary, optionally ramped over the k-cycles of a block, and the
+// message thread picks up whatever changed in one pass per GUI frame. Channels
+// with a smoothing time are run through a one-pole lowpass on every k-cycle,
+// so instruments don't need portk on each chnget.
+//==============================================================================
+class CabbageHostAutomation
+{
+public:
+    //all storage is allocated up front, so that adding a channel never moves anything the
+    //audio thread may be reading
+    static constexpr int maxChannels = 2048;
+
+    CabbageHostAutomation()
+        : dirtyForCsound ((size_t) maxChannels / 32),
+          dirtyForGui ((size_t) maxChannels / 32),
+          smoothedValues ((size_t) maxChannels),
+          smoothedTargets ((size_t) maxChannels),
+          smoothingCoefficients ((size_t) maxChannels, 1),
+          smoothedChannels ((size_t) maxChannels),
+          smoothingActive ((size_t) maxChannels)
+    {
+        channels.ensureStorageAllocated (maxChannels);
+    }
+
+    //message thread, only while parameters are being created. The new channel is only
+    //published to the audio thread once it is complete. Returns -1 when all slots are used
+    int addChannel (const String& channelName, bool canRamp, float smoothingTimeMs = 0)
+    {
+        const int index = channels.size();
+
+        if (index >= maxChannels)
+            return -1;
+
+        auto* channel = channels.add (new Channel());
+        channel->name = channelName;
+        channel->canRamp = canRamp;
+        channel->smoothingTimeMs = smoothingTimeMs;
+
+        if (smoothingTimeMs > 0)
+        {
+            const int slot = numSmoothedChannels.load (std::memory_order_relaxed);
+            channel->smoothingSlot = slot;
+            smoothedValues[(size_t) slot] = 0;
+            smoothedTargets[(size_t) slot] = 0;
+            smoothingCoefficients[(size_t) slot] = 1;
+            smoothedChannels[(size_t) slot] = nullptr;
+            smoothingActive[(size_t) slot] = 0;
+            numSmoothedChannels.store (slot + 1, std::memory_order_release);
+        }
+
+        numChannels.store (index + 1, std::memory_order_release);
+        return index;
+    }
+
+    int getNumChannels() const                      {   return numChannels.load (std::memory_order_acquire);   }
+    const String& getChannelName (int index) const  {   return channels.getUnchecked (index)->name;   }
+
+    //message thread, after every compile. Channel memory belongs to the Csound instance
+    void bindChannel (int index, Csound& csound)
+    {
+        auto* channel = channels.getUnchecked (index);
+        MYFLT* channelPtr = nullptr;
+
+        if (csound.GetChannelPtr (channelPtr, channel->name.toUTF8().getAddress(),
+                                  CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL) != CSOUND_SUCCESS)
+            channelPtr = nullptr;
+
+        channel->csoundChannel = channelPtr;
+
+        if (channel->smoothingSlot >= 0)
+        {
+            const auto slot = (size_t) channel->smoothingSlot;
+            const double timeInKCycles = csound.GetSr() * channel->smoothingTimeMs * 0.001 / jmax (1, (int) csound.GetKsmps());
+
+            smoothedValues[slot] = smoothedTargets[slot] = channelPtr != nullptr ? *channelPtr : 0;
+            smoothingCoefficients[slot] = (MYFLT) (1.0 - std::exp (-1.0 / jmax (1.0, timeInKCycles)));
+            smoothingActive[slot] = 0;
+            smoothedChannels[slot] = channelPtr;
+        }
+    }
+
+    void bindAllChannels (Csound& csound)
+    {
+        for (int i = 0; i < channels.size(); ++i)
+            bindChannel (i, csound);
+    }
+
+    void unbindAllChannels()
+    {
+        for (auto* channel : channels)
+            channel->csoundChannel = nullptr;
+
+        std::fill (smoothedChannels.begin(), smoothedChannels.end(), nullptr);
+    }
+
+    //when enabled, changes to continuous parameters are spread over the k-cycles of a block
+    void setRampingEnabled (bool shouldRamp)    {   rampingEnabled = shouldRamp;   }
+    bool isRampingEnabled() const               {   return rampingEnabled;   }
+
+    //any thread, never allocates or blocks
+    void setValue (int index, float newValue)
+    {
+        if (! isPositiveAndBelow (index, getNumChannels()))
+            return;
+
+        channels.getUnchecked (index)->value.store (newValue, std::memory_order_relaxed);
+
+        const uint32 bit = 1u << (index & 31);
+        dirtyForCsound[(size_t) (index >> 5)].fetch_or (bit, std::memory_order_release);
+        dirtyForGui[(size_t) (index >> 5)].fetch_or (bit, std::memory_order_release);
+    }
+
+    float getValue (int index) const
+    {
+        return channels.getUnchecked (index)->value.load (std::memory_order_relaxed);
+    }
+
+    //audio thread, at each k-boundary before Csound performs. New targets are applied first,
+    //then every ramping channel takes exactly one step, so a channel that gets a new target
+    //mid-ramp doesn't also take the last step of its old ramp in the same k-cycle
+    void writeToCsound (int numRampCycles)
+    {
+        const int numWords = (getNumChannels() + 31) / 32;
+
+        for (int word = 0; word < numWords; ++word)
+        {
+            uint32 bits = dirtyForCsound[(size_t) word].exchange (0, std::memory_order_acquire);
+
+            while (bits != 0)
+            {
+                const int bit = countTrailingZeros (bits);
+                bits &= bits - 1;
+                startChange (*channels.getUnchecked (word * 32 + bit), numRampCycles);
+            }
+        }
+
+        if (numRampingChannels > 0)
+            advanceRamps();
+
+        if (numSmoothedChannels.load (std::memory_order_acquire) > 0)
+            advanceSmoothing();
+    }
+
+    //message thread, calls callback (index, value) once for each channel set since the last call
+    template <typename Callback>
+    void forEachChangedValue (Callback&& callback)
+    {
+        const int numWords = (getNumChannels() + 31) / 32;
+
+        for (int word = 0; word < numWords; ++word)
+        {
+            uint32 bits = dirtyForGui[(size_t) word].exchange (0, std::memory_order_acquire);
+
+            while (bits != 0)
+            {
+                const int index = word * 32 + countTrailingZeros (bits);
+                bits &= bits - 1;
+                callback (index, getValue (index));
+            }
+        }
+    }
+
+private:
+    struct Channel
+    {
+        String name;
+        bool canRamp = false;
+        float smoothingTimeMs = 0;
+        int smoothingSlot = -1;
+        std::atomic<float> value { 0.f };
+        std::atomic<MYFLT*> csoundChannel { nullptr };
+
+        //only touched by the audio thread
+        MYFLT rampIncrement = 0;
+        MYFLT rampTarget = 0;
+        int rampCyclesLeft = 0;
+    };
+
+    static int countTrailingZeros (uint32 bits)
+    {
+        int count = 0;
+
+        while ((bits & 1u) == 0)
+        {
+            bits >>= 1;
+            ++count;
+        }
+
+        return count;
+    }
+
+    void startChange (Channel& channel, int numRampCycles)
+    {
+        MYFLT* csoundChannel = channel.csoundChannel.load (std::memory_order_acquire);
+
+        if (csoundChannel == nullptr)
+            return;
+
+        const MYFLT target = (MYFLT) channel.value.load (std::memory_order_relaxed);
+
+        if (channel.smoothingSlot >= 0)
+        {
+            const auto slot = (size_t) channel.smoothingSlot;
+
+            //pick up anything the orchestra has written since the last change
+            if (smoothingActive[slot] == 0)
+                smoothedValues[slot] = *csoundChannel;
+
+            smoothedTargets[slot] = target;
+            smoothingActive[slot] = 1;
+        }
+        else if (rampingEnabled && channel.canRamp && numRampCycles > 1)
+        {
+            if (channel.rampCyclesLeft == 0)
+                ++numRampingChannels;
+
+            //the first step is taken by advanceRamps() in this same k-cycle
+            channel.rampTarget = target;
+            channel.rampIncrement = (target - *csoundChannel) / numRampCycles;
+            channel.rampCyclesLeft = numRampCycles;
+        }
+        else
+        {
+            if (channel.rampCyclesLeft > 0)
+                --numRampingChannels;
+
+            channel.rampCyclesLeft = 0;
+            *csoundChannel = target;
+        }
+    }
+
+    void advanceRamps()
+    {
+        const int numChannelsToCheck = getNumChannels();
+
+        for (int i = 0; i < numChannelsToCheck; ++i)
+        {
+            auto* channel = channels.getUnchecked (i);
+
+            if (channel->rampCyclesLeft > 0)
+            {
+                if (MYFLT* csoundChannel = channel->csoundChannel.load (std::memory_order_acquire))
+                    advanceRamp (*channel, csoundChannel);
+                else
+                {
+                    channel->rampCyclesLeft = 0;
+                    --numRampingChannels;
+                }
+            }
+        }
+    }
+
+    //smoothed channels sit side by side so the filter runs as one loop over all of them
+    void advanceSmoothing()
+    {
+        const int numSmoothed = numSmoothedChannels.load (std::memory_order_acquire);
+        MYFLT* values = smoothedValues.data();
+        const MYFLT* targets = smoothedTargets.data();
+        const MYFLT* coefficients = smoothingCoefficients.data();
+
+        for (int i = 0; i < numSmoothed; ++i)
+            values[i] += coefficients[i] * (targets[i] - values[i]);
+
+        //settled channels are left alone, so the orchestra can still chnset them
+        for (int i = 0; i < numSmoothed; ++i)
+        {
+            if (smoothingActive[(size_t) i] == 0 || smoothedChannels[(size_t) i] == nullptr)
+                continue;
+
+            if (std::abs (targets[i] - values[i]) <= (MYFLT) 1.0e-5 * (1 + std::abs (targets[i])))
+            {
+                values[i] = targets[i];
+                smoothingActive[(size_t) i] = 0;
+            }
+
+            *smoothedChannels[(size_t) i] = values[i];
+        }
+    }
+
+    void advanceRamp (Channel& channel, MYFLT* csoundChannel)
+    {
+        //the last step lands exactly on the target, whatever rounding has crept in
+        if (--channel.rampCyclesLeft == 0)
+        {
+            *csoundChannel = channel.rampTarget;
+            --numRampingChannels;
+        }
+        else
+            *csoundChannel += channel.rampIncrement;
+    }
+
+    OwnedArray<Channel> channels;
+    std::atomic<int> numChannels { 0 }, numSmoothedChannels { 0 };
+    std::vector<std::atomic<uint32>> dirtyForCsound, dirtyForGui;
+    std::atomic<bool> rampingEnabled { false };
+
+    //only touched by the audio thread, other than when channels are bound
+    int numRampingChannels = 0;
+    std::vector<MYFLT> smoothedValues, smoothedTargets, smoothingCoefficients;
+    std::vector<MYFLT*> smoothedChannels;
+    std::vector<uint8> smoothingActive;
+
+    JUCE_DECLARE_NON_COPYABLE (CabbageHostAutomation)
+};
+
+#endif  // CABBAGEHOSTAUTOMATION_H_INCLUDED
@@ -0,0 +1,117 @@
+/*
+  Copyright (C) 2016 Rory Walsh
+
+  Cabbage is free software; you can redistribute it
+  and/or modify it under the terms of the GNU General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  Cabbage is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public
+  License along with Csound; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+  02111-1307 USA
+*/
+
+#ifndef CABBAGEMIDIOUTPUTQUEUE_H_INCLUDED
+#define CABBAGEMIDIOUTPUTQUEUE_H_INCLUDED
+
+#include "JuceHeader.h"
+
+//==============================================================================
+// MIDI that Csound sends out, waiting to be passed to the host. Csound's MIDI
+// write callback pushes each message with the sample offset of the k-cycle
+// that produced it, and at the end of the block the processor rebuilds the
+// outgoing MidiBuffer with the events at those offsets. Records are fixed
+// size in a preallocated single producer, single consumer FIFO, so neither
+// side allocates or blocks. Messages that don't fit, because the queue is
+// full or they're longer than a record, are counted as dropped.
+//==============================================================================
+class CabbageMidiOutputQueue
+{
+public:
+    static constexpr int maxMessageSize = 16;
+
+    explicit CabbageMidiOutputQueue (int capacity = 1024)
+        : fifo (capacity), records ((size_t) capacity)
+    {}
+
+    //called from Csound's MIDI write callback
+    bool push (const unsigned char* data, int numBytes, int sampleOffset) noexcept
+    {
+        if (numBytes <= 0 || numBytes > maxMessageSize)
+        {
+            ++numDropped;
+            return false;
+        }
+
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite (1, start1, size1, start2, size2);
+
+        if (size1 == 0)
+        {
+            ++numDropped;
+            return false;
+        }
+
+        auto& record = records[(size_t) start1];
+        memcpy (record.data, data, (size_t) numBytes);
+        record.numBytes = numBytes;
+        record.sampleOffset = sampleOffset;
+        fifo.finishedWrite (1);
+        return true;
+    }
+
+    //adds everything queued to buffer, with offsets kept inside the block
+    void popInto (MidiBuffer& buffer, int numSamples) noexcept
+    {
+        const int numReady = fifo.getNumReady();
+
+        if (numReady == 0)
+            return;
+
+        int start1, size1, start2, size2;
+        fifo.prepareToRead (numReady, start1, size1, start2, size2);
+
+        auto addRecords = [&] (int start, int size)
+        {
+            for (int i = start; i < start + size; ++i)
+            {
+                const auto& record = records[(size_t) i];
+                buffer.addEvent (record.data, record.numBytes, jlimit (0, jmax (0, numSamples - 1), record.sampleOffset));
+            }
+        };
+
+        addRecords (start1, size1);
+        addRecords (start2, size2);
+        fifo.finishedRead (size1 + size2);
+    }
+
+    //bytes a MidiBuffer needs to take a full queue without growing
+    int getMaxBufferSize() const noexcept
+    {
+        return fifo.getTotalSize() * (maxMessageSize + (int) (sizeof (int32) + sizeof (uint16)));
+    }
+
+    int getNumDropped() const noexcept     {   return numDropped.load();   }
+
+private:
+    struct Record
+    {
+        uint8 data[maxMessageSize];
+        int numBytes = 0;
+        int sampleOffset = 0;
+    };
+
+    AbstractFifo fifo;
+    std::vector<Record> records;
+    std::atomic<int> numDropped { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (CabbageMidiOutputQueue)
+};
+
+#endif  // CABBAGEMIDIOUTPUTQUEUE_H_INCLUDED
@@ -17,6 +17,7 @@
   02111-1307 USA
 */ 
 #include "CabbagePluginEditor.h"
+#include "../../Utilities/CabbageTrace.h"
 
 #include <memory>
 
@@ -38,6 +39,18 @@ CabbagePluginEditor::CabbagePluginEditor (CabbagePluginProcessor& p)
 {
     setName ("PluginEditor");
     cabbageProcessor.editorIsOpen = true;
+
+    //resolved before anything can trigger resized() or a mouse event
+    editorChannels.screenWidth = getChannelHandle ("SCREEN_WIDTH");
+    editorChannels.screenHeight = getChannelHandle ("SCREEN_HEIGHT");
+    editorChannels.x = getChannelHandle (CabbageIdentifierIds::mousex);
+    editorChannels.y = getChannelHandle (CabbageIdentifierIds::mousey);
+    editorChannels.downLeft = getChannelHandle (CabbageIdentifierIds::mousedownleft);
+    editorChannels.downRight = getChannelHandle (CabbageIdentifierIds::mousedownright);
+    editorChannels.downMiddle = getChannelHandle (CabbageIdentifierIds::mousedownlmiddle);
+    editorChannels.wheelDeltaX = getChannelHandle (CabbageIdentifierIds::mousewheeldeltax);
+    editorChannels.wheelDeltaY = getChannelHandle (CabbageIdentifierIds::mousewheeldeltay);
+
     setLookAndFeel (&lookAndFeel);
     customFont = cabbageProcessor.getCustomFont();
     customFontFile = cabbageProcessor.getCustomFontFile();
@@ -54,6 +67,7 @@ CabbagePluginEditor::CabbagePluginEditor (CabbagePluginProcessor& p)
 	cabbageForm.addKeyListener(this);
 	//cabbageForm.setWantsKeyboardFocus(true);
     setWantsKeyboardFocus(false);
+
     createEditorInterface (cabbageProcessor.cabbageWidgets);
 
 #if Cabbage_IDE_Build
@@ -101,6 +115,17 @@ void CabbagePluginEditor::valueChanged (Value &value)
     if(value.refersToSameSourceAs(isBypassedValue))
         cabbageProcessor.getCsound()->SetControlChannel("IS_BYPASSED", value.getValue() ? 1.0 : 0.0);
 }
+void CabbagePluginEditor::paintOverChildren (Graphics& g)
+{
+    ignoreUnused (g);
+
+    //paint() is skipped when opaque widgets cover everything being repainted
+    if (repaintStartTicks != 0)
+        CabbageTrace::addZone ("Editor repaint", repaintStartTicks);
+
+    repaintStartTicks = 0;
+}
+
 void CabbagePluginEditor::timerCallback()
 {
     if(cabbageProcessor.getCsound())
@@ -139,8 +164,8 @@ String CabbagePluginEditor::getCurrentPreset() const
 
 void CabbagePluginEditor::resized()
 {
-    sendChannelDataToCsound("SCREEN_WIDTH", getWidth());
-    sendChannelDataToCsound("SCREEN_HEIGHT", getHeight());
+    sendChannelDataToCsound(editorChannels.screenWidth, getWidth());
+    sendChannelDataToCsound(editorChannels.screenHeight, getHeight());
 #if Cabbage_IDE_Build
     layoutEditor.setBounds (getLocalBounds());
     
@@ -210,38 +235,46 @@ void CabbagePluginEditor::mouseWheelMove(const MouseEvent &event, const MouseWhe
 {
     ignoreUnused(event);
     double scale = cabbageProcessor.currentPluginScale == -1 ? 1 : pluginSizes[cabbageProcessor.currentPluginScale-1];
-    sendChannelDataToCsound (CabbageIdentifierIds::mousewheeldeltax, wheel.deltaX/scale);
-    sendChannelDataToCsound (CabbageIdentifierIds::mousewheeldeltay, wheel.deltaY/scale);
+    sendChannelDataToCsound (editorChannels.wheelDeltaX, wheel.deltaX/scale);
+    sendChannelDataToCsound (editorChannels.wheelDeltaY, wheel.deltaY/scale);
 
 }
 
 void CabbagePluginEditor::handleMouseMovement (const MouseEvent& e)
 {
-    if(e.eventComponent->getName().isNotEmpty())
+    //CURRENT_WIDGET is a string channel, so it's only sent when the mouse moves onto another widget
+    Component* widget = e.eventComponent;
+
+    while (widget != nullptr && ! widgetBindings.contains (widget))
+        widget = widget->getParentComponent();
+
+    if (widget != nullptr && widget != lastWidgetUnderMouse)
     {
-        const ValueTree vt = getValueTreeForComponent(e.eventComponent->getName());
-        sendChannelStringDataToCsound(CabbageIdentifierIds::currentWidgetChannel.toString(), CabbageWidgetData::getStringProp(vt, CabbageIdentifierIds::channel));
+        lastWidgetUnderMouse = widget;
+        sendChannelStringDataToCsound(CabbageIdentifierIds::currentWidgetChannel.toString(), CabbageWidgetData::getStringProp(widgetBindings[widget], CabbageIdentifierIds::channel));
     }
     int x = e.eventComponent->getTopLevelComponent()->getMouseXYRelative().x;
     int yOffset = (CabbageUtilities::getTarget() == CabbageUtilities::TargetTypes::IDE ? 27 : 0 );
     int y = e.eventComponent->getTopLevelComponent()->getMouseXYRelative().y - yOffset; //27 is the height of the standalone window frame
     double scale = cabbageProcessor.currentPluginScale == -1 ? 1 : pluginSizes[cabbageProcessor.currentPluginScale-1];
-    sendChannelDataToCsound (CabbageIdentifierIds::mousex, x/scale);
-    sendChannelDataToCsound (CabbageIdentifierIds::mousey, y/scale);
+    sendChannelDataToCsound (editorChannels.x, x/scale);
+    sendChannelDataToCsound (editorChannels.y, y/scale);
 }
 
 void CabbagePluginEditor::handleMouseClicks (const MouseEvent& e, bool isMousePressed)
 {
     if (e.mods.isLeftButtonDown())
-        sendChannelDataToCsound (CabbageIdentifierIds::mousedownleft, (isMousePressed ? 1 : 0));
+        sendChannelDataToCsound (editorChannels.downLeft, (isMousePressed ? 1 : 0));
     else if (e.mods.isRightButtonDown())
-        sendChannelDataToCsound (CabbageIdentifierIds::mousedownright, (isMousePressed ? 1 : 0));
+        sendChannelDataToCsound (editorChannels.downRight, (isMousePressed ? 1 : 0));
     else if (e.mods.isMiddleButtonDown())
-        sendChannelDataToCsound (CabbageIdentifierIds::mousedownlmiddle, (isMousePressed ? 1 : 0));
+        sendChannelDataToCsound (editorChannels.downMiddle, (isMousePressed ? 1 : 0));
 }
 //==============================================================================
 void CabbagePluginEditor::createEditorInterface (ValueTree widgets)
 {
+    widgetBindings.clear();
+    lastWidgetUnderMouse = nullptr;
     components.clear();
 	keyboardCount = 0;
 
@@ -260,6 +293,36 @@ void CabbagePluginEditor::createEditorInterface (ValueTree widgets)
     }
     
     lookAndFeelChanged();
+    prepareWidgetImages (cabbageForm);
+}
+
+void CabbagePluginEditor::prepareWidgetImages (Component& parent)
+{
+    static const Identifier imageProperties[] = { CabbageIdentifierIds::imggroupbox, CabbageIdentifierIds::imgbuttonon,
+                                                  CabbageIdentifierIds::imgbuttonoff, CabbageIdentifierIds::imgbuttonover,
+                                                  CabbageIdentifierIds::imgslider, CabbageIdentifierIds::imgsliderbg };
+    SharedResourcePointer<CabbageImageCache> imageCache;
+    auto* display = Desktop::getInstance().getDisplays().getPrimaryDisplay();
+    const float displayScale = display != nullptr ? (float) display->scale : 1.f;
+
+    //at the size the look and feel draws most of them, the others use these as placeholders
+    for (auto* child : parent.getChildren())
+    {
+        const float scale = displayScale * Component::getApproximateScaleFactorForComponent (child);
+
+        for (const auto& property : imageProperties)
+        {
+            const File imageFile (child->getProperties().getWithDefault (property, "").toString());
+
+            //rotary thumbs are centred rather than stretched, so they're drawn from the image at its own size
+            if (property == CabbageIdentifierIds::imgslider && imageFile.hasFileExtension ("png"))
+                imageCache->prepare (imageFile, 0, 0);
+            else if (imageFile.hasFileExtension ("png;svg") && ! child->getLocalBounds().isEmpty())
+                imageCache->prepare (imageFile, roundToInt (child->getWidth() * scale), roundToInt (child->getHeight() * scale));
+        }
+
+        prepareWidgetImages (*child);
+    }
 }
 
 //======================================================================================================
@@ -267,6 +330,7 @@ void CabbagePluginEditor::setupWindow (ValueTree widgetData)
 {
     instrumentName = CabbageWidgetData::getStringProp (widgetData, CabbageIdentifierIds::caption);
     setName (CabbageWidgetData::getStringProp (widgetData, CabbageIdentifierIds::caption));
+    widgetBindings.set (&cabbageForm, widgetData);
     const int width = CabbageWidgetData::getNumProp (widgetData, CabbageIdentifierIds::width);
     showScrollbars = bool(CabbageWidgetData::getNumProp (widgetData, CabbageIdentifierIds::scrollbars));
     const int height = CabbageWidgetData::getNumProp (widgetData, CabbageIdentifierIds::height);
@@ -1056,6 +1120,7 @@ void CabbagePluginEditor::addToEditorAndMakeVisible (Component* comp, ValueTree
 void CabbagePluginEditor::addMouseListenerAndSetVisibility (Component* comp, ValueTree wData)
 {
     comp->addMouseListener (this, true);
+    widgetBindings.set (comp, wData);
     int visible = CabbageWidgetData::getNumProp (wData, CabbageIdentifierIds::visible);
     comp->setVisible (visible==1 || 0);
 }
@@ -1157,6 +1222,16 @@ void CabbagePluginEditor::sendChannelDataToCsound (const String& channel, float
         cabbageProcessor.getCsound()->SetChannel (channel.getCharPointer(), value);
 }
 
+void CabbagePluginEditor::sendChannelDataToCsound (int channelHandle, float value)
+{
+    cabbageProcessor.setUiChannelValue (channelHandle, value);
+}
+
+int CabbagePluginEditor::getChannelHandle (const String& channel)
+{
+    return cabbageProcessor.getUiChannelHandle (channel);
+}
+
 float CabbagePluginEditor::getChannelDataFromCsound (const String& channel)
 {
     if (csdCompiledWithoutError() && cabbageProcessor.getCsound())
@@ -1177,16 +1252,18 @@ void CabbagePluginEditor::sendScoreEventToCsound (const String& scoreEvent)
         cabbageProcessor.getCsound()->InputMessage(scoreEvent.toUTF8());
 }
 
-void CabbagePluginEditor::createEventMatrix(int cols, int rows, String channel)
+int CabbagePluginEditor::createEventMatrix(int cols, int rows, const String& channel)
 {
     if (cabbageProcessor.csdCompiledWithoutError())
-        cabbageProcessor.createMatrixEventSequencer(rows, cols, std::move(channel));
+        return cabbageProcessor.createMatrixEventSequencer(rows, cols, channel);
+
+    return -1;
 }
 
-void CabbagePluginEditor::setEventMatrixData(int cols, int rows, const String& channel, String data)
+void CabbagePluginEditor::setEventMatrixData(int sequencerIndex, int col, int row, const String& data)
 {
     if (cabbageProcessor.csdCompiledWithoutError())
-        cabbageProcessor.setMatrixEventSequencerCellData(cols, rows, channel, data);
+        cabbageProcessor.setMatrixEventSequencerCellData(sequencerIndex, col, row, data);
 }
 
 
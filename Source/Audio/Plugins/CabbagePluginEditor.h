@@ -84,7 +84,10 @@ public:
     void resized() override;
     void paint (Graphics& g)  override {
         ignoreUnused(g);
+        repaintStartTicks = Time::getHighResolutionTicks();
     }
+    //ends the trace zone paint() started, so that it covers the widgets painted in between
+    void paintOverChildren (Graphics& g) override;
     //==============================================================================
     void setupWindow (ValueTree cabbageWidgetData);
 
@@ -140,11 +143,15 @@ public:
 	//=============================================================================
     // all these methods expose public methods in CabagePluginProcessor
     void sendChannelDataToCsound (const String& channel, float value);
+    //handles come from getChannelHandle(), the value reaches Csound at the next k-boundary. Widgets
+    //resolve theirs once, see CabbageWidgetBase::getChannelHandle()
+    void sendChannelDataToCsound (int channelHandle, float value);
+    int getChannelHandle (const String& channel);
     void sendChannelStringDataToCsound (const String& channel, String value);
     float getChannelDataFromCsound (const String& channel);
     void sendScoreEventToCsound (const String& scoreEvent);
-    void createEventMatrix(int cols, int rows, String channel);
-    void setEventMatrixData(int cols, int rows, const String& channel, String data);
+    int createEventMatrix(int cols, int rows, const String& channel);
+    void setEventMatrixData(int sequencerIndex, int col, int row, const String& data);
     void setEventMatrixCurrentPosition(int cols, int rows, String channel, int position);
 
     bool shouldUpdateSignalDisplay(String variableName);
@@ -347,6 +354,10 @@ private:
     
     File customFontFile;
     OpenGLContext openGLContext;
+    int64 repaintStartTicks = 0;
+
+    //starts decoding the skin images of parent's widgets before they are first painted
+    void prepareWidgetImages (Component& parent);
     
     class ViewportContainer : public Component
     {
@@ -372,6 +383,18 @@ private:
     std::unique_ptr<Viewport> viewport;
     std::unique_ptr<ViewportContainer> viewportContainer;
     OwnedArray<Component> components = {};
+    HashMap<Component*, ValueTree> widgetBindings;
+    Component* lastWidgetUnderMouse = nullptr;
+
+    struct EditorChannelHandles
+    {
+        int x = -1, y = -1;
+        int downLeft = -1, downRight = -1, downMiddle = -1;
+        int wheelDeltaX = -1, wheelDeltaY = -1;
+        int screenWidth = -1, screenHeight = -1;
+    };
+
+    EditorChannelHandles editorChannels;
     Array<Component*> radioComponents;
     OwnedArray<PopupDocumentWindow> popupPlants;
     String lastOpenedDirectory;
@@ -20,7 +20,9 @@
 #include "CabbagePluginProcessor.h"
 
 #include <memory>
+#include <map>
 #include "CabbagePluginEditor.h"
+#include "../../Utilities/CabbageTrace.h"
 
 #if defined(_CR)
 #undef _CR
@@ -108,38 +110,31 @@ void CabbagePluginProcessor::createCsound(const File& inputFile, bool shouldCrea
 		setWidthHeight();
 		StringArray linesFromCsd;
 		linesFromCsd.addLines(inputFile.loadFileAsString());
+		csdFile = inputFile;
         
-		//only create extended temp file if imported plants are being added...
+		//only compile from memory if imported files are being added...
 		if (addImportFiles(linesFromCsd))
 		{
 			parseCsdFile(linesFromCsd);
 
-
-			File tempFile = File::createTempFile(inputFile.getFileNameWithoutExtension() + "_temp.csd");
-			tempFile.replaceWithText(linesFromCsd.joinIntoString("\n")
-				.replace("$lt;", "<")
-				.replace("&amp;", "&")
-				.replace("$quote;", "\"")
-				.replace("$gt;", ">"));
-
-
-			//CabbageUtilities::debug(tempFile.loadFileAsString());
-
-			if (!setupAndCompileCsound(tempFile, inputFile.getParentDirectory(), samplingRate))
+			if (!setupAndCompileCsound(inputFile, getExpandedCsdText(linesFromCsd), inputFile.getParentDirectory(), samplingRate))
 				this->suspendProcessing(true);
-
-			csdFile = tempFile;
-
 		}
 
 		else {
 			parseCsdFile(linesFromCsd);
-			csdFile = inputFile;
 			if (!setupAndCompileCsound(inputFile, inputFile.getParentDirectory(), samplingRate))
 				this->suspendProcessing(true);
 		}
 
         initAllCsoundChannels(cabbageWidgets);
+
+        //a new instrument starts with whatever notes its keyboarddisplays declare
+        for (auto* noteState : keyboardNoteStates)
+            noteState->setNotes(CabbageWidgetData::getProperty(cabbageWidgets.getChildWithName(noteState->getName()), CabbageIdentifierIds::keypressed));
+
+        Logger::writeToLog("CabbagePluginProcessor::createCsound - " + String(cabbageWidgets.getNumChildren()) + " widgets using "
+                           + File::descriptionOfSizeInBytes((int64) getWidgetMemoryUsage()));
         
 		if (shouldCreateParameters)
 			createCabbageParameters();
@@ -167,6 +162,8 @@ CabbagePluginProcessor::~CabbagePluginProcessor()
 
 void CabbagePluginProcessor::timerCallback()
 {
+    const CabbageTrace::ScopedZone traceZone ("CabbagePluginProcessor::timerCallback");
+
     if(autoUpdateCount == 0 && autoUpdateIsOn)
     {
         int64 modTime = csdFile.getLastModificationTime().toMilliseconds();
@@ -184,6 +181,25 @@ void CabbagePluginProcessor::timerCallback()
         if(this->canUpdate.load())
             getIdentifierDataFromCsound();
     }
+
+    for (XYPadAutomator* xyAuto : xyAutomators)
+    {
+        if (xyAuto->isRunning())
+        {
+            xyAuto->notifyHost();
+
+            if (editorIsOpen)
+                xyAuto->sendSynchronousChangeMessage();
+        }
+    }
+
+    //one pass per frame over everything the host has changed since the last one
+    hostAutomation.forEachChangedValue([this](int index, float value)
+    {
+        if (pollingChannels() == 0)
+            if (auto* param = parameters[index])
+                updateWidgetFromParameter(*param, value);
+    });
     
     
     autoUpdateCount = autoUpdateCount < 500 ? autoUpdateCount+1 : 0;
@@ -255,7 +271,7 @@ void CabbagePluginProcessor::parseCsdFile(StringArray& linesFromCsd)
         {          
 			return;
         }
-        ValueTree tempWidget(Identifier("WidgetFromLine_" + std::to_string(lineNumber)));
+        ValueTree tempWidget(CabbageWidgetData::getLineIdentifier(lineNumber));
 
 		String currentLineOfCabbageCode = linesFromCsd[lineNumber].replace("\t", " ");
 
@@ -313,8 +329,9 @@ void CabbagePluginProcessor::parseCsdFile(StringArray& linesFromCsd)
 		CabbageWidgetData::setStringProp(newWidget, CabbageIdentifierIds::csdfile, csdFileFullPath);
 
 
-		CabbageWidgetData::setProperty(newWidget, CabbageIdentifierIds::macronames, macroNames);
-		CabbageWidgetData::setProperty(newWidget, CabbageIdentifierIds::macrostrings, macroStrings);
+		//every widget shares one copy of the macro table, which is only ever replaced, never changed
+		newWidget.setProperty(CabbageIdentifierIds::macronames, macroNames, nullptr);
+		newWidget.setProperty(CabbageIdentifierIds::macrostrings, macroStrings, nullptr);
 
 
 		const String typeOfWidget = CabbageWidgetData::getStringProp(newWidget, CabbageIdentifierIds::type);
@@ -419,7 +436,14 @@ bool CabbagePluginProcessor::shouldClosePlant(StringArray& linesFromCsd, int lin
 bool CabbagePluginProcessor::addImportFiles(StringArray& linesFromCsd) {
 
 	getMacros(linesFromCsd);
+	plantStructs.clear();
 	bool hasImportFiles = false;
+
+	//imported text is collected against the form line it follows, and plant UDOs against
+	//<CsInstruments>, then everything is spliced into the csd in a single pass below
+	std::map<int, StringArray> linesToInsertAfter;
+	StringArray udoLines;
+
 	for (int i = 0; i < linesFromCsd.size(); i++) {
 		ValueTree temp("temp");
 		String newCsdLine = linesFromCsd[i];
@@ -436,29 +460,57 @@ bool CabbagePluginProcessor::addImportFiles(StringArray& linesFromCsd) {
 				//                CabbageUtilities::debug(
 				//                        csdFile.getParentDirectory().getChildFile(files[y].toString()).getFullPathName());
 
-				if (csdFile.getParentDirectory().getChildFile(files[y].toString()).existsAsFile()) {
-					StringArray linesFromImportedFile;
-					linesFromImportedFile.addLines(
-						csdFile.getParentDirectory().getChildFile(files[y].toString()).loadFileAsString());
+				const File importedFile = csdFile.getParentDirectory().getChildFile(files[y].toString());
 
-					std::unique_ptr<XmlElement> xml(XmlDocument::parse(CabbageUtilities::getPlantFileAsXmlString(
-						csdFile.getParentDirectory().getChildFile(files[y].toString()))));
+				if (importedFile.existsAsFile()) {
+					const String importedText = importedFile.loadFileAsString();
+					PlantImportStruct importData;
+					const ImportType importType = getImportFromText(importedText, importData);
 
-					if (!xml) //if plain text...
+					if (importType == ImportType::plainText)
 					{
-						for (int p = linesFromImportedFile.size(); p >= 0; p--) {
-							linesFromCsd.insert(i + 1, linesFromImportedFile[p]);
-						}
+						//each file goes directly after the form, ahead of those imported before it
+						StringArray linesFromImportedFile;
+						linesFromImportedFile.addLines(importedText);
+						linesFromImportedFile.add("");
+						linesFromImportedFile.addArray(linesToInsertAfter[i]);
+						linesToInsertAfter[i].swapWith(linesFromImportedFile);
 					}
-					else//if plant xml
+					else if (importType == ImportType::plant)
 					{
-						handleXmlImport(xml.get(), linesFromCsd);
+						insertUDOCode(importData, udoLines);
+						plantStructs.add(importData);
 					}
 				}
 			}
 		}
 	}
 
+	if (hasImportFiles)
+	{
+		StringArray expandedLines;
+		bool udoCodeInserted = false;
+
+		for (int i = 0; i < linesFromCsd.size(); i++)
+		{
+			expandedLines.add(linesFromCsd[i]);
+
+			//todo don't check blocks of commented code
+			if (!udoCodeInserted && linesFromCsd[i] == "<CsInstruments>")
+			{
+				expandedLines.addArray(udoLines);
+				udoCodeInserted = true;
+			}
+
+			auto importedLines = linesToInsertAfter.find(i);
+
+			if (importedLines != linesToInsertAfter.end())
+				expandedLines.addArray(importedLines->second);
+		}
+
+		linesFromCsd.swapWith(expandedLines);
+	}
+
 	// once all plants have been imported to plantStructs array,
 	// add them to Cabbage section
 	insertPlantCode(linesFromCsd);
@@ -466,9 +518,45 @@ bool CabbagePluginProcessor::addImportFiles(StringArray& linesFromCsd) {
 	return hasImportFiles;
 }
 
-void CabbagePluginProcessor::handleXmlImport(XmlElement* xml, StringArray& linesFromCsd) {
-	PlantImportStruct importData;
+CabbagePluginProcessor::ImportType CabbagePluginProcessor::getImportFromText(const String& importedText, PlantImportStruct& importData) {
+	struct CachedImport
+	{
+		ImportType type;
+		PlantImportStruct importData;
+	};
+
+	//shared by every instance, so a session full of the same instrument parses each plant,
+	//and runs its cabbagecodescript, once. Keyed by the text, so an edited plant is parsed again
+	static CriticalSection lock;
+	static std::map<int64, CachedImport> importsForText;
+	const int64 textHash = importedText.hashCode64();
+
+	{
+		const ScopedLock sl(lock);
+		auto cached = importsForText.find(textHash);
+
+		if (cached != importsForText.end()) {
+			importData = cached->second.importData;
+			return cached->second.type;
+		}
+	}
+
+	ImportType type = ImportType::plainText;
+	std::unique_ptr<XmlElement> xml(XmlDocument::parse(CabbageUtilities::getPlantTextAsXmlString(importedText)));
+
+	if (xml)
+		type = handleXmlImport(xml.get(), importData) ? ImportType::plant : ImportType::otherXml;
+
+	const ScopedLock sl(lock);
 
+	if (importsForText.size() >= 64)
+		importsForText.clear();
+
+	importsForText[textHash] = { type, importData };
+	return type;
+}
+
+bool CabbagePluginProcessor::handleXmlImport(XmlElement* xml, PlantImportStruct& importData) {
 	if (xml->hasTagName("plant")) {
 		forEachXmlChildElement(*xml, e)
 		{
@@ -490,21 +578,26 @@ void CabbagePluginProcessor::handleXmlImport(XmlElement* xml, StringArray& lines
 
 		//CabbageUtilities::debug(importData.cabbageCode.joinIntoString("\n"));
 		//numberOfLinesInPlantCode += importData.cabbageCode.size()+1;
-		insertUDOCode(importData, linesFromCsd);
-		plantStructs.add(importData);
+		return true;
 	}
+
+	return false;
 }
 
 void CabbagePluginProcessor::insertPlantCode(StringArray& linesFromCsd) {
 	getMacros(linesFromCsd);
 
-	const StringArray copy = linesFromCsd;
+	//plant code goes in ahead of the line that uses it, so the csd is copied over once with the plants added
+	const StringArray& copy = linesFromCsd;
+	StringArray linesWithPlants;
+	linesWithPlants.ensureStorageAllocated(linesFromCsd.size());
+	bool isInCabbageSection = true;
 
 	for (int lineIndex = 0; lineIndex < linesFromCsd.size(); lineIndex++) {
 		String currentLineOfCode = linesFromCsd[lineIndex];
 		if (currentLineOfCode.trim().startsWith("</Cabbage>"))
-			return;
-		if (currentLineOfCode.isNotEmpty() && currentLineOfCode.substring(0, 1) != ";") {
+			isInCabbageSection = false;
+		if (isInCabbageSection && currentLineOfCode.isNotEmpty() && currentLineOfCode.substring(0, 1) != ";") {
 
 			float scaleX = 1;
 			float scaleY = 1;
@@ -512,7 +605,7 @@ void CabbagePluginProcessor::insertPlantCode(StringArray& linesFromCsd) {
 			ValueTree temp("temp");
 			expandMacroText(currentLineOfCode);
 			// CabbageUtilities::debug(currentLineOfCode);
-			CabbageWidgetData::setWidgetState(temp, currentLineOfCode.trim(), lineIndex);
+			CabbageWidgetData::setWidgetState(temp, currentLineOfCode.trim(), linesWithPlants.size());
 			const String type = CabbageWidgetData::getStringProp(temp, CabbageIdentifierIds::type);
 			const String nsp = CabbageWidgetData::getStringProp(temp, CabbageIdentifierIds::nsp);
 
@@ -584,8 +677,8 @@ void CabbagePluginProcessor::insertPlantCode(StringArray& linesFromCsd) {
 									CabbageWidgetData::setStringProp(temp1, CabbageIdentifierIds::identchannel,
 										channelPrefix + currentIdentChannel);
 
-								CabbageWidgetData::setProperty(temp1, CabbageIdentifierIds::macronames, macroNames);
-								CabbageWidgetData::setProperty(temp1, CabbageIdentifierIds::macrostrings, macroStrings);
+								temp1.setProperty(CabbageIdentifierIds::macronames, macroNames, nullptr);
+								temp1.setProperty(CabbageIdentifierIds::macrostrings, macroStrings, nullptr);
 
 								//by the time it gets here it's not picked up the right channels....
 
@@ -609,10 +702,7 @@ void CabbagePluginProcessor::insertPlantCode(StringArray& linesFromCsd) {
 						}
 					}
 
-					for (int y = 0; y < importedLines.size(); y++) {
-						linesFromCsd.insert(lineIndex + y, importedLines[y]);
-					}
-					lineIndex += importedLines.size();
+					linesWithPlants.addArray(importedLines);
 					importedLines.clear();
 
 				}
@@ -621,31 +711,66 @@ void CabbagePluginProcessor::insertPlantCode(StringArray& linesFromCsd) {
 
 		}
 
+		linesWithPlants.add(linesFromCsd[lineIndex]);
 	}
+
+	linesFromCsd.swapWith(linesWithPlants);
 }
 
 
-void CabbagePluginProcessor::insertUDOCode(const PlantImportStruct& importData, StringArray& linesFromCsd) {
-	//todo don't check blocks of commented code
-	for (auto str : linesFromCsd) {
-		//str = str.replaceCharacters("\t", " ").trim();
-		if (str == "<CsInstruments>") {
-			StringArray strArray;
-			strArray.addLines(importData.csoundCode);
+void CabbagePluginProcessor::insertUDOCode(const PlantImportStruct& importData, StringArray& udoLines) {
+	//each plant's code goes in ahead of those added before it
+	StringArray strArray;
+	strArray.addLines(importData.csoundCode);
+	strArray.add("");
+	strArray.addArray(udoLines);
+	udoLines.swapWith(strArray);
+}
+
+String CabbagePluginProcessor::getExpandedCsdText(const StringArray& linesFromCsd) {
+	//plants escape these inside their XML, they're restored while the lines are joined
+	static const std::pair<const char*, const char*> escapedText[] = { { "$lt;", "<" }, { "&amp;", "&" }, { "$quote;", "\"" }, { "$gt;", ">" } };
 
-			const int lineToInsertTo = linesFromCsd.indexOf(str) + 1;
+	size_t numBytes = 0;
 
-			for (int y = strArray.size(); y >= 0; y--)
-				linesFromCsd.insert(lineToInsertTo, strArray[y]);
+	for (auto& line : linesFromCsd)
+		numBytes += line.getNumBytesAsUTF8() + 1;
 
+	MemoryOutputStream csdText;
+	csdText.preallocate(numBytes);
 
+	for (int i = 0; i < linesFromCsd.size(); i++) {
+		if (i > 0)
+			csdText << "\n";
 
-			return;
+		for (auto text = linesFromCsd[i].getCharPointer(); !text.isEmpty();) {
+			bool wasEscaped = false;
+
+			if (*text == '$' || *text == '&') {
+				for (auto& escaped : escapedText) {
+					const int length = (int) strlen(escaped.first);
+
+					if (text.compareUpTo(CharPointer_ASCII(escaped.first), length) == 0) {
+						csdText << escaped.second;
+						text += length;
+						wasEscaped = true;
+						break;
+					}
+				}
+			}
+
+			if (!wasEscaped)
+				csdText.appendUTF8Char(text.getAndAdvance());
 		}
 	}
+
+	return csdText.toUTF8();
 }
 
 void CabbagePluginProcessor::generateCabbageCodeFromJS(PlantImportStruct& importData, const String& text) {
+	//each script's output is kept apart, so it can be cached with the plant it came from
+	cabbageScriptGeneratedCode.clear();
+
 	JavascriptEngine engine;
 	engine.maximumExecutionTime = RelativeTime::seconds(5);
 	engine.registerNativeObject("Cabbage", new CabbageJavaClass(this));
@@ -690,18 +815,20 @@ void CabbagePluginProcessor::getMacros(const StringArray& linesFromCsd) {
 				macroText.set("$" + tokens[1], " " + currentMacroText);              
 				tempMacroNames.append("$" + tokens[1]);
 				tempMacroStrings.append(" " + currentMacroText.trim());
-				macroNames = tempMacroNames;
-				macroStrings = tempMacroStrings;
 			}
 		}
 	}
 
 	macroText.set("$SCREEN_WIDTH", String(screenWidth));
 	macroText.set("$SCREEN_HEIGHT", String(screenHeight));
-	macroNames.append("$SCREEN_WIDTH");
-	macroNames.append("$SCREEN_HEIGHT");
-	macroStrings.append(String(screenWidth));
-	macroStrings.append(String(screenHeight));
+	tempMacroNames.append("$SCREEN_WIDTH");
+	tempMacroNames.append("$SCREEN_HEIGHT");
+	tempMacroStrings.append(String(screenWidth));
+	tempMacroStrings.append(String(screenHeight));
+
+	//new arrays each time, as widgets from the last parse may still share the old ones
+	macroNames = tempMacroNames;
+	macroStrings = tempMacroStrings;
 
 
 }
@@ -757,6 +884,15 @@ void CabbagePluginProcessor::recreateWidgets(const String& csdText, bool editMod
 
 void CabbagePluginProcessor::addCabbageParameter(std::unique_ptr<CabbagePluginParameter> parameter)
 {
+	//automation slots share their index with the parameter, see timerCallback()
+	const String widgetType = CabbageWidgetData::getStringProp(parameter->getWidgetData(), CabbageIdentifierIds::type);
+	const bool canRamp = !parameter->getIsCombo() && (widgetType.contains("slider") || widgetType.contains("encoder")
+		|| widgetType.contains("range") || widgetType == CabbageWidgetTypes::xypad);
+	const float smoothingTimeMs = CabbageWidgetData::getNumProp(parameter->getWidgetData(), CabbageIdentifierIds::smoothing);
+	const int automationIndex = addHostAutomationChannel(parameter->getChannel(), canRamp, canRamp ? smoothingTimeMs : 0.f);
+	jassert(automationIndex == parameters.size());
+	parameter->setAutomationIndex(automationIndex);
+
 	if (parameter->getIsAutomatable()) {
 		addParameter(parameter->releaseHostParameter());
 	}
@@ -1606,7 +1742,8 @@ void CabbagePluginProcessor::setParametersFromXml(XmlElement* e)
 
 void CabbagePluginProcessor::getIdentifierDataFromCsound()
 {
-    
+    const CabbageTrace::ScopedZone traceZone ("getIdentifierDataFromCsound");
+
     if(!getCsound())
         return;
 
@@ -1662,6 +1799,11 @@ void CabbagePluginProcessor::getIdentifierDataFromCsound()
                             cabbageWidgets.getChildWithName(name).setProperty(CabbageIdentifierIds::pivotx, i.args[1], nullptr);
                             cabbageWidgets.getChildWithName(name).setProperty(CabbageIdentifierIds::pivoty, i.args[2], nullptr);
                         }
+                        else if (identifier == CabbageIdentifierIds::keypressed && widgetType == CabbageWidgetTypes::keyboarddisplay)
+                        {
+                            //held notes can change every k-cycle, so they go straight to the display and skip the value tree
+                            getKeyboardNoteState(name.toString()).setNotes(i.args);
+                        }
                         /*else if (widgetType == CabbageWidgetTypes::hrange || widgetType == CabbageWidgetTypes::hrange &&
                             identifier == CabbageIdentifierIds::value)
                         {
@@ -1890,13 +2032,15 @@ void CabbagePluginProcessor::addXYAutomator(CabbageXYPad* xyPad, const ValueTree
 		CabbagePluginParameter* yParameter = getParameterForXYPad(xyPad->getName() + "_y");
 
 		if (xParameter && yParameter) {
-			xyAutomators.add(xyAuto = new XYPadAutomator(xyPad->getName(), xParameter, yParameter, this));
-			xyAuto->setXMin(CabbageWidgetData::getNumProp(wData, CabbageIdentifierIds::minx));
-			xyAuto->setYMin(CabbageWidgetData::getNumProp(wData, CabbageIdentifierIds::miny));
-			xyAuto->setXMax(CabbageWidgetData::getNumProp(wData, CabbageIdentifierIds::maxx));
-			xyAuto->setYMax(CabbageWidgetData::getNumProp(wData, CabbageIdentifierIds::maxy));
-			xyAuto->removeAllChangeListeners();
+			xyAuto = new XYPadAutomator(xyPad->getName(), xParameter, yParameter, this);
+			xyAuto->setRange(CabbageWidgetData::getNumProp(wData, CabbageIdentifierIds::minx),
+				CabbageWidgetData::getNumProp(wData, CabbageIdentifierIds::maxx),
+				CabbageWidgetData::getNumProp(wData, CabbageIdentifierIds::miny),
+				CabbageWidgetData::getNumProp(wData, CabbageIdentifierIds::maxy));
 			xyAuto->addChangeListener(xyPad);
+
+			const SpinLock::ScopedLockType sl(xyAutomatorLock);
+			xyAutomators.add(xyAuto);
 		}
 	}
 	else {
@@ -1910,31 +2054,49 @@ void CabbagePluginProcessor::enableXYAutomator(String name, bool enable, Line<fl
 
 	for (XYPadAutomator* xyAuto : xyAutomators) {
 		if (name == xyAuto->getName()) {
-			if (enable == true) {
-				xyAuto->setDragLine(dragLine);
-				xyAuto->setXValue(dragLine.getEndX());
-				xyAuto->setYValue(dragLine.getEndY());
-				xyAuto->setXValueIncrement((dragLine.getEndX() - dragLine.getStartX()) * .05);
-				xyAuto->setYValueIncrement((dragLine.getEndY() - dragLine.getStartY()) * .05);
-				xyAuto->setRepaintBackground(true);
-                if(editorIsOpen)
-                    xyAuto->setIsPluginEditorOpen(true);
-				xyAuto->startTimer(20);
-			}
+			if (enable == true)
+				xyAuto->start(dragLine);
 			else
-				xyAuto->stopTimer();
+				xyAuto->stop();
 		}
 	}
 }
 
 void CabbagePluginProcessor::disableXYAutomators() 
 {
+	//automators keep running without the editor, they just stop telling the xypads
 	for (XYPadAutomator* xyAuto : xyAutomators) 
 	{
-		xyAuto->setIsPluginEditorOpen(false);
+		xyAuto->removeAllChangeListeners();
 	}
 }
 
+void CabbagePluginProcessor::advanceAutomation(double seconds)
+{
+	const SpinLock::ScopedTryLockType sl(xyAutomatorLock);
+
+	if (!sl.isLocked())
+	{
+		processorStats.addLockMiss();
+		return;
+	}
+
+	for (XYPadAutomator* xyAuto : xyAutomators)
+		xyAuto->advance(seconds);
+}
+
+//======================================================================================================
+CabbageKeyboardNoteState& CabbagePluginProcessor::getKeyboardNoteState(const String& widgetName)
+{
+	for (auto* noteState : keyboardNoteStates)
+		if (noteState->getName() == widgetName)
+			return *noteState;
+
+	auto* noteState = keyboardNoteStates.add(new CabbageKeyboardNoteState(widgetName));
+	noteState->setNotes(CabbageWidgetData::getProperty(cabbageWidgets.getChildWithName(widgetName), CabbageIdentifierIds::keypressed));
+	return *noteState;
+}
+
 //======================================================================================================
 CabbagePluginParameter* CabbagePluginProcessor::getParameterForXYPad(StringRef name) const {
 	for (auto param : getCabbageParameters()) {
@@ -1948,39 +2110,39 @@ CabbagePluginParameter* CabbagePluginProcessor::getParameterForXYPad(StringRef n
 }
 
 //==============================================================================
-void CabbagePluginProcessor::setCabbageParameter(String& channel, float value, ValueTree& wData)
+void CabbagePluginProcessor::setCabbageParameter(int automationIndex, float value)
 {
-    if(pollingChannels() == 0){
-        MessageManager::callAsync ([ wData, channel, value](){
-            const String widgetType = CabbageWidgetData::getStringProp(wData, CabbageIdentifierIds::type);
-            if(widgetType == CabbageWidgetTypes::hrange || widgetType == CabbageWidgetTypes::vrange)
-            {
-                var channels = CabbageWidgetData::getProperty(wData, CabbageIdentifierIds::channel);
-                if(channel == channels[0].toString())
-                    CabbageWidgetData::setNumProp(wData, CabbageIdentifierIds::minvalue, value);
-                else
-                    CabbageWidgetData::setNumProp(wData, CabbageIdentifierIds::maxvalue, value);
-                
-            }
-            else if(widgetType == CabbageWidgetTypes::xypad)
-            {
-                var channels = CabbageWidgetData::getProperty(wData, CabbageIdentifierIds::channel);
-                if(channel == channels[0].toString())
-                    CabbageWidgetData::setNumProp(wData, CabbageIdentifierIds::valuex, value);
-                else
-                    CabbageWidgetData::setNumProp(wData, CabbageIdentifierIds::valuey, value);
-            }
-            
-            else
-                CabbageWidgetData::setNumProp(wData, CabbageIdentifierIds::value, value);
-        });
-    }
-    
-    if (getCsound())
-		getCsound()->SetChannel(channel.toUTF8().getAddress(), value);
-    
+    //may be called from the audio thread, so the value is only queued here. It reaches
+    //Csound at the next k-boundary, and the widget on the next timer callback
+    hostAutomation.setValue(automationIndex, value);
+}
 
+void CabbagePluginProcessor::updateWidgetFromParameter(CabbagePluginParameter& parameter, float value)
+{
+    ValueTree wData = parameter.getWidgetData();
+    const String channel = parameter.getChannel();
+    const String widgetType = CabbageWidgetData::getStringProp(wData, CabbageIdentifierIds::type);
+
+    if(widgetType == CabbageWidgetTypes::hrange || widgetType == CabbageWidgetTypes::vrange)
+    {
+        var channels = CabbageWidgetData::getProperty(wData, CabbageIdentifierIds::channel);
+        if(channel == channels[0].toString())
+            CabbageWidgetData::setNumProp(wData, CabbageIdentifierIds::minvalue, value);
+        else
+            CabbageWidgetData::setNumProp(wData, CabbageIdentifierIds::maxvalue, value);
+        
+    }
+    else if(widgetType == CabbageWidgetTypes::xypad)
+    {
+        var channels = CabbageWidgetData::getProperty(wData, CabbageIdentifierIds::channel);
+        if(channel == channels[0].toString())
+            CabbageWidgetData::setNumProp(wData, CabbageIdentifierIds::valuex, value);
+        else
+            CabbageWidgetData::setNumProp(wData, CabbageIdentifierIds::valuey, value);
+    }
     
+    else
+        CabbageWidgetData::setNumProp(wData, CabbageIdentifierIds::value, value);
 }
 
 void CabbagePluginProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
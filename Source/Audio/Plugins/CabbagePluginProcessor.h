@@ -26,6 +26,7 @@
 #include "../../Widgets/CabbageWidgetData.h"
 #include "../../CabbageIds.h"
 #include "../../Widgets/CabbageXYPad.h"
+#include "../../Widgets/CabbageKeyboardNoteState.h"
 
 class CabbagePluginParameter;
 
@@ -67,6 +68,14 @@ public:
         StringArray cabbageCode;
     };
 
+    //what a file named in a form's importfiles() turned out to be
+    enum class ImportType
+    {
+        plainText,
+        plant,
+        otherXml
+    };
+
     File output;
 	CabbagePluginProcessor (const File& inputFile, BusesProperties IOBuses);
 	void createCsound(const File& inputFile, bool shouldCreateParameters = true);
@@ -99,18 +108,22 @@ public:
     void addCabbageParameter(std::unique_ptr<CabbagePluginParameter> parameter);
     void createCabbageParameters();
     void recreateWidgets (const String& csdText, bool editMode = false);
-    void handleXmlImport (XmlElement* xml, StringArray& linesFromCsd);
+    ImportType getImportFromText (const String& importedText, PlantImportStruct& importData);
+    bool handleXmlImport (XmlElement* xml, PlantImportStruct& importData);
     void getMacros (const StringArray& csdText);
     void generateCabbageCodeFromJS (PlantImportStruct& importData, const String& text);
-    static void insertUDOCode (const PlantImportStruct& importData, StringArray& linesFromCsd);
+    static void insertUDOCode (const PlantImportStruct& importData, StringArray& udoLines);
     void insertPlantCode (StringArray& linesFromCsd);
+    static String getExpandedCsdText (const StringArray& linesFromCsd);
     static bool isWidgetPlantParent (StringArray& linesFromCsd, int lineNumber);
     static bool shouldClosePlant (StringArray& linesFromCsd, int lineNumber);
     void setPluginName (String name) {    pluginName = std::move(name);  }
     String getPluginName() { return pluginName;  }
     void expandMacroText (String &line);
+    //approximate memory held by this instance's widget data
+    size_t getWidgetMemoryUsage() const {   return CabbageWidgetData::getMemoryUsage (cabbageWidgets);   }
 	void prepareToPlay(double sampleRate, int samplesPerBlock) override;
-	void setCabbageParameter(String& channel, float value, ValueTree& wData);
+	void setCabbageParameter(int automationIndex, float value);
     CabbagePluginParameter* getParameterForXYPad (StringRef name) const;
     //==============================================================================
     AudioProcessorEditor* createEditor() override;
@@ -121,6 +134,9 @@ public:
     void addXYAutomator (CabbageXYPad* xyPad, const ValueTree& wData);
     void enableXYAutomator (String name, bool enable, Line<float> dragLine);
     void disableXYAutomators();
+    void advanceAutomation (double seconds) override;
+    //===== keyboarddisplay methods =========
+    CabbageKeyboardNoteState& getKeyboardNoteState (const String& widgetName);
     //==============================================================================
     void getStateInformation (MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
@@ -130,6 +146,8 @@ public:
     //==============================================================================
     StringArray cabbageScriptGeneratedCode;
     Array<PlantImportStruct> plantStructs;
+    //held notes for each keyboarddisplay, kept for the life of the processor so open displays can hold on to them
+    OwnedArray<CabbageKeyboardNoteState> keyboardNoteStates;
 
     int64 csdLastModifiedAt{};
     void timerCallback() override;
@@ -203,10 +221,12 @@ private:
     var macroNames;
     var macroStrings;
     OwnedArray<XYPadAutomator> xyAutomators;
+    SpinLock xyAutomatorLock;
 	int samplingRate = 44100;
 	int screenWidth{}, screenHeight{};
 
     OwnedArray<CabbagePluginParameter> parameters;
+    void updateWidgetFromParameter(CabbagePluginParameter& parameter, float value);
     Font customFont;
     File customFontFile;
 
@@ -303,7 +323,10 @@ public:
     
     String getChannel() const { return parameter->getChannel(); }
     String getWidgetName() { return widgetName; }
+    ValueTree getWidgetData() const { return parameter->valueTree; }
     bool getIsAutomatable() const { return isAutomatable; }
+    bool getIsCombo() const { return parameter->isCombo; }
+    void setAutomationIndex(int index) { parameter->automationIndex = index; }
     bool isPerformingGesture = false;
     
 private:
@@ -319,10 +342,10 @@ private:
 
             if (isCombo && items.size() > 0)
             {
-                processor->setCabbageParameter(channel, std::floor(newValue * (items.size())), valueTree);
+                processor->setCabbageParameter(automationIndex, std::floor(newValue * (items.size())));
             }
             else
-                processor->setCabbageParameter(channel, currentValue, valueTree);
+                processor->setCabbageParameter(automationIndex, currentValue);
         }
         
         String getText(float normalizedValue, int length) const override
@@ -413,6 +436,7 @@ private:
         const String postfix { };
         float currentValue;
         bool isCombo = false;
+        int automationIndex = -1;
         StringArray items = {};
         
         CabbagePluginProcessor* processor;
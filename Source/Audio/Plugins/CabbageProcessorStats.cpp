@@ -0,0 +1,168 @@
+/*
+  Copyright (C) 2016 Rory Walsh
+
+  Cabbage is free software; you can redistribute it
+  and/or modify it under the terms of the GNU General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  Cabbage is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public
+  License along with Csound; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+  02111-1307 USA
+*/
+
+#include "CabbageProcessorStats.h"
+
+//==============================================================================
+CabbageProcessorStats::Histogram::Snapshot CabbageProcessorStats::Histogram::getSnapshot() const noexcept
+{
+    Snapshot snapshot;
+
+    for (int i = 0; i < numBuckets; ++i)
+        snapshot.counts[i] = counts[i].load (std::memory_order_relaxed);
+
+    snapshot.numValues = numValues.load (std::memory_order_relaxed);
+    snapshot.sum = sum.load (std::memory_order_relaxed);
+    return snapshot;
+}
+
+CabbageProcessorStats::Histogram::Snapshot CabbageProcessorStats::Histogram::Snapshot::operator- (const Snapshot& older) const noexcept
+{
+    Snapshot difference;
+
+    for (int i = 0; i < numBuckets; ++i)
+        difference.counts[i] = counts[i] - older.counts[i];
+
+    difference.numValues = numValues - older.numValues;
+    difference.sum = sum - older.sum;
+    return difference;
+}
+
+double CabbageProcessorStats::Histogram::Snapshot::getMean() const noexcept
+{
+    return numValues > 0 ? (double) sum / (double) numValues : 0.0;
+}
+
+uint64 CabbageProcessorStats::Histogram::Snapshot::getPercentile (double proportion) const noexcept
+{
+    uint64 bucketTotal = 0;
+
+    for (auto count : counts)
+        bucketTotal += count;
+
+    if (bucketTotal == 0)
+        return 0;
+
+    const auto target = (uint64) std::ceil (jlimit (0.0, 1.0, proportion) * (double) bucketTotal);
+    uint64 seen = 0;
+
+    for (int i = 0; i < numBuckets; ++i)
+    {
+        seen += counts[i];
+
+        if (seen >= jmax ((uint64) 1, target))
+            return i == 0 ? 0 : ((uint64) 1 << i) - 1;
+    }
+
+    return ((uint64) 1 << (numBuckets - 1)) - 1;
+}
+
+var CabbageProcessorStats::Histogram::Snapshot::toVar() const
+{
+    auto* object = new DynamicObject();
+    Array<var> buckets;
+
+    //trailing empty buckets are left out
+    int numUsedBuckets = numBuckets;
+
+    while (numUsedBuckets > 0 && counts[numUsedBuckets - 1] == 0)
+        --numUsedBuckets;
+
+    for (int i = 0; i < numUsedBuckets; ++i)
+        buckets.add ((int64) counts[i]);
+
+    object->setProperty ("count", (int64) numValues);
+    object->setProperty ("mean", getMean());
+    object->setProperty ("p50", (int64) getPercentile (0.5));
+    object->setProperty ("p99", (int64) getPercentile (0.99));
+    object->setProperty ("buckets", buckets);
+    return var (object);
+}
+
+//==============================================================================
+CabbageProcessorStats::Snapshot CabbageProcessorStats::getSnapshot() const noexcept
+{
+    Snapshot snapshot;
+    snapshot.blockTime = blockTime.getSnapshot();
+    snapshot.kCycleTime = kCycleTime.getSnapshot();
+    snapshot.midiEventsPerBlock = midiEventsPerBlock.getSnapshot();
+    snapshot.guiPollTime = guiPollTime.getSnapshot();
+    snapshot.numXruns = numXruns.load (std::memory_order_relaxed);
+    snapshot.numLockMisses = numLockMisses.load (std::memory_order_relaxed);
+    snapshot.audioTime = audioTime.load (std::memory_order_relaxed);
+    return snapshot;
+}
+
+CabbageProcessorStats::Snapshot CabbageProcessorStats::Snapshot::operator- (const Snapshot& older) const noexcept
+{
+    Snapshot difference;
+    difference.blockTime = blockTime - older.blockTime;
+    difference.kCycleTime = kCycleTime - older.kCycleTime;
+    difference.midiEventsPerBlock = midiEventsPerBlock - older.midiEventsPerBlock;
+    difference.guiPollTime = guiPollTime - older.guiPollTime;
+    difference.numXruns = numXruns - older.numXruns;
+    difference.numLockMisses = numLockMisses - older.numLockMisses;
+    difference.audioTime = audioTime - older.audioTime;
+    return difference;
+}
+
+float CabbageProcessorStats::Snapshot::getLoad() const noexcept
+{
+    if (audioTime == 0)
+        return -1.f;
+
+    return (float) ((double) blockTime.sum / (double) audioTime);
+}
+
+String CabbageProcessorStats::Snapshot::getSummary() const
+{
+    auto toMs = [] (double microseconds) { return String (microseconds / 1000.0, 3) + "ms"; };
+
+    return "block " + toMs (blockTime.getMean()) + " (p99 " + toMs ((double) blockTime.getPercentile (0.99)) + ")"
+         + ", k-cycle " + toMs (kCycleTime.getMean())
+         + ", gui poll " + toMs (guiPollTime.getMean())
+         + ", MIDI " + String (midiEventsPerBlock.getMean(), 1) + "/block"
+         + ", xruns " + String ((int64) numXruns)
+         + ", lock misses " + String ((int64) numLockMisses);
+}
+
+var CabbageProcessorStats::Snapshot::toVar() const
+{
+    auto* object = new DynamicObject();
+    object->setProperty ("blockTimeMicroseconds", blockTime.toVar());
+    object->setProperty ("kCycleTimeMicroseconds", kCycleTime.toVar());
+    object->setProperty ("midiEventsPerBlock", midiEventsPerBlock.toVar());
+    object->setProperty ("guiPollTimeMicroseconds", guiPollTime.toVar());
+    object->setProperty ("xruns", (int64) numXruns);
+    object->setProperty ("lockMisses", (int64) numLockMisses);
+    object->setProperty ("load", getLoad());
+    return var (object);
+}
+
+//==============================================================================
+bool CabbageProcessorStats::writeToFile (const File& file, const String& instanceName) const
+{
+    auto* object = new DynamicObject();
+    object->setProperty ("instance", instanceName);
+    object->setProperty ("time", Time::getCurrentTime().toISO8601 (true));
+    object->setProperty ("bucketRanges", "bucket 0 holds 0, bucket n holds values up to 2^n - 1");
+    object->setProperty ("stats", getSnapshot().toVar());
+
+    return file.replaceWithText (JSON::toString (var (object)));
+}
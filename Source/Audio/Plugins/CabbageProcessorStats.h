@@ -0,0 +1,156 @@
+/*
+  Copyright (C) 2016 Rory Walsh
+
+  Cabbage is free software; you can redistribute it
+  and/or modify it under the terms of the GNU General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  Cabbage is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public
+  License along with Csound; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+  02111-1307 USA
+*/
+
+#ifndef CABBAGEPROCESSORSTATS_H_INCLUDED
+#define CABBAGEPROCESSORSTATS_H_INCLUDED
+
+#include "JuceHeader.h"
+
+//==============================================================================
+// Always-on timing for one Cabbage instance: how long each processBlock and
+// each Csound k-cycle takes, how many MIDI events arrive per block, how often
+// a block overruns its real-time budget, how often the audio thread finds a
+// lock taken and skips work, and how long the message thread spends polling
+// Csound for the GUI.
+//
+// Everything is a running total in a relaxed atomic. Only one thread writes to
+// each one, so recording a value is a few loads and stores, with no locks and
+// no read-modify-write instructions. Readers take a Snapshot and subtract the
+// one they took last time, so each reader gets its own rolling window: the
+// reserved Csound channels, the IDE graph overlay and the exported stats file
+// don't interfere with each other.
+//==============================================================================
+class CabbageProcessorStats
+{
+public:
+    //==========================================================================
+    // Counts in power of two buckets. Bucket 0 holds zeros, and bucket n holds
+    // values from 2^(n-1) up to 2^n - 1, so percentiles are read as the upper
+    // edge of a bucket. Times are recorded in microseconds.
+    class Histogram
+    {
+    public:
+        static constexpr int numBuckets = 32;
+
+        struct Snapshot
+        {
+            uint64 counts[numBuckets] = {};
+            uint64 numValues = 0, sum = 0;
+
+            Snapshot operator- (const Snapshot& older) const noexcept;
+            double getMean() const noexcept;
+            uint64 getPercentile (double proportion) const noexcept;
+            var toVar() const;
+        };
+
+        //one writing thread at a time
+        void add (uint32 value) noexcept
+        {
+            int bucket = 0;
+
+            for (auto remaining = value; remaining != 0 && bucket < numBuckets - 1; remaining >>= 1)
+                ++bucket;
+
+            increment (counts[bucket], 1);
+            increment (numValues, 1);
+            increment (sum, value);
+        }
+
+        Snapshot getSnapshot() const noexcept;
+
+    private:
+        std::atomic<uint64> counts[numBuckets] = {};
+        std::atomic<uint64> numValues { 0 }, sum { 0 };
+    };
+
+    //==========================================================================
+    struct Snapshot
+    {
+        Histogram::Snapshot blockTime, kCycleTime, midiEventsPerBlock, guiPollTime;
+        uint64 numXruns = 0, numLockMisses = 0;
+        //microseconds of audio the timed blocks covered, for the load figure
+        uint64 audioTime = 0;
+
+        Snapshot operator- (const Snapshot& older) const noexcept;
+
+        //block time as a proportion of the audio it produced, -1 with no blocks
+        float getLoad() const noexcept;
+        String getSummary() const;
+        var toVar() const;
+    };
+
+    Snapshot getSnapshot() const noexcept;
+
+    //writes every histogram since the instance was created, as JSON
+    bool writeToFile (const File& file, const String& instanceName) const;
+
+    //==========================================================================
+    // Times the enclosing processBlock call.
+    struct ScopedBlock
+    {
+        ScopedBlock (CabbageProcessorStats& s, int numSamples, int numMidiEvents, double sampleRate) noexcept
+            : stats (s),
+              startTicks (Time::getHighResolutionTicks()),
+              blockMicroseconds (sampleRate > 0 ? (uint32) (numSamples * 1000000.0 / sampleRate) : 0)
+        {
+            stats.midiEventsPerBlock.add ((uint32) jmax (0, numMidiEvents));
+        }
+
+        ~ScopedBlock()
+        {
+            const uint32 elapsed = getMicrosecondsSince (startTicks);
+            stats.blockTime.add (elapsed);
+            increment (stats.audioTime, blockMicroseconds);
+
+            if (blockMicroseconds > 0 && elapsed > blockMicroseconds)
+                increment (stats.numXruns, 1);
+        }
+
+        CabbageProcessorStats& stats;
+        const int64 startTicks;
+        const uint32 blockMicroseconds;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedBlock)
+    };
+
+    //audio thread
+    void addKCycle (int64 startTicks) noexcept     {   kCycleTime.add (getMicrosecondsSince (startTicks));   }
+    void addLockMiss() noexcept                    {   increment (numLockMisses, 1);   }
+
+    //message thread
+    void addGuiPoll (int64 startTicks) noexcept    {   guiPollTime.add (getMicrosecondsSince (startTicks));   }
+
+    static uint32 getMicrosecondsSince (int64 startTicks) noexcept
+    {
+        const double seconds = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - startTicks);
+        return (uint32) jlimit (0.0, (double) std::numeric_limits<uint32>::max(), seconds * 1000000.0);
+    }
+
+private:
+    //load and store rather than fetch_add, there is only one writer
+    static void increment (std::atomic<uint64>& counter, uint64 amount) noexcept
+    {
+        counter.store (counter.load (std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    Histogram blockTime, kCycleTime, midiEventsPerBlock, guiPollTime;
+    std::atomic<uint64> numXruns { 0 }, numLockMisses { 0 }, audioTime { 0 };
+};
+
+#endif  // CABBAGEPROCESSORSTATS_H_INCLUDED
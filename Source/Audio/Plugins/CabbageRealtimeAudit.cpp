@@ -0,0 +1,192 @@
+/*
+  Copyright (C) 2016 Rory Walsh
+
+  Cabbage is free software; you can redistribute it
+  and/or modify it under the terms of the GNU General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  Cabbage is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public
+  License along with Csound; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+  02111-1307 USA
+*/
+
+#include "CabbageRealtimeAudit.h"
+
+#if Cabbage_RT_Audit
+
+#include <new>
+
+#if JUCE_LINUX
+ #include <dlfcn.h>
+ #include <pthread.h>
+#endif
+
+namespace
+{
+    thread_local int audioCallbackDepth = 0;
+
+    //set while a violation is being recorded, as recording one allocates and locks
+    thread_local bool isRecordingViolation = false;
+
+    struct Violation
+    {
+        CabbageRealtimeAudit::ViolationType type;
+        String stackTrace;
+        int count;
+    };
+
+    //the first violation creates the log, and the report is written when it is destroyed at exit
+    struct ViolationLog
+    {
+        ~ViolationLog()
+        {
+            if (violations.isEmpty())
+                return;
+
+            const String fileName = SystemStats::getEnvironmentVariable ("CABBAGE_RT_AUDIT_REPORT", {});
+            const File reportFile = fileName.isNotEmpty() ? File::getCurrentWorkingDirectory().getChildFile (fileName)
+                                                          : File::getSpecialLocation (File::tempDirectory).getChildFile ("CabbageRealtimeAudit.txt");
+            reportFile.replaceWithText (createReport());
+        }
+
+        String createReport()
+        {
+            const ScopedLock sl (lock);
+
+            Array<Violation> sorted (violations);
+            std::stable_sort (sorted.begin(), sorted.end(), [] (const Violation& a, const Violation& b) { return a.count > b.count; });
+
+            int total = 0;
+
+            for (auto& violation : sorted)
+                total += violation.count;
+
+            String report;
+            report << "Cabbage real-time audit: " << total << " violations from " << sorted.size() << " call stacks\n\n";
+
+            for (auto& violation : sorted)
+                report << violation.count << " x " << (violation.type == CabbageRealtimeAudit::ViolationType::allocation ? "allocation" : "mutex lock")
+                       << "\n" << violation.stackTrace << "\n";
+
+            return report;
+        }
+
+        CriticalSection lock;
+        Array<Violation> violations;
+        HashMap<String, int> indexOfStack;
+        int numViolations = 0;
+    };
+
+    ViolationLog& getViolationLog()
+    {
+        static ViolationLog log;
+        return log;
+    }
+}
+
+CabbageRealtimeAudit::ScopedAudioCallback::ScopedAudioCallback()     {   ++audioCallbackDepth;   }
+CabbageRealtimeAudit::ScopedAudioCallback::~ScopedAudioCallback()    {   --audioCallbackDepth;   }
+
+void CabbageRealtimeAudit::recordViolation (ViolationType type)
+{
+    if (audioCallbackDepth == 0 || isRecordingViolation)
+        return;
+
+    const ScopedValueSetter<bool> recording (isRecordingViolation, true);
+
+    //the first three frames are the backtrace itself, this function and the hook
+    StringArray frames;
+    frames.addLines (SystemStats::getStackBacktrace());
+    frames.removeRange (0, 3);
+    frames.removeEmptyStrings();
+    const String stackTrace = frames.joinIntoString ("\n");
+    const String key = String ((int) type) + stackTrace;
+
+    auto& log = getViolationLog();
+    const ScopedLock sl (log.lock);
+    ++log.numViolations;
+
+    if (log.indexOfStack.contains (key))
+    {
+        ++log.violations.getReference (log.indexOfStack[key]).count;
+        return;
+    }
+
+    log.indexOfStack.set (key, log.violations.size());
+    log.violations.add ({ type, stackTrace, 1 });
+}
+
+int CabbageRealtimeAudit::getNumViolations()
+{
+    const ScopedValueSetter<bool> recording (isRecordingViolation, true);
+    auto& log = getViolationLog();
+    const ScopedLock sl (log.lock);
+    return log.numViolations;
+}
+
+String CabbageRealtimeAudit::createReport()
+{
+    const ScopedValueSetter<bool> recording (isRecordingViolation, true);
+    return getViolationLog().createReport();
+}
+
+bool CabbageRealtimeAudit::writeReport (const File& file)
+{
+    return file.replaceWithText (createReport());
+}
+
+//==============================================================================
+static void* allocateForAudit (std::size_t size)
+{
+    CabbageRealtimeAudit::recordViolation (CabbageRealtimeAudit::ViolationType::allocation);
+
+    if (void* memory = std::malloc (size > 0 ? size : 1))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void* operator new (std::size_t size)                           {   return allocateForAudit (size);   }
+void* operator new[] (std::size_t size)                         {   return allocateForAudit (size);   }
+void operator delete (void* memory) noexcept                    {   std::free (memory);   }
+void operator delete[] (void* memory) noexcept                  {   std::free (memory);   }
+void operator delete (void* memory, std::size_t) noexcept       {   std::free (memory);   }
+void operator delete[] (void* memory, std::size_t) noexcept     {   std::free (memory);   }
+
+#if JUCE_LINUX
+//interposes every pthread_mutex_lock in the process, which covers CriticalSection,
+//std::mutex and Csound's own locks. Try-locks never block, so they aren't trapped
+extern "C" __attribute__ ((visibility ("default"))) int pthread_mutex_lock (pthread_mutex_t* mutex)
+{
+    using LockFunction = int (*) (pthread_mutex_t*);
+
+    //not a function static, as guarding its initialisation could lock a mutex
+    static std::atomic<LockFunction> realMutexLock { nullptr };
+    LockFunction lockFunction = realMutexLock.load (std::memory_order_relaxed);
+
+    if (lockFunction == nullptr)
+    {
+        lockFunction = (LockFunction) dlsym (RTLD_NEXT, "pthread_mutex_lock");
+        realMutexLock.store (lockFunction, std::memory_order_relaxed);
+    }
+
+    CabbageRealtimeAudit::recordViolation (CabbageRealtimeAudit::ViolationType::mutexLock);
+    return lockFunction (mutex);
+}
+#endif
+
+#else
+
+void CabbageRealtimeAudit::recordViolation (ViolationType)     {}
+int CabbageRealtimeAudit::getNumViolations()                    {   return 0;   }
+String CabbageRealtimeAudit::createReport()                     {   return "Cabbage was built without the real-time audit, configure with -DRealtimeAudit=1\n";   }
+bool CabbageRealtimeAudit::writeReport (const File& file)       {   return file.replaceWithText (createReport());   }
+
+#endif
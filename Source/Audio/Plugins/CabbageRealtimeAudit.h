@@ -0,0 +1,73 @@
+/*
+  Copyright (C) 2016 Rory Walsh
+
+  Cabbage is free software; you can redistribute it
+  and/or modify it under the terms of the GNU General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  Cabbage is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public
+  License along with Csound; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+  02111-1307 USA
+*/
+
+#ifndef CABBAGEREALTIMEAUDIT_H_INCLUDED
+#define CABBAGEREALTIMEAUDIT_H_INCLUDED
+
+#include "JuceHeader.h"
+
+#ifndef Cabbage_RT_Audit
+ #define Cabbage_RT_Audit 0
+#endif
+
+//==============================================================================
+// Real-time safety audit, built in by configuring with -DRealtimeAudit=1. While
+// a thread is inside CsoundPluginProcessor::processSamples(), every call to
+// operator new, and on Linux every blocking pthread mutex lock, is recorded
+// with a stack trace. Violations with the same stack are counted together.
+// Allocations Csound makes with malloc aren't seen, but the locks it takes are.
+//
+// The report is written when the process exits, to the file named by the
+// CABBAGE_RT_AUDIT_REPORT environment variable, or CabbageRealtimeAudit.txt in
+// the temp directory. The offline renderer can write it on demand, so a batch
+// of instruments can be audited from the command line:
+//
+//   Cabbage --render --batch=Source/Benchmark/RealtimeAudit.batch --rt-audit-report=audit.txt
+//
+// Without the build option, ScopedAudioCallback is empty and nothing is hooked.
+//==============================================================================
+class CabbageRealtimeAudit
+{
+public:
+    enum class ViolationType
+    {
+        allocation,
+        mutexLock
+    };
+
+    //marks the calling thread as running the audio callback for its lifetime
+    struct ScopedAudioCallback
+    {
+#if Cabbage_RT_Audit
+        ScopedAudioCallback();
+        ~ScopedAudioCallback();
+#else
+        ScopedAudioCallback() {}
+#endif
+    };
+
+    //called from the hooks, records nothing unless the calling thread is in the audio callback
+    static void recordViolation (ViolationType type);
+
+    static int getNumViolations();
+    static String createReport();
+    static bool writeReport (const File& file);
+};
+
+#endif  // CABBAGEREALTIMEAUDIT_H_INCLUDED
@@ -20,7 +20,10 @@
 #include "CsoundPluginProcessor.h"
 
 #include <memory>
+#include <numeric>
 #include "CsoundPluginEditor.h"
+#include "CabbageRealtimeAudit.h"
+#include "../../Utilities/CabbageTrace.h"
 
 //==============================================================================
 CsoundPluginProcessor::CsoundPluginProcessor (File selectedCsdFile, const BusesProperties& ioBuses)
@@ -193,13 +196,19 @@ void CsoundPluginProcessor::createCsoundGlobalVars(const ValueTree& cabbageData)
 //==============================================================================
 bool CsoundPluginProcessor::setupAndCompileCsound(File currentCsdFile, File filePath, int sr, bool debugMode)
 {
-    
+    return setupAndCompileCsound(currentCsdFile, {}, filePath, sr, debugMode);
+}
+
+bool CsoundPluginProcessor::setupAndCompileCsound(File currentCsdFile, const String& csdText, File filePath, int sr, bool debugMode)
+{
+    const CabbageTrace::ScopedZone traceZone ("setupAndCompileCsound");
     csdFile = currentCsdFile;
+    expandedCsdText = csdText;
     String csdFileText;
     StringArray csdLines;
 
-    csdLines.addLines(csdFile.loadFileAsString());
-    csdFileText = csdFile.loadFileAsString();
+    csdFileText = csdText.isNotEmpty() ? csdText : csdFile.loadFileAsString();
+    csdLines.addLines(csdFileText);
    
     for (auto line : csdLines)
     {
@@ -270,6 +279,8 @@ bool CsoundPluginProcessor::setupAndCompileCsound(File currentCsdFile, File file
     Logger::writeToLog(String::formatted("Resetting csound ...\ncsound = 0x%p", csound.get()));
 
     //reset Csound in case it is hanging around from a previous run
+    hostAutomation.unbindAllChannels();
+    uiChannels.unbindAllChannels();
     resetCsound();
 	csound = std::make_unique<Csound> ();
     
@@ -391,7 +402,7 @@ bool CsoundPluginProcessor::setupAndCompileCsound(File currentCsdFile, File file
    // csnd::plugin<CabbageFileLoader>((csnd::Csound*)getCsound()->GetCsound(), "cabbageFileLoader", "", "S[]", csnd::thread::i);
 //    csnd::plugin<CabbageFileReader>((csnd::Csound*)getCsound()->GetCsound(), "cabbageOggReader", "aa", "Skii", csnd::thread::ia);
 
-	csound->CreateMessageBuffer(0);
+	csound->SetMessageCallback(messageCallback);
 	csound->SetExternalMidiInOpenCallback(OpenMidiInputDevice);
 	csound->SetExternalMidiReadCallback(ReadMidiData);
 	csound->SetExternalMidiOutOpenCallback(OpenMidiOutputDevice);
@@ -451,10 +462,14 @@ bool CsoundPluginProcessor::setupAndCompileCsound(File currentCsdFile, File file
 	if (requestedKsmpsRate == -1)
 		csoundParams->ksmps_override = 32;
 
+    requestedKsmps = requestedKsmpsRate > 0 ? requestedKsmpsRate : 32;
+
 	csoundParams->sample_rate_override = requestedSampleRate>0 ? requestedSampleRate : sr;
 
+    //zero latency runs Csound on the host's block, so ksmps has to divide it. The csd's own ksmps is the
+    //upper limit, so its k-rate doesn't get any coarser than it asked for
     if(preferredLatency == -1)
-        csoundParams->ksmps_override = 1;
+        csoundParams->ksmps_override = getZeroLatencyKsmps (zeroLatencyBlockGcd.load(), requestedKsmps);
 
 	csound->SetParams(csoundParams.get());
     
@@ -465,7 +480,10 @@ bool CsoundPluginProcessor::setupAndCompileCsound(File currentCsdFile, File file
 //#else
     if (csdFileText.contains("<Csound") || csdFileText.contains("</Csound"))
     {
-        compileCsdFile(csdFile);
+        if (expandedCsdText.isNotEmpty())
+            compileCsdString(expandedCsdText);
+        else
+            compileCsdFile(csdFile);
     }
 
 
@@ -540,6 +558,38 @@ void CsoundPluginProcessor::resetFilebuttons(ValueTree cabbageData)
     }
 }
 
+//==============================================================================
+ThreadPoolJob::JobStatus CsoundPluginProcessor::FileListScan::runJob()
+{
+    int numOfFiles;
+    Array<File> folderFiles;
+    StringArray comboItems;
+    CabbageUtilities::searchDirectoryForFiles (workingDir, fileType, folderFiles, comboItems, numOfFiles);
+
+    const int index = comboItems.indexOf (currentValue);
+    result = folderFiles[index-1].getFileNameWithoutExtension();
+    return jobHasFinished;
+}
+
+void CsoundPluginProcessor::writeNumericChannelDefaults (const Array<NumericChannelDefault>& defaults)
+{
+    //Csound isn't performing yet, so channel memory can be written without its channel lock.
+    //Channels that can't be resolved, such as string channels of the same name, go by name
+    for (const auto& channelDefault : defaults)
+    {
+        if (channelDefault.channel.isEmpty())
+            continue;
+
+        MYFLT* channelPtr = nullptr;
+
+        if (csound->GetChannelPtr (channelPtr, channelDefault.channel.toUTF8().getAddress(),
+                                   CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL) == CSOUND_SUCCESS && channelPtr != nullptr)
+            *channelPtr = channelDefault.value;
+        else
+            csound->SetChannel (channelDefault.channel.toUTF8().getAddress(), channelDefault.value);
+    }
+}
+
 //==============================================================================
 void CsoundPluginProcessor::initAllCsoundChannels (ValueTree cabbageData)
 {
@@ -562,31 +612,48 @@ void CsoundPluginProcessor::initAllCsoundChannels (ValueTree cabbageData)
     }
     
 
+    //read everything this function needs from the widget tree in one pass. Numeric defaults
+    //are collected rather than set one by one, and folder scans are run together below
+    Array<NumericChannelDefault> numericDefaults;
+    Array<std::pair<String, String>> stringDefaults;
+    OwnedArray<FileListScan> fileListScans;
+
     for (int i = 0; i < cabbageData.getNumChildren(); i++)
     {
-        const String typeOfWidget = CabbageWidgetData::getStringProp (cabbageData.getChild (i), CabbageIdentifierIds::type);
-        const String identChannel = CabbageWidgetData::getStringProp (cabbageData.getChild (i), CabbageIdentifierIds::identchannel);
-        
+        const ValueTree widget = cabbageData.getChild (i);
+        const String typeOfWidget = CabbageWidgetData::getStringProp (widget, CabbageIdentifierIds::type);
+
         if(typeOfWidget == CabbageWidgetTypes::form)
         {
-            const int latency = int(CabbageWidgetData::getNumProp (cabbageData.getChild (i), CabbageIdentifierIds::latency));
+            const int latency = int(CabbageWidgetData::getNumProp (widget, CabbageIdentifierIds::latency));
             preferredLatency = latency;
-            //DBG(CabbageWidgetData::getNumProp(cabbageData.getChild(i), CabbageIdentifierIds::width)
-            csound->SetChannel("SCREEN_WIDTH", CabbageWidgetData::getNumProp(cabbageData.getChild(i), CabbageIdentifierIds::width));
-            csound->SetChannel("SCREEN_HEIGHT", CabbageWidgetData::getNumProp(cabbageData.getChild(i), CabbageIdentifierIds::height));
+            hostAutomation.setRampingEnabled (CabbageWidgetData::getNumProp (widget, CabbageIdentifierIds::automationramp) == 1);
+            numericDefaults.add ({ "SCREEN_WIDTH", (MYFLT) CabbageWidgetData::getNumProp (widget, CabbageIdentifierIds::width) });
+            numericDefaults.add ({ "SCREEN_HEIGHT", (MYFLT) CabbageWidgetData::getNumProp (widget, CabbageIdentifierIds::height) });
+        }
+
+        if (typeOfWidget == CabbageWidgetTypes::eventsequencer)
+        {
+            //sequencers live here rather than in the editor so they keep playing when it's closed
+            const int sequencerIndex = createMatrixEventSequencer (int (CabbageWidgetData::getNumProp (widget, CabbageIdentifierIds::matrixrows)),
+                                                                   int (CabbageWidgetData::getNumProp (widget, CabbageIdentifierIds::matrixcols)),
+                                                                   CabbageWidgetData::getStringProp (widget, CabbageIdentifierIds::channel));
+            setMatrixEventSequencerClock (sequencerIndex, int (CabbageWidgetData::getNumProp (widget, CabbageIdentifierIds::stepsperbeat)),
+                                          CabbageWidgetData::getStringProp (widget, CabbageIdentifierIds::orientation) == "vertical");
         }
 
-        if (CabbageWidgetData::getStringProp (cabbageData.getChild (i), CabbageIdentifierIds::channeltype) == "string")
+        if (CabbageWidgetData::getStringProp (widget, CabbageIdentifierIds::channeltype) == "string")
         {
+            const String channel = CabbageWidgetData::getStringProp (widget, CabbageIdentifierIds::channel);
+
             if (typeOfWidget == CabbageWidgetTypes::filebutton)
             {
-                const String mode = CabbageWidgetData::getStringProp (cabbageData.getChild (i), CabbageIdentifierIds::mode);
+                const String mode = CabbageWidgetData::getStringProp (widget, CabbageIdentifierIds::mode);
                 if( mode == "file" || mode == "save" || mode == "directory")
                 {
                     //if a SR change is made on startup, the channel will already have been set when Csound is recompiled, hence no 
                     //trigger updates will take place with changed2 or cabbageGetValue opcodes. Commenting this out for now to resolve this.. 
-                    csound->SetStringChannel (CabbageWidgetData::getStringProp (cabbageData.getChild (i), CabbageIdentifierIds::channel).getCharPointer(),
-                                          CabbageWidgetData::getStringProp (cabbageData.getChild (i), CabbageIdentifierIds::file).toUTF8().getAddress());
+                    stringDefaults.add ({ channel, CabbageWidgetData::getStringProp (widget, CabbageIdentifierIds::file) });
                 }
             }
 
@@ -594,57 +661,35 @@ void CsoundPluginProcessor::initAllCsoundChannels (ValueTree cabbageData)
             {
                 if (typeOfWidget == CabbageWidgetTypes::combobox || typeOfWidget == CabbageWidgetTypes::listbox)
                 {
-                    const String fileType = CabbageWidgetData::getStringProp(cabbageData.getChild(i), CabbageIdentifierIds::filetype);
+                    const String fileType = CabbageWidgetData::getStringProp (widget, CabbageIdentifierIds::filetype);
                     
                     //if we are dealing with a combobox that reads files from a directory, we need to load them before the GUI opens...
-                    if (!CabbageWidgetData::getStringProp(cabbageData.getChild(i), CabbageIdentifierIds::filetype).contains("preset")
-                        && !CabbageWidgetData::getStringProp(cabbageData.getChild(i), CabbageIdentifierIds::filetype).contains("*.snaps")
-                        && !CabbageWidgetData::getStringProp(cabbageData.getChild(i), CabbageIdentifierIds::filetype).contains(".snaps")
-                        && !CabbageWidgetData::getStringProp(cabbageData.getChild(i), CabbageIdentifierIds::filetype).contains("snaps"))
+                    if (! fileType.contains ("preset") && ! fileType.contains ("snaps"))
                     {
-                        const String relativeDir = CabbageWidgetData::getStringProp(cabbageData.getChild(i), CabbageIdentifierIds::currentdir);
+                        const String relativeDir = CabbageWidgetData::getStringProp (widget, CabbageIdentifierIds::currentdir);
                         const String workingDir = csdFilePath.getChildFile(relativeDir).getFullPathName();
 
                         if(relativeDir.isNotEmpty() && workingDir.isNotEmpty())
                         {
-                            int numOfFiles;
-                            Array<File> folderFiles;
-                            StringArray comboItems;
-                            CabbageUtilities::searchDirectoryForFiles(workingDir, fileType, folderFiles, comboItems, numOfFiles);
-                            const String currentValue = CabbageWidgetData::getStringProp(cabbageData.getChild(i), CabbageIdentifierIds::value);
-
-                            const int index = comboItems.indexOf(currentValue);
-                            const String test = folderFiles[index].getFullPathName();
-                            const String channel = CabbageWidgetData::getStringProp(cabbageData.getChild(i), CabbageIdentifierIds::channel);
-                            csound->SetStringChannel(CabbageWidgetData::getStringProp(cabbageData.getChild(i), CabbageIdentifierIds::channel).getCharPointer(),
-                                folderFiles[index-1].getFileNameWithoutExtension().toUTF8().getAddress());
+                            fileListScans.add (new FileListScan (channel, workingDir, fileType,
+                                                                 CabbageWidgetData::getStringProp (widget, CabbageIdentifierIds::value)));
                         }
                         else
                         {
-                            String currentValue = CabbageWidgetData::getStringProp(cabbageData.getChild(i), CabbageIdentifierIds::value);
-                            var items = CabbageWidgetData::getProperty(cabbageData.getChild(i), CabbageIdentifierIds::text);
-                            //DBG(items.size());
-                            const int index = items.indexOf(currentValue);
+                            var items = CabbageWidgetData::getProperty (widget, CabbageIdentifierIds::text);
+                            const int index = items.indexOf (CabbageWidgetData::getStringProp (widget, CabbageIdentifierIds::value));
                             if(index == -1 && items.isArray())
-                            {
-                                currentValue = items[0].toString();
-                            
-                                const String channel = CabbageWidgetData::getStringProp(cabbageData.getChild(i), CabbageIdentifierIds::channel);
-                            
-                                csound->SetStringChannel(CabbageWidgetData::getStringProp(cabbageData.getChild(i), CabbageIdentifierIds::channel).getCharPointer(), currentValue.toUTF8().getAddress());
-                            }
+                                stringDefaults.add ({ channel, items[0].toString() });
                         }
                         
                     }
                     else{
-                        csound->SetStringChannel(CabbageWidgetData::getStringProp(cabbageData.getChild(i), CabbageIdentifierIds::channel).getCharPointer(),
-                                                 CabbageWidgetData::getProperty(cabbageData.getChild(i), CabbageIdentifierIds::value).toString().toUTF8().getAddress());
+                        stringDefaults.add ({ channel, CabbageWidgetData::getProperty (widget, CabbageIdentifierIds::value).toString() });
                     }
                 }
                 else if (typeOfWidget == CabbageWidgetTypes::texteditor)
                 {
-                    csound->SetStringChannel(CabbageWidgetData::getStringProp(cabbageData.getChild(i), CabbageIdentifierIds::channel).getCharPointer(),
-                                             CabbageWidgetData::getStringProp(cabbageData.getChild(i), CabbageIdentifierIds::text).toUTF8().getAddress());
+                    stringDefaults.add ({ channel, CabbageWidgetData::getStringProp (widget, CabbageIdentifierIds::text) });
                 }
             }
 
@@ -652,37 +697,31 @@ void CsoundPluginProcessor::initAllCsoundChannels (ValueTree cabbageData)
         }
         else
         {
-            if (CabbageWidgetData::getStringProp (cabbageData.getChild (i), CabbageIdentifierIds::type) == CabbageWidgetTypes::xypad)
+            if (typeOfWidget == CabbageWidgetTypes::xypad)
             {
-                csound->SetChannel (CabbageWidgetData::getStringProp (cabbageData.getChild (i), CabbageIdentifierIds::xchannel).getCharPointer(),
-                                    CabbageWidgetData::getNumProp (cabbageData.getChild (i), CabbageIdentifierIds::valuex));
-                csound->SetChannel (CabbageWidgetData::getStringProp (cabbageData.getChild (i), CabbageIdentifierIds::ychannel).getCharPointer(),
-                                    CabbageWidgetData::getNumProp (cabbageData.getChild (i), CabbageIdentifierIds::valuey));
+                numericDefaults.add ({ CabbageWidgetData::getStringProp (widget, CabbageIdentifierIds::xchannel),
+                                       (MYFLT) CabbageWidgetData::getNumProp (widget, CabbageIdentifierIds::valuex) });
+                numericDefaults.add ({ CabbageWidgetData::getStringProp (widget, CabbageIdentifierIds::ychannel),
+                                       (MYFLT) CabbageWidgetData::getNumProp (widget, CabbageIdentifierIds::valuey) });
             }
-            else if (CabbageWidgetData::getStringProp (cabbageData.getChild (i), CabbageIdentifierIds::type) == CabbageWidgetTypes::hrange
-                     ||CabbageWidgetData::getStringProp (cabbageData.getChild (i), CabbageIdentifierIds::type) == CabbageWidgetTypes::vrange)
+            else if (typeOfWidget == CabbageWidgetTypes::hrange || typeOfWidget == CabbageWidgetTypes::vrange)
             {
-                var channels = CabbageWidgetData::getProperty(cabbageData.getChild(i), CabbageIdentifierIds::channel);
+                var channels = CabbageWidgetData::getProperty (widget, CabbageIdentifierIds::channel);
                 if(channels.size()==2)
                 {
-                    const var minValue = CabbageWidgetData::getProperty (cabbageData.getChild (i), CabbageIdentifierIds::minvalue);
-                    csound->SetChannel (channels[0].toString().getCharPointer(), float (minValue));
-
-                    const var maxValue = CabbageWidgetData::getProperty (cabbageData.getChild (i), CabbageIdentifierIds::maxvalue);
-                    csound->SetChannel (channels[1].toString().getCharPointer(), float (maxValue));
+                    numericDefaults.add ({ channels[0].toString(), (MYFLT) float (CabbageWidgetData::getProperty (widget, CabbageIdentifierIds::minvalue)) });
+                    numericDefaults.add ({ channels[1].toString(), (MYFLT) float (CabbageWidgetData::getProperty (widget, CabbageIdentifierIds::maxvalue)) });
                 }
 
             }
-            else if (CabbageWidgetData::getStringProp (cabbageData.getChild (i), CabbageIdentifierIds::type) == CabbageWidgetTypes::cvoutput
-                     ||CabbageWidgetData::getStringProp (cabbageData.getChild (i), CabbageIdentifierIds::type) == CabbageWidgetTypes::cvinput)
+            else if (typeOfWidget == CabbageWidgetTypes::cvoutput || typeOfWidget == CabbageWidgetTypes::cvinput)
             {
                 //don't set up any channels for these widgets, even though they use the channel() identifier..
             }
             else
             {
-                const float value = CabbageWidgetData::getProperty (cabbageData.getChild (i), CabbageIdentifierIds::value);
-                const String channel = CabbageWidgetData::getStringProp (cabbageData.getChild (i), CabbageIdentifierIds::channel);
-                csound->SetChannel (channel.getCharPointer(), value);
+                const float value = CabbageWidgetData::getProperty (widget, CabbageIdentifierIds::value);
+                numericDefaults.add ({ CabbageWidgetData::getStringProp (widget, CabbageIdentifierIds::channel), (MYFLT) value });
                 
                 if(firstInit)
                 {
@@ -699,6 +738,35 @@ void CsoundPluginProcessor::initAllCsoundChannels (ValueTree cabbageData)
 
     }
 
+    //sample folders are scanned side by side, and the channels are written while they run
+    std::unique_ptr<ThreadPool> scanPool;
+
+    if (fileListScans.size() > 1)
+    {
+        scanPool = std::make_unique<ThreadPool> (jmin (fileListScans.size(), jmax (1, SystemStats::getNumCpus() - 1)));
+
+        for (auto* scan : fileListScans)
+            scanPool->addJob (scan, false);
+    }
+
+    writeNumericChannelDefaults (numericDefaults);
+
+    for (const auto& stringDefault : stringDefaults)
+        csound->SetStringChannel (stringDefault.first.toUTF8().getAddress(), stringDefault.second.toUTF8().getAddress());
+
+    //everything is joined here, well before the first processBlock
+    for (auto* scan : fileListScans)
+    {
+        if (scanPool != nullptr)
+            scanPool->waitForJobToFinish (scan, -1);
+        else
+            scan->runJob();
+
+        csound->SetStringChannel (scan->channel.toUTF8().getAddress(), scan->result.toUTF8().getAddress());
+    }
+
+    scanPool.reset();
+
    createCsoundGlobalVars(cabbageData);
     
     
@@ -828,6 +896,10 @@ void CsoundPluginProcessor::initAllCsoundChannels (ValueTree cabbageData)
     csound->SetChannel ("MOUSE_DOWN_LEFT", 0.0);
     csound->SetChannel ("MOUSE_DOWN_RIGHT", 0.0);
     csound->SetChannel ("MOUSE_DOWN_MIDDLE", 0.0);
+
+    //host parameters write straight into channel memory, which is new after each compile
+    hostAutomation.bindAllChannels (*csound);
+    uiChannels.bindAllChannels (*csound);
     
     Logger::writeToLog("initAllCsoundChannels (ValueTree cabbageData) - done");
     firstInit = false;
@@ -876,38 +948,174 @@ void CsoundPluginProcessor::addMacros (String& csdText)
 }
 
 //==============================================================================
-void CsoundPluginProcessor::createMatrixEventSequencer(int rows, int cols, String channel)
+int CsoundPluginProcessor::addHostAutomationChannel(const String& channel, bool canRamp, float smoothingTimeMs)
 {
-    auto* matrix = new MatrixEventSequencer(channel);
+    const int index = hostAutomation.addChannel (channel, canRamp, smoothingTimeMs);
 
-    for (int i = 0 ; i < cols ; i++)
-    {
-        matrix->events.add (new StringArray());
+    if (csound != nullptr && csdCompiledWithoutError())
+        hostAutomation.bindChannel (index, *csound);
 
-        for ( int y = 0 ; y < rows ; y++)
-        {
-            matrix->events[i]->add(" ");
-        }
+    return index;
+}
+
+int CsoundPluginProcessor::getUiChannelHandle(const String& channel)
+{
+    return uiChannels.getHandle (channel, csdCompiledWithoutError() ? csound.get() : nullptr);
+}
+
+void CsoundPluginProcessor::setUiChannelValue(int channelHandle, float value)
+{
+    if (uiChannels.setValue (channelHandle, value))
+        return;
+
+    //the mailbox is full, so this channel is set by name straight away
+    const String channel = uiChannels.getChannelName (channelHandle);
+
+    if (channel.isNotEmpty() && csound != nullptr && csdCompiledWithoutError())
+        csound->SetChannel (channel.toUTF8(), value);
+}
+
+int CsoundPluginProcessor::createMatrixEventSequencer(int rows, int cols, const String& channel)
+{
+    const ScopedLock sl (matrixEventSequencerLock);
+
+    //sequencers are recreated each time the editor opens, so reuse existing ones
+    if (matrixEventSequencerIndices.contains (channel))
+    {
+        const int index = matrixEventSequencerIndices[channel];
+        matrixEventSequencers[index]->resize (rows, cols);
+        return index;
     }
 
-    matrixEventSequencers.add(matrix);
+    matrixEventSequencers.add (new MatrixEventSequencer (channel, rows, cols));
+    matrixEventSequencerIndices.set (channel, matrixEventSequencers.size() - 1);
 	numMatrixEventSequencers = matrixEventSequencers.size();
+    return numMatrixEventSequencers - 1;
+}
 
+int CsoundPluginProcessor::getMatrixEventSequencerIndex(const String& channel) const
+{
+    const ScopedLock sl (matrixEventSequencerLock);
+    return matrixEventSequencerIndices.contains (channel) ? matrixEventSequencerIndices[channel] : -1;
+}
+
+void CsoundPluginProcessor::setMatrixEventSequencerCellData(int sequencerIndex, int col, int row, const String& data)
+{
+    const ScopedLock sl (matrixEventSequencerLock);
 
+    if (auto* sequencer = matrixEventSequencers[sequencerIndex])
+        sequencer->setEvent (col, row, MatrixEventSequencer::parseEvent (data));
 }
 
-void CsoundPluginProcessor::setMatrixEventSequencerCellData(int col, int row, const String& channel, String data)
+void CsoundPluginProcessor::setMatrixEventSequencerClock(int sequencerIndex, int stepsPerBeat, bool stepsRunVertically)
 {
-	if (numMatrixEventSequencers > 0)
-	{
-		for (auto matrixEventSequencer : matrixEventSequencers)
-		{
-			if (matrixEventSequencer->channel == channel)
-			{
-				matrixEventSequencer->setEventString(col, row, data);
-			}
-		}
-	}
+    const ScopedLock sl (matrixEventSequencerLock);
+
+    if (auto* sequencer = matrixEventSequencers[sequencerIndex])
+    {
+        sequencer->stepsRunVertically = stepsRunVertically;
+        sequencer->positionChannel = nullptr;
+
+        //the current step is written straight into the widget's channel so the editor can follow it
+        if (csound != nullptr && stepsPerBeat > 0)
+            csound->GetChannelPtr (sequencer->positionChannel, sequencer->channel.toUTF8().getAddress(),
+                                   CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL | CSOUND_OUTPUT_CHANNEL);
+
+        sequencer->stepsPerBeat = jmax (0, stepsPerBeat);
+    }
+}
+
+CsoundPluginProcessor::MatrixEventSequencer::Event CsoundPluginProcessor::MatrixEventSequencer::parseEvent (const String& data)
+{
+    Event event;
+    StringArray tokens;
+    tokens.addTokens (data.trim(), " \t", "\"");
+    tokens.removeEmptyStrings();
+
+    if (tokens.isEmpty())
+        return event;
+
+    //statement type can either be on its own or attached to p1, i.e, "i 1" or "i1"
+    char opcode = 'i';
+
+    if (CharacterFunctions::isLetter (tokens[0][0]))
+    {
+        opcode = (char) tokens[0][0];
+
+        //other statements, such as e, a or q, change the whole performance and
+        //would be sent from the audio thread on every step
+        if (opcode != 'i' && opcode != 'f')
+            return {};
+
+        tokens.set (0, tokens[0].substring (1));
+        tokens.removeEmptyStrings();
+    }
+
+    for (const auto& token : tokens)
+    {
+        if (event.numPFields == maxPFields || ! token.containsOnly ("0123456789.-+eE"))
+            return {};
+
+        event.pFields[event.numPFields++] = (MYFLT) token.getDoubleValue();
+    }
+
+    event.opcode = opcode;
+    return event;
+}
+
+void CsoundPluginProcessor::triggerMatrixEventSequencers (int blockSamplePosition, int numSamples)
+{
+    const ScopedTryLock sl (matrixEventSequencerLock);
+
+    if (! sl.isLocked())
+    {
+        processorStats.addLockMiss();
+        return;
+    }
+
+    if (! sequencerPlayHeadInfo.isPlaying || sequencerPlayHeadInfo.bpm <= 0)
+        return;
+
+    const double sr = getSampleRate();
+    const double beatsPerSample = sequencerPlayHeadInfo.bpm / (60.0 * sr);
+    const double startPpq = sequencerPlayHeadInfo.ppqPosition + blockSamplePosition * beatsPerSample;
+    const double endPpq = startPpq + numSamples * beatsPerSample;
+
+    for (auto* sequencer : matrixEventSequencers)
+    {
+        const int numSteps = sequencer->getNumSteps();
+
+        if (sequencer->stepsPerBeat <= 0 || numSteps <= 0)
+            continue;
+
+        //fire every step boundary that falls within this k-period
+        for (auto step = (int64) std::ceil (startPpq * sequencer->stepsPerBeat); ; ++step)
+        {
+            const double stepPpq = double (step) / sequencer->stepsPerBeat;
+
+            if (stepPpq >= endPpq)
+                break;
+
+            const int stepIndex = int (step % numSteps);
+            const MYFLT offset = MYFLT ((stepPpq - startPpq) / beatsPerSample / sr);
+
+            for (int track = 0; track < sequencer->getNumTracks(); track++)
+            {
+                auto event = sequencer->stepsRunVertically ? sequencer->getEvent (track, stepIndex)
+                                                           : sequencer->getEvent (stepIndex, track);
+                if (event.opcode == 0)
+                    continue;
+
+                if (event.numPFields > 1)
+                    event.pFields[1] += offset;
+
+                csound->ScoreEvent (event.opcode, event.pFields, event.numPFields);
+            }
+
+            if (sequencer->positionChannel != nullptr)
+                *sequencer->positionChannel = stepIndex;
+        }
+    }
 }
 
 //==============================================================================
@@ -969,20 +1177,11 @@ String CsoundPluginProcessor::getCsoundOutput()
 {
     if (csound!=nullptr)
     {
-        const int messageCnt = csound->GetMessageCnt();
-        csoundOutput = "";
+        csoundOutput = messageLog.drain();
 
-        if (messageCnt == 0)
+        if (csoundOutput.isEmpty())
             return csoundOutput;
 
-        while (csound->GetMessageCnt() > 0)
-        {
-            String message = CharPointer_UTF8(csound->GetFirstMessage());
-            if(!message.contains("midi channel") && !message.contains("is muted") && !message.contains("Score finished in csoundPerformKsmps()"))
-                csoundOutput += message;
-            csound->PopFirstMessage();
-        }
-
         Logger::writeToLog (csoundOutput);
 
         if (disableLogging)
@@ -994,6 +1193,12 @@ String CsoundPluginProcessor::getCsoundOutput()
     return String();
 }
 
+void CsoundPluginProcessor::messageCallback (CSOUND* csound, int attr, const char* format, va_list args)
+{
+    if (auto* ud = static_cast<CsoundPluginProcessor*> (csoundGetHostData (csound)))
+        ud->messageLog.push (attr, format, args);
+}
+
 //==============================================================================
 const String CsoundPluginProcessor::getName() const
 {
@@ -1057,6 +1262,8 @@ void CsoundPluginProcessor::prepareToPlay (double sampleRate, int samplesPerBloc
 {
     if(getCsound()!= nullptr)
         csound->SetChannel("HOST_BUFFER_SIZE", samplesPerBlock);
+
+    midiOutputBuffer.ensureSize ((size_t) midiOutputQueue.getMaxBufferSize());
 #if Cabbage_IDE_Build == 0
     PluginHostType pluginType;
     
@@ -1083,7 +1290,15 @@ void CsoundPluginProcessor::prepareToPlay (double sampleRate, int samplesPerBloc
     CabbageUtilities::debug("CsoundPluginProcessor::prepareToPlay - Requested output channels:", numCsoundOutputChannels);
 
     CabbageUtilities::debug("CsoundPluginProcessor::prepareToPlay - Sampling rate:", samplingRate);
-    if((samplingRate != sampleRate)
+    //the block sizes seen so far still count when the host prepares again at the same size
+    if (samplesPerBlock != hostBlockSize)
+        zeroLatencyBlockGcd = samplesPerBlock;
+
+    hostBlockSize = samplesPerBlock;
+    const bool zeroLatencyKsmpsChanged = preferredLatency == -1 && csdCompiledWithoutError()
+                                         && getZeroLatencyKsmps (zeroLatencyBlockGcd.load(), requestedKsmps) != csdKsmps;
+
+    if((samplingRate != sampleRate) || zeroLatencyKsmpsChanged
 #if ! JucePlugin_IsSynth && ! JucePlugin_IsSynth
        || numCsoundInputChannels != inputs
 #endif
@@ -1093,7 +1308,7 @@ void CsoundPluginProcessor::prepareToPlay (double sampleRate, int samplesPerBloc
         samplingRate = (double)sampleRate;
         //the problem here is channels have already been instantiated, so no change triggers will take place..
         CabbageUtilities::debug("CsoundPluginProcessor::prepareToPlay - calling setupAndCompileCsound()");
-        setupAndCompileCsound(csdFile, csdFilePath, samplingRate);
+        setupAndCompileCsound(csdFile, expandedCsdText, csdFilePath, samplingRate);
     }
 
     if (preferredLatency == -1)
@@ -1110,6 +1325,28 @@ void CsoundPluginProcessor::releaseResources()
 
 void CsoundPluginProcessor::handleAsyncUpdate()
 {
+    const CabbageTrace::ScopedZone traceZone ("handleAsyncUpdate");
+    const int64 pollStart = Time::getHighResolutionTicks();
+
+    //a k-cycle can't be split across blocks without adding latency, so once the host sends a block ksmps
+    //doesn't divide, recompile with the largest ksmps that divides every block seen so far
+    if (zeroLatencyRecompilePending.exchange (false) && preferredLatency == -1)
+    {
+        const int newKsmps = getZeroLatencyKsmps (zeroLatencyBlockGcd.load(), requestedKsmps);
+
+        if (newKsmps != csdKsmps)
+        {
+            Logger::writeToLog ("Zero latency: the host sent a block that ksmps " + String (csdKsmps) + " doesn't divide, recompiling "
+                                + csdFile.getFileName() + " with ksmps " + String (newKsmps)
+                                + (zeroLatencyRecompileWhilePlaying.load() ? ". The transport was running, so any notes playing have stopped." : "."));
+
+            const bool wasSuspended = isSuspended();
+            suspendProcessing (true);
+            setupAndCompileCsound (csdFile, expandedCsdText, csdFilePath, samplingRate);
+            suspendProcessing (wasSuspended);
+        }
+    }
+
     if(polling == 1)
     {
         getChannelDataFromCsound();
@@ -1124,7 +1361,46 @@ void CsoundPluginProcessor::handleAsyncUpdate()
         sendChannelDataToCsound();
         getIdentifierDataFromCsound();
     }
-    
+
+    processorStats.addGuiPoll (pollStart);
+    sendStatsToCsound();
+}
+
+void CsoundPluginProcessor::sendStatsToCsound()
+{
+    if (! csdCompiledWithoutError())
+        return;
+
+    if (! statsChannelsResolved)
+    {
+        const String channels[numStatsChannels] = { CabbageIdentifierIds::cabbagecpuload, CabbageIdentifierIds::cabbageblocktime,
+                                                    CabbageIdentifierIds::cabbageblocktimep99, CabbageIdentifierIds::cabbagekcycletime,
+                                                    CabbageIdentifierIds::cabbagemidievents, CabbageIdentifierIds::cabbagexruns,
+                                                    CabbageIdentifierIds::cabbagelockmisses };
+
+        for (int i = 0; i < numStatsChannels; ++i)
+            statsChannelHandles[i] = getUiChannelHandle (channels[i]);
+
+        statsChannelsResolved = true;
+    }
+
+    const auto stats = processorStats.getSnapshot();
+    const auto window = stats - lastSentStats;
+
+    //nothing was processed since last time, so the channels keep their values
+    if (window.blockTime.numValues == 0)
+        return;
+
+    lastSentStats = stats;
+
+    //times are in milliseconds, xruns and lock misses are totals since the instance was created
+    const float values[numStatsChannels] = { window.getLoad(), (float) (window.blockTime.getMean() / 1000.0),
+                                             (float) (window.blockTime.getPercentile (0.99) / 1000.0), (float) (window.kCycleTime.getMean() / 1000.0),
+                                             (float) window.midiEventsPerBlock.getMean(), (float) stats.numXruns,
+                                             (float) stats.numLockMisses };
+
+    for (int i = 0; i < numStatsChannels; ++i)
+        setUiChannelValue (statsChannelHandles[i], values[i]);
 }
 
 void CsoundPluginProcessor::sendHostDataToCsound()
@@ -1158,7 +1434,9 @@ void CsoundPluginProcessor::performCsoundKsmps()
     if(csound == nullptr)
         return;
     
+    const int64 kCycleStart = Time::getHighResolutionTicks();
     result = csound->PerformKsmps();
+    processorStats.addKCycle (kCycleStart);
 
     if (result == 0)
     {
@@ -1199,10 +1477,6 @@ void CsoundPluginProcessor::processIOBuffers(int bufferType, Type* buffer, int s
        // DBG("Input/Output Buffer Pos: +" + String(csndPosition));
         MYFLT sample = buffer[samplePosition] * cs_scale;
         CSspin[csndPosition] = sample;
-        
-        //if we want 0 latency, we have to fill Csound spin buffer before we call performKsmps()
-        if (preferredLatency == -1)
-            performCsoundKsmps();
         buffer[samplePosition] = (CSspout[csndPosition] / cs_scale);
 	}
 	else if (bufferType == BufferType::output)
@@ -1224,7 +1498,9 @@ void CsoundPluginProcessor::processIOBuffers(int bufferType, Type* buffer, int s
 
 void CsoundPluginProcessor::processBlock(AudioBuffer< float >& buffer, MidiBuffer& midiMessages)
 {
+    const CabbageTrace::ScopedZone traceZone ("processBlock");
     processBlockListener.updateBlockTime();
+    const CabbageProcessorStats::ScopedBlock blockStats (processorStats, buffer.getNumSamples(), midiMessages.getNumEvents(), getSampleRate());
     canUpdate.store(false);
 	processSamples(buffer, midiMessages);
     canUpdate.store(true);
@@ -1232,16 +1508,63 @@ void CsoundPluginProcessor::processBlock(AudioBuffer< float >& buffer, MidiBuffe
 
 void CsoundPluginProcessor::processBlock(AudioBuffer< double >& buffer, MidiBuffer& midiMessages)
 {
+    const CabbageTrace::ScopedZone traceZone ("processBlock");
     processBlockListener.updateBlockTime();
+    const CabbageProcessorStats::ScopedBlock blockStats (processorStats, buffer.getNumSamples(), midiMessages.getNumEvents(), getSampleRate());
     canUpdate.store(false);
 	processSamples(buffer, midiMessages);
     canUpdate.store(true);
 }
 
+template< typename Type >
+void CsoundPluginProcessor::writeKCycleInput(AudioBuffer< Type >& buffer, MidiBuffer& midiMessages, int startSample, int numSamplesInBlock, int inputChannelCount)
+{
+    //a k-cycle that runs past the end of the block is run early. The rest of its output plays at the
+    //start of the next block, and the input that arrives with those samples is dropped. This only
+    //happens until the recompile with a smaller ksmps that processSamples asks for
+    if (isLMMS == false)
+    {
+        for (const auto metadata : midiMessages)
+            if (metadata.samplePosition >= startSample && metadata.samplePosition < startSample + numSamplesInBlock)
+                midiBuffer.addEvent (metadata.getMessage(), metadata.samplePosition);
+    }
+
+#if !JucePlugin_IsSynth
+    const int numInputBuses = getBusCount(true);
+    int channelOffset = 0;
+
+    for (int busIndex = 0; busIndex < numInputBuses; busIndex++)
+    {
+        auto inputBus = getBusBuffer(buffer, true, busIndex);
+        Type** inputBuffer = inputBus.getArrayOfWritePointers();
+
+        for (int channel = 0; channel < inputBus.getNumChannels(); channel++, channelOffset++)
+            for (int sample = 0; sample < csdKsmps; sample++)
+                processIOBuffers(BufferType::input, sample < numSamplesInBlock ? inputBuffer[channel] : nullptr,
+                                 startSample + sample, sample * inputChannelCount + channelOffset);
+    }
+#else
+    ignoreUnused (buffer, inputChannelCount);
+#endif
+}
+
+int CsoundPluginProcessor::getZeroLatencyKsmps (int blockSize, int ksmpsLimit)
+{
+    if (blockSize <= 0)
+        return jmax (1, ksmpsLimit);
+
+    for (int ksmps = jmin (blockSize, ksmpsLimit); ksmps > 1; --ksmps)
+        if (blockSize % ksmps == 0)
+            return ksmps;
+
+    return 1;
+}
+
 template< typename Type >
 void CsoundPluginProcessor::processSamples(AudioBuffer< Type >& buffer, MidiBuffer& midiMessages)
 {
 	ScopedNoDenormals noDenormals;
+    const CabbageRealtimeAudit::ScopedAudioCallback realtimeAudit;
     auto mainOutput = getBusBuffer(buffer, false, 0);
 #if !JucePlugin_IsSynth
     auto mainInput = getBusBuffer(buffer, true, 0);
@@ -1286,17 +1609,47 @@ void CsoundPluginProcessor::processSamples(AudioBuffer< Type >& buffer, MidiBuff
 			buffer.clear(channelsToClear, 0, buffer.getNumSamples());
 		}
 
+        if (numMatrixEventSequencers > 0 && getPlayHead() != nullptr)
+            getPlayHead()->getCurrentPosition (sequencerPlayHeadInfo);
+
+        if (preferredLatency == -1 && numSamples % jmax (1, csdKsmps) != 0)
+        {
+            zeroLatencyBlockGcd = std::gcd (zeroLatencyBlockGcd.load(), numSamples);
+
+            if (! zeroLatencyRecompilePending.exchange (true))
+            {
+                AudioPlayHead::CurrentPositionInfo position;
+                zeroLatencyRecompileWhilePlaying = getPlayHead() != nullptr && getPlayHead()->getCurrentPosition (position) && position.isPlaying;
+                triggerAsyncUpdate();
+            }
+        }
+
+        //parameter ramps span the k-cycles of this block
+        const int automationRampCycles = jmax (1, numSamples / jmax (1, csdKsmps));
+        const double kCycleSeconds = getSampleRate() > 0 ? csdKsmps / getSampleRate() : 0;
+
 		for (int i = 0; i < numSamples; i++, ++csndIndex)
 		{
 			if (csndIndex >= csdKsmps)
 			{
-                //don't call performKsmps here if we want 0 latency
-                if(preferredLatency != -1)
-				    performCsoundKsmps();
+                if (numMatrixEventSequencers > 0)
+                    triggerMatrixEventSequencers (i, csdKsmps);
+
+                advanceAutomation (kCycleSeconds);
+                hostAutomation.writeToCsound (automationRampCycles);
+                uiChannels.writeToCsound();
+
+                //with zero latency, the k-cycle's input goes in before it runs and its output is used straight away
+                if (preferredLatency == -1)
+                    writeKCycleInput (buffer, midiMessages, i, jmin (csdKsmps, numSamples - i), inputChannelCount);
+
+                //any MIDI Csound sends out during this k-cycle starts here in the block
+                kCycleSampleOffset = i;
+				performCsoundKsmps();
 				csndIndex = 0;
 			}
             
-            if (isLMMS == false)
+            if (isLMMS == false && preferredLatency != -1)
             {
                 while (iter.getNextEvent(message, samplePos))
                 {
@@ -1312,7 +1665,7 @@ void CsoundPluginProcessor::processSamples(AudioBuffer< Type >& buffer, MidiBuff
             
 	
 #if !JucePlugin_IsSynth
-            const int numInputBuses = getBusCount(true);
+            const int numInputBuses = preferredLatency != -1 ? getBusCount(true) : 0;
             pos = csndIndex * inputChannelCount;
             
             for (int busIndex = 0; busIndex < numInputBuses; busIndex++)
@@ -1365,16 +1718,14 @@ void CsoundPluginProcessor::processSamples(AudioBuffer< Type >& buffer, MidiBuff
     {
          activeWriter.load()->write (writerBuffer.getArrayOfWritePointers(), writerBuffer.getNumSamples());
     }
-#if JucePlugin_ProducesMidiOutput
-
-	if (!midiOutputBuffer.isEmpty())
-	{
-		midiMessages.clear();
-		midiMessages.swapWith(midiOutputBuffer);
-	}
-	else
-		midiMessages.clear();
+    //k-cycles run outside processSamples, such as the one after a compile, send their MIDI at the start of the next block
+    kCycleSampleOffset = 0;
 
+#if JucePlugin_ProducesMidiOutput
+    //the buffers swap storage each block, and both keep their size, so once they are big enough nothing is allocated
+	midiOutputBuffer.clear();
+	midiOutputQueue.popInto (midiOutputBuffer, numSamples);
+	midiMessages.swapWith(midiOutputBuffer);
 #endif
 }
 
@@ -1544,8 +1895,9 @@ int CsoundPluginProcessor::WriteMidiData (CSOUND* /*csound*/, void* _userData,
         return 0;
     }
 
-    MidiMessage message (mbuf, nbytes, 0);
-    userData->midiOutputBuffer.addEvent (message, 0);
+    if (! userData->midiOutputQueue.push (mbuf, nbytes, userData->kCycleSampleOffset))
+        return 0;
+
     return nbytes;
 }
 
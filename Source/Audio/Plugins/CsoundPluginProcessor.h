@@ -34,6 +34,11 @@
 //#include "../../Opcodes/CabbageFileReaderOpcodes.h"
 #include "../../Utilities/CabbageUtilities.h"
 #include "CabbageCsoundBreakpointData.h"
+#include "CabbageCsoundMessageLog.h"
+#include "CabbageHostAutomation.h"
+#include "CabbageChannelMailbox.h"
+#include "CabbageMidiOutputQueue.h"
+#include "CabbageProcessorStats.h"
 #if CabbagePro
 #include "../../Utilities/encrypt.h"
 #endif
@@ -78,8 +83,10 @@ public:
 	bool matchingNumberOfIOChannels = true;
 	void resetCsound();
 	//==============================================================================
-	//pass the path to the temp file, along with the path to the original csd file so we can set correct working dir
+	//pass the csd file, along with the path to its parent directory so we can set correct working dir
 	bool setupAndCompileCsound(File csdFile, File filePath, int sr = 44100, bool debugMode = false);
+	//as above, but compiles csdText, the csd with its imported files already added, instead of the file on disk
+	bool setupAndCompileCsound(File csdFile, const String& csdText, File filePath, int sr = 44100, bool debugMode = false);
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
 
@@ -163,6 +170,11 @@ public:
 
 	template< typename Type >
     void processIOBuffers(int bufferType, Type* buffer, int samplePos, int csdPos);
+    //zero latency mode, fills Csound's input and MIDI for the k-cycle starting at startSample
+    template< typename Type >
+    void writeKCycleInput(AudioBuffer< Type >& buffer, MidiBuffer& midiMessages, int startSample, int numSamplesInBlock, int inputChannelCount);
+    //the largest ksmps that divides blockSize without going over ksmpsLimit
+    static int getZeroLatencyKsmps(int blockSize, int ksmpsLimit);
 
     int numSideChainChannels = 0;
     //==============================================================================
@@ -206,6 +218,7 @@ public:
 
     //logger
     void createFileLogger (File csdFile);
+    static void messageCallback (CSOUND* csound, int attr, const char* format, va_list args);
 
     void handleAsyncUpdate() override;
     //csound breakpint function
@@ -232,30 +245,107 @@ public:
 
     AudioPlayHead::CurrentPositionInfo hostInfo = {};
 
+    //==================================================================================
+    // Grid of score events for eventsequencer widgets. Cells are parsed into numeric
+    // events on the message thread so the step clock can send them to Csound from the
+    // audio thread without touching any strings. Cells are stored column by column.
     class MatrixEventSequencer
     {
     public:
-        String channel = "";
-        OwnedArray<StringArray> events;
-        int position = 0;
-        void setEventString(int col, int row, String data)
+        static constexpr int maxPFields = 16;
+
+        struct Event
+        {
+            char opcode = 0;    //0 for empty cells
+            int numPFields = 0;
+            MYFLT pFields[maxPFields] = {};
+        };
+
+        MatrixEventSequencer (const String& csoundChannel, int numRows, int numColumns) : channel (csoundChannel)
+        {
+            resize (numRows, numColumns);
+        }
+
+        //keeps the cells that are still inside the grid. The editor calls this each
+        //time it opens, so nothing is touched when the size hasn't changed
+        void resize (int numRows, int numColumns)
+        {
+            numRows = jmax (0, numRows);
+            numColumns = jmax (0, numColumns);
+
+            //cells only change on the message thread, so they can be read here
+            //without holding up the audio thread
+            if (numRows == rows && numColumns == columns)
+                return;
+
+            std::vector<Event> newCells ((size_t) (numRows * numColumns));
+
+            for (int col = 0; col < jmin (columns, numColumns); ++col)
+                for (int row = 0; row < jmin (rows, numRows); ++row)
+                    newCells[(size_t) (col * numRows + row)] = cells[(size_t) (col * rows + row)];
+
+            const SpinLock::ScopedLockType sl (lock);
+            rows = numRows;
+            columns = numColumns;
+            cells.swap (newCells);
+        }
+
+        void setEvent (int col, int row, const Event& event)
         {
-            events[col]->set(row, data);
+            const SpinLock::ScopedLockType sl (lock);
+            if (isPositiveAndBelow (col, columns) && isPositiveAndBelow (row, rows))
+                cells[(size_t) (col * rows + row)] = event;
+        }
+
+        Event getEvent (int col, int row) const
+        {
+            const SpinLock::ScopedLockType sl (lock);
+            if (isPositiveAndBelow (col, columns) && isPositiveAndBelow (row, rows))
+                return cells[(size_t) (col * rows + row)];
+
+            return {};
         }
 
-        explicit MatrixEventSequencer(String csoundChannel):channel(csoundChannel){}
-        ~MatrixEventSequencer(){ events.clear();}
+        int getNumSteps() const     {   return stepsRunVertically ? rows : columns;   }
+        int getNumTracks() const    {   return stepsRunVertically ? columns : rows;   }
 
+        //turns a cell's text, i.e, "i1 0 1 440", into an event. Cells that
+        //don't hold a purely numeric i or f statement are left empty.
+        static Event parseEvent (const String& data);
+
+        const String channel;
+        //step clock, driven by the host playhead. Disabled when stepsPerBeat is 0
+        int stepsPerBeat = 0;
+        bool stepsRunVertically = true;
+        MYFLT* positionChannel = nullptr;
+
+    private:
+        int rows = 0, columns = 0;
+        std::vector<Event> cells;
+        mutable SpinLock lock;
     };
 
 	int numMatrixEventSequencers = 0;
-    void createMatrixEventSequencer(int rows, int cols, String channel);
-    void setMatrixEventSequencerCellData(int row, int col, const String& channel, String data);
+    int createMatrixEventSequencer(int rows, int cols, const String& channel);
+    int getMatrixEventSequencerIndex(const String& channel) const;
+    void setMatrixEventSequencerCellData(int sequencerIndex, int col, int row, const String& data);
+    void setMatrixEventSequencerClock(int sequencerIndex, int stepsPerBeat, bool stepsRunVertically);
+
+    //host parameters are written to Csound through here, see CabbageHostAutomation
+    int addHostAutomationChannel(const String& channel, bool canRamp, float smoothingTimeMs = 0);
+    CabbageHostAutomation hostAutomation;
+
+    //control channels set by the editor, see CabbageChannelMailbox
+    int getUiChannelHandle(const String& channel);
+    void setUiChannelValue(int channelHandle, float value);
+    CabbageChannelMailbox uiChannels;
 
     virtual void sendChannelDataToCsound() {}
     virtual void getIdentifierDataFromCsound() {}
     void sendHostDataToCsound();
     virtual void getChannelDataFromCsound() {}
+    //called on the audio thread at each k-boundary, before host automation is written to Csound
+    virtual void advanceAutomation (double seconds) { ignoreUnused (seconds); }
     virtual void initAllCsoundChannels (ValueTree cabbageData);
     //=============================================================================
     void addMacros (String& csdText);
@@ -269,6 +359,10 @@ public:
     void compileCsdString (String csdFileText)
     {
         csCompileResult = csound->CompileCsdText (const_cast<char*> (csdFileText.toUTF8().getAddress()));
+
+        //unlike Compile(), CompileCsdText() leaves starting the engine to us
+        if (csCompileResult == 0)
+            csCompileResult = csound->Start();
     }
 
     bool csdCompiledWithoutError()
@@ -360,6 +454,8 @@ public:
     std::unique_ptr<AudioData::Converter> converter;
     CriticalSection writerLock;
     OwnedArray<MatrixEventSequencer> matrixEventSequencers;
+    HashMap<String, int> matrixEventSequencerIndices;
+    CriticalSection matrixEventSequencerLock;
     OwnedArray <SignalDisplay, CriticalSection> signalArrays;   //holds values from FFT function table created using dispfft
     CsoundPluginProcessor::SignalDisplay* getSignalArray (String variableName, String displayType = "") const;
 
@@ -387,14 +483,51 @@ public:
     }
     
     ProcessBlockTimeListener processBlockListener;
+    //block, k-cycle and GUI polling times for this instance, see CabbageProcessorStats
+    CabbageProcessorStats processorStats;
 private:
     //==============================================================================
+    void triggerMatrixEventSequencers (int blockSamplePosition, int numSamples);
+
+    //collected by initAllCsoundChannels so that channel defaults can be written in one go
+    struct NumericChannelDefault
+    {
+        String channel;
+        MYFLT value;
+    };
+
+    void writeNumericChannelDefaults (const Array<NumericChannelDefault>& defaults);
+
+    //writes the stats since the last call to the reserved CABBAGE_* channels
+    void sendStatsToCsound();
+    enum { numStatsChannels = 7 };
+    int statsChannelHandles[numStatsChannels] = {};
+    bool statsChannelsResolved = false;
+    CabbageProcessorStats::Snapshot lastSentStats;
+
+    //a combobox or listbox that lists the files in a folder, scanned on a thread pool at load
+    struct FileListScan  : public ThreadPoolJob
+    {
+        FileListScan (const String& channelName, const String& dir, const String& type, const String& value)
+            : ThreadPoolJob ("Cabbage file list scan"), channel (channelName), workingDir (dir), fileType (type), currentValue (value) {}
+
+        JobStatus runJob() override;
+
+        const String channel, workingDir, fileType, currentValue;
+        String result;
+    };
+
+    AudioPlayHead::CurrentPositionInfo sequencerPlayHeadInfo = {};
     int polling = 1;
     MidiBuffer midiOutputBuffer;
+    //MIDI from Csound, stamped with the offset in the block of the k-cycle that sent it
+    CabbageMidiOutputQueue midiOutputQueue;
+    int kCycleSampleOffset = 0;
     int guiCycles = 0;
     int guiRefreshRate = 128;
     MidiBuffer midiBuffer = {};
     String csoundOutput = {};
+    CabbageCsoundMessageLog messageLog;
     std::unique_ptr<CSOUND_PARAMS> csoundParams;
     int csCompileResult = -1;
     int numCsoundOutputChannels = 0;
@@ -408,7 +541,15 @@ private:
     int samplingRate = 44100;
     int csndIndex = 0;
     int csdKsmps = 0;
+    int requestedKsmps = 32;
+    int hostBlockSize = 0;
+    //zero latency, the gcd of every block size since prepareToPlay, which ksmps has to divide
+    std::atomic<int> zeroLatencyBlockGcd { 0 };
+    std::atomic<bool> zeroLatencyRecompilePending { false };
+    std::atomic<bool> zeroLatencyRecompileWhilePlaying { false };
     File csdFile = {}, csdFilePath = {};
+    //the text compiled in place of csdFile when it has imports, so a recompile can reuse it
+    String expandedCsdText;
     std::unique_ptr<Csound> csound;
     std::unique_ptr<FileLogger> fileLogger;
 
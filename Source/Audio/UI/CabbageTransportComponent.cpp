@@ -31,6 +31,7 @@ CabbageTransportComponent::CabbageTransportComponent(GraphDocumentComponent* gra
     timeLabel("TimeLabel"),
     beatsLabel("beatsLabel"),
     bpmLabel("60 bpm"),
+    loopLabel("loopLabel"),
     timingInfoBox(),
     overlay(),
     owner(graph)
@@ -43,6 +44,9 @@ CabbageTransportComponent::CabbageTransportComponent(GraphDocumentComponent* gra
     info.timeSigDenominator  = 4;
     info.timeSigNumerator = 4;
     info.ppqPosition = 0;
+    info.ppqLoopStart = 0;
+    info.ppqLoopEnd = 0;
+    info.isLooping = false;
     owner->graph->setPlayHeadInfo(info);
 
 
@@ -72,6 +76,20 @@ CabbageTransportComponent::CabbageTransportComponent(GraphDocumentComponent* gra
     bpmLabel.setText("60 bpm", dontSendNotification);
     bpmLabel.setAlwaysOnTop(true);
 
+    //loop range in beats, e.g. "1-9" loops the first two bars of 4/4, anything else turns looping off
+    loopLabel.setJustificationType(Justification::right);
+    loopLabel.setFont(Font(18, 1));
+    loopLabel.setLookAndFeel(lookAndFeel);
+    loopLabel.setEditable(true, true);
+    loopLabel.addListener(this);
+    loopLabel.setColour(Label::backgroundColourId, Colours::transparentBlack);
+    loopLabel.setColour(Label::textColourId, Colours::cornflowerblue);
+    loopLabel.setColour(Label::outlineWhenEditingColourId, Colours::transparentBlack);
+    loopLabel.setColour(Label::ColourIds::textWhenEditingColourId, Colours::white);
+    loopLabel.setText("Loop off", dontSendNotification);
+    loopLabel.setTooltip("Loop range in beats, e.g. 1-9");
+    loopLabel.setAlwaysOnTop(true);
+
     playButton.setLookAndFeel(lookAndFeel);
     playButton.setColour(DrawableButton::backgroundColourId, Colours::transparentBlack);
     playButton.setColour(DrawableButton::backgroundOnColourId, Colours::transparentBlack);
@@ -91,6 +109,7 @@ CabbageTransportComponent::CabbageTransportComponent(GraphDocumentComponent* gra
     addAndMakeVisible (stopButton);
     addAndMakeVisible (recordButton);
     addAndMakeVisible (bpmLabel);
+    addAndMakeVisible (loopLabel);
     addAndMakeVisible (timeLabel);
     addAndMakeVisible (beatsLabel);
     addAndMakeVisible (overlay);
@@ -104,6 +123,18 @@ CabbageTransportComponent::CabbageTransportComponent(GraphDocumentComponent* gra
 
 void CabbageTransportComponent::labelTextChanged (Label *labelThatHasChanged)
 {
+    if (labelThatHasChanged == &loopLabel)
+    {
+        const String text = labelThatHasChanged->getText(true).replace("Loop", "", true).trim();
+        const int loopStart = text.upToFirstOccurrenceOf("-", false, false).getIntValue();
+        const int loopEnd = text.fromFirstOccurrenceOf("-", false, false).getIntValue();
+        const bool isLooping = loopStart > 0 && loopEnd > loopStart;
+
+        //beats are numbered from 1, as in the beats display, the playhead counts quarter notes from 0
+        owner->graph->setLoopRange(loopStart - 1, loopEnd - 1, isLooping);
+        labelThatHasChanged->setText(isLooping ? "Loop " + String(loopStart) + "-" + String(loopEnd) : "Loop off", dontSendNotification);
+        return;
+    }
 
     const String text = labelThatHasChanged->getText(true).replace("bpm", "");
     if(text.getIntValue() > 0)
@@ -115,20 +146,15 @@ void CabbageTransportComponent::labelTextChanged (Label *labelThatHasChanged)
 
 void CabbageTransportComponent::timerCallback()
 {
-    const double ellapsedTime = owner->graph->getTimeInSeconds();
+    //display only, the clock itself is advanced by the graph's audio callback
+    const AudioPlayHead::CurrentPositionInfo info = owner->graph->getPlayHeadInfo();
+    const double ellapsedTime = info.timeInSeconds;
     const int hours = (int(ellapsedTime) / 60 / 60) % 24;
     const int minutes = (int(ellapsedTime) / 60) % 60;
     const int seconds = int(ellapsedTime) % 60;
     String time = String::formatted("%02d", hours)+" : "+String::formatted("%02d", minutes)+" : "+String::formatted("%02d", seconds);
 
-
-    const double elaspsedQNs = owner->graph->getPPQPosition();
-
-    if(elaspsedQNs>=1)
-    {
-        String ppqPos = "Beat "+String(elaspsedQNs);
-        setBeatsLabel(String(ppqPos));
-    }
+    setBeatsLabel("Beat "+String(int(info.ppqPosition) + 1));
     setTimeLabel(time);
 
 }
@@ -239,6 +265,7 @@ void CabbageTransportComponent::resized()
     timeLabel.setBounds(r.withHeight(getHeight()/1.5).reduced(30, 0));
     beatsLabel.setBounds(r.getTopLeft().x+80, r.getTopLeft().y+23, 70, 30);
     bpmLabel.setBounds(r.getTopLeft().x+15, r.getTopLeft().y+23, 70, 30);
+    loopLabel.setBounds(r.getTopLeft().x+150, r.getTopLeft().y+23, 90, 30);
 
     Path timeBox;
     timeBox.addRoundedRectangle(r, 5);
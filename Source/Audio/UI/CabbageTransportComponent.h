@@ -112,6 +112,7 @@ private:
     DrawableButton recordButton;
     GraphDocumentComponent* owner;
     Label bpmLabel;
+    Label loopLabel;
     Label timeLabel;
     Label beatsLabel;
 
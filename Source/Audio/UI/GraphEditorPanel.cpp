@@ -177,6 +177,7 @@ public SettableTooltipClient
 //==============================================================================
 struct GraphEditorPanel::FilterComponent   : public Component,
 public Timer,
+public SettableTooltipClient,
 private AudioProcessorParameter::Listener
 {
     FilterComponent (GraphEditorPanel& p, AudioProcessorGraph::NodeID id)  : panel (p), graph (p.graph), pluginID (id)
@@ -314,6 +315,21 @@ private AudioProcessorParameter::Listener
         g.setColour(Colours::green.withAlpha(.3f));
         g.drawRoundedRectangle(x + 0.5, y + 0.5, w - 1, h - 1, 5, 1.0f);
         
+        if (cpuLoad >= 0)
+        {
+            g.setColour (cpuLoad > 0.5f ? Colours::orange : Colour (160, 160, 160));
+            g.setFont (10.f);
+            g.drawText (String (cpuLoad * 100.f, 1) + "%", x + 4, y + h - 14, w - 10, 12, Justification::right, false);
+        }
+        
+        //worst block time of the last update, red if a block took longer than the audio it produced
+        if (blockTimeP99 >= 0)
+        {
+            g.setColour (hadXrun ? Colours::red : Colour (160, 160, 160));
+            g.setFont (10.f);
+            g.drawText ("p99 " + String (blockTimeP99, 1) + "ms", x + 6, y + h - 14, w - 10, 12, Justification::left, false);
+        }
+        
         //auto boxArea = getLocalBounds().reduced (4, pinSize);
         //bool isBypassed = false;
         
@@ -450,6 +466,9 @@ private AudioProcessorParameter::Listener
             menu->addItem (10, "Show plugin GUI");
             menu->addItem (11, "Show all programs");
             menu->addItem (12, "Show all parameters");
+            
+            if (dynamic_cast<CabbagePluginProcessor*> (getProcessor()) != nullptr)
+                menu->addItem (14, "Export stats...");
 #if JUCE_WINDOWS && JUCE_WIN_PER_MONITOR_DPI_AWARE
             auto isTicked = false;
             if (auto* node = graph.graph.getNodeForId (pluginID))
@@ -503,6 +522,7 @@ private AudioProcessorParameter::Listener
                         node->properties.set ("DPIAware", ! node->properties ["DPIAware"]);
                     break;
                 }
+                case 14:  exportStats(); break;
                 case 20:  showWindow (PluginWindow::Type::audioIO); break;
                 case 21:  testStateSaveLoad(); break;
                     
@@ -521,6 +541,22 @@ private AudioProcessorParameter::Listener
         }
     }
     
+    void exportStats()
+    {
+        statsFileChooser = std::make_unique<FileChooser> ("Export stats",
+                                                          File::getSpecialLocation (File::userDocumentsDirectory).getChildFile (File::createLegalFileName (getName()) + "Stats.json"),
+                                                          "*.json");
+        
+        statsFileChooser->launchAsync (FileBrowserComponent::saveMode | FileBrowserComponent::canSelectFiles | FileBrowserComponent::warnAboutOverwriting,
+                                       [this] (const FileChooser& fc)
+        {
+            //the node may have been deleted while the chooser was open
+            if (auto* cabbagePlugin = dynamic_cast<CabbagePluginProcessor*> (getProcessor()))
+                if (fc.getResult() != File())
+                    cabbagePlugin->processorStats.writeToFile (fc.getResult(), getName());
+        });
+    }
+    
     void showWindow (PluginWindow::Type type)
     {
         if (auto node = graph.graph.getNodeForId (pluginID))
@@ -544,6 +580,44 @@ private AudioProcessorParameter::Listener
     
     void parameterGestureChanged (int, bool) override  {}
     
+    void setCpuLoad (float newLoad)
+    {
+        //only repaint when the displayed figure changes
+        if (roundToInt (newLoad * 1000.f) != roundToInt (cpuLoad * 1000.f))
+        {
+            cpuLoad = newLoad;
+            repaint();
+        }
+    }
+    
+    //Cabbage instances time themselves, this shows what they recorded since the last update
+    void updateStats()
+    {
+        auto* cabbagePlugin = dynamic_cast<CabbagePluginProcessor*> (getProcessor());
+        
+        if (cabbagePlugin == nullptr)
+            return;
+        
+        const auto stats = cabbagePlugin->processorStats.getSnapshot();
+        const auto window = stats - lastStats;
+        lastStats = stats;
+        
+        if (window.blockTime.numValues == 0)
+            return;
+        
+        setTooltip (getName() + ": " + window.getSummary());
+        
+        const float newBlockTimeP99 = (float) window.blockTime.getPercentile (0.99) / 1000.f;
+        const bool newXrun = window.numXruns > 0;
+        
+        if (newBlockTimeP99 != blockTimeP99 || newXrun != hadXrun)
+        {
+            blockTimeP99 = newBlockTimeP99;
+            hadXrun = newXrun;
+            repaint();
+        }
+    }
+    
     GraphEditorPanel& panel;
     FilterGraph& graph;
     const AudioProcessorGraph::NodeID pluginID;
@@ -555,6 +629,11 @@ private AudioProcessorParameter::Listener
     int numIns = 0, numOuts = 0;
     DropShadowEffect shadow;
     std::unique_ptr<PopupMenu> menu;
+    float cpuLoad = -1;
+    CabbageProcessorStats::Snapshot lastStats;
+    float blockTimeP99 = -1;
+    bool hadXrun = false;
+    std::unique_ptr<FileChooser> statsFileChooser;
 };
 
 
@@ -758,6 +837,7 @@ GraphEditorPanel::GraphEditorPanel (FilterGraph& g)  : graph (g)
 {
     graph.addChangeListener (this);
     setOpaque (false);
+    startTimer (500);
 }
 
 GraphEditorPanel::~GraphEditorPanel()
@@ -1077,6 +1157,15 @@ void GraphEditorPanel::endDraggingConnector (const MouseEvent& e)
     }
 }
 
+void GraphEditorPanel::timerCallback()
+{
+    for (auto* node : nodes)
+    {
+        node->setCpuLoad (graph.graph.getNodeCpuLoad (node->pluginID));
+        node->updateStats();
+    }
+}
+
 //void GraphEditorPanel::timerCallback()
 //{
 //    // this should only be called on touch devices
@@ -37,7 +37,8 @@ class CabbageMainComponent;
  A panel that displays and edits a FilterGraph.
  */
 class GraphEditorPanel   : public Component,
-public ChangeListener
+public ChangeListener,
+private Timer
 {
 public:
     GraphEditorPanel (FilterGraph& graph);
@@ -94,7 +95,8 @@ private:
     //==============================================================================
     juce::Point<int> originalTouchPos;
     CabbageLookAndFeel2 lookAndFeel;
-    //void timerCallback() override;
+    //shows how much of each block the graph's nodes are taking
+    void timerCallback() override;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GraphEditorPanel)
 };
@@ -165,6 +167,8 @@ public:
     }
     bool shouldMuteInput = true;
     AudioSampleBuffer emptyBuffer;
+    std::vector<const float*> inputChannelOffsets;
+    std::vector<float*> outputChannelOffsets;
     //inherting audioIODeviceCallback so as to get rid of feedback when graph first starts..
     //==============================================================================
     void audioDeviceIOCallback (const float** inputChannelData,
@@ -180,14 +184,38 @@ public:
             inputChannelData = emptyBuffer.getArrayOfReadPointers();
         }
         
-        graphPlayer.audioDeviceIOCallback (inputChannelData, numInputChannels,
-                                           outputChannelData, numOutputChannels, numSamples);
+        //the playhead may ask for the block to be split at a loop end, in which case the rest
+        //is processed as a block of its own that starts at the loop start
+        if (numInputChannels > (int) inputChannelOffsets.size() || numOutputChannels > (int) outputChannelOffsets.size())
+        {
+            graph->advancePlayHead (numSamples);
+            graphPlayer.audioDeviceIOCallback (inputChannelData, numInputChannels,
+                                               outputChannelData, numOutputChannels, numSamples);
+            return;
+        }
+
+        for (int offset = 0; offset < numSamples;)
+        {
+            const int samplesThisTime = graph->advancePlayHead (numSamples - offset);
+
+            for (int i = 0; i < numInputChannels; ++i)
+                inputChannelOffsets[i] = inputChannelData[i] != nullptr ? inputChannelData[i] + offset : nullptr;
+
+            for (int i = 0; i < numOutputChannels; ++i)
+                outputChannelOffsets[i] = outputChannelData[i] != nullptr ? outputChannelData[i] + offset : nullptr;
+
+            graphPlayer.audioDeviceIOCallback (inputChannelOffsets.data(), numInputChannels,
+                                               outputChannelOffsets.data(), numOutputChannels, samplesThisTime);
+            offset += samplesThisTime;
+        }
     }
     
     void audioDeviceAboutToStart (AudioIODevice* device) override
     {
         emptyBuffer.setSize (device->getActiveInputChannels().countNumberOfSetBits(), device->getCurrentBufferSizeSamples());
         emptyBuffer.clear();
+        inputChannelOffsets.resize ((size_t) jmax (emptyBuffer.getNumChannels(), device->getActiveInputChannels().getHighestBit() + 1));
+        outputChannelOffsets.resize ((size_t) (device->getActiveOutputChannels().getHighestBit() + 1));
         
         graphPlayer.audioDeviceAboutToStart (device);
     }
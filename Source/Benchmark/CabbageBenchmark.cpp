@@ -0,0 +1,670 @@
+/*
+  Copyright (C) 2016 Rory Walsh
+
+  Cabbage is free software; you can redistribute it
+  and/or modify it under the terms of the GNU General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  Cabbage is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public
+  License along with Csound; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+  02111-1307 USA
+*/
+
+#include "JuceHeader.h"
+#include "../Audio/Plugins/CabbagePluginProcessor.h"
+#include <iostream>
+#include <new>
+
+//==============================================================================
+// Measures what the Cabbage processing path costs on top of Csound. Each case
+// generates an instrument, runs it through CabbagePluginProcessor::processBlock
+// on a high priority thread while the message thread keeps polling widgets as
+// it would in a host, and then renders the same instrument and notes with a
+// bare Csound instance. The difference between the two is Cabbage's overhead:
+// the per-sample I/O loop, MIDI handling, host data channels, recording and so
+// on. Results are written as JSON, for example
+//
+//   CabbageBenchmark --output=results.json --seconds=20 --widgets=0,100,1000
+//
+// Cases vary one setting at a time from the defaults, plus one case with
+// recording on and one with the editor open. Options:
+//   --output=file      JSON file to write, otherwise results go to stdout
+//   --seconds=n        audio rendered per case, defaults to 10
+//   --samplerate=n     defaults to 48000
+//   --ksmps=list       comma separated values to try, defaults to 1,16,32,64
+//   --blocksizes=list  defaults to 32,64,256,1024
+//   --channels=list    defaults to 1,2,8
+//   --midi=list        notes per second, defaults to 0,10,100,1000
+//   --widgets=list     defaults to 0,16,128,1024
+//
+// Before the cases run, a zero latency instrument is sent one short block to
+// check that its ksmps only drops to the gcd of the block sizes. The benchmark
+// returns 1 if that check fails.
+//==============================================================================
+
+//==============================================================================
+// Counts calls to operator new on threads that ask for it. Csound's own
+// memory comes from malloc and isn't counted, only allocations on the C++
+// side of the audio path.
+namespace BenchmarkAllocations
+{
+    static std::atomic<int64> count { 0 };
+    static thread_local bool isCounting = false;
+
+    static void* allocate (std::size_t size)
+    {
+        if (isCounting)
+            count.fetch_add (1, std::memory_order_relaxed);
+
+        if (void* memory = std::malloc (size > 0 ? size : 1))
+            return memory;
+
+        throw std::bad_alloc();
+    }
+}
+
+void* operator new (std::size_t size)                           {   return BenchmarkAllocations::allocate (size);   }
+void* operator new[] (std::size_t size)                         {   return BenchmarkAllocations::allocate (size);   }
+void operator delete (void* memory) noexcept                    {   std::free (memory);   }
+void operator delete[] (void* memory) noexcept                  {   std::free (memory);   }
+void operator delete (void* memory, std::size_t) noexcept       {   std::free (memory);   }
+void operator delete[] (void* memory, std::size_t) noexcept     {   std::free (memory);   }
+
+//==============================================================================
+struct BenchmarkCase
+{
+    String name;
+    int ksmps = 32;
+    int blockSize = 256;
+    int numChannels = 2;
+    int midiNotesPerSecond = 10;
+    int numWidgets = 16;
+    bool isRecording = false;
+    bool isEditorOpen = false;
+};
+
+struct BenchmarkPlayHead  : public AudioPlayHead
+{
+    BenchmarkPlayHead()
+    {
+        info.bpm = 120;
+        info.timeSigNumerator = 4;
+        info.timeSigDenominator = 4;
+        info.isPlaying = true;
+    }
+
+    bool getCurrentPosition (CurrentPositionInfo& result) override
+    {
+        result = info;
+        return true;
+    }
+
+    void advance (int numSamples, double sampleRate)
+    {
+        info.timeInSamples += numSamples;
+        info.timeInSeconds = info.timeInSamples / sampleRate;
+        info.ppqPosition = info.timeInSeconds * info.bpm / 60.0;
+    }
+
+    CurrentPositionInfo info;
+};
+
+struct NoteEvent
+{
+    int64 samplePosition;
+    int noteNumber;
+    bool isNoteOn;
+};
+
+//==============================================================================
+class CabbageBenchmark  : public Thread
+{
+public:
+    CabbageBenchmark (const ArgumentList& arguments) : Thread ("Cabbage benchmark")
+    {
+        auto listOption = [&arguments] (const String& option, const String& defaultValues)
+        {
+            const String value = arguments.getValueForOption (option);
+            StringArray tokens;
+            tokens.addTokens (value.isNotEmpty() ? value : defaultValues, ",", "");
+            tokens.removeEmptyStrings();
+
+            Array<int> values;
+
+            for (auto& token : tokens)
+                values.add (token.getIntValue());
+
+            return values;
+        };
+
+        const String output = arguments.getValueForOption ("--output").unquoted();
+        outputFile = output.isEmpty() ? File() : File::getCurrentWorkingDirectory().getChildFile (output);
+
+        const String seconds = arguments.getValueForOption ("--seconds");
+        secondsPerCase = seconds.isEmpty() ? 10.0 : jmax (0.1, seconds.getDoubleValue());
+
+        const String rate = arguments.getValueForOption ("--samplerate");
+        sampleRate = rate.isEmpty() ? 48000.0 : rate.getDoubleValue();
+
+        const BenchmarkCase defaults;
+        cases.add (withName (defaults, "default"));
+
+        for (auto ksmps : listOption ("--ksmps", "1,16,32,64"))
+            if (ksmps != defaults.ksmps)
+                cases.add (withName (defaults, "ksmps", [ksmps] (BenchmarkCase& c) { c.ksmps = ksmps; }));
+
+        for (auto blockSize : listOption ("--blocksizes", "32,64,256,1024"))
+            if (blockSize != defaults.blockSize)
+                cases.add (withName (defaults, "blockSize", [blockSize] (BenchmarkCase& c) { c.blockSize = blockSize; }));
+
+        for (auto numChannels : listOption ("--channels", "1,2,8"))
+            if (numChannels != defaults.numChannels)
+                cases.add (withName (defaults, "channels", [numChannels] (BenchmarkCase& c) { c.numChannels = numChannels; }));
+
+        for (auto notesPerSecond : listOption ("--midi", "0,10,100,1000"))
+            if (notesPerSecond != defaults.midiNotesPerSecond)
+                cases.add (withName (defaults, "midi", [notesPerSecond] (BenchmarkCase& c) { c.midiNotesPerSecond = notesPerSecond; }));
+
+        for (auto numWidgets : listOption ("--widgets", "0,16,128,1024"))
+            if (numWidgets != defaults.numWidgets)
+                cases.add (withName (defaults, "widgets", [numWidgets] (BenchmarkCase& c) { c.numWidgets = numWidgets; }));
+
+        cases.add (withName (defaults, "recording", [] (BenchmarkCase& c) { c.isRecording = true; }));
+        cases.add (withName (defaults, "editorOpen", [] (BenchmarkCase& c) { c.isEditorOpen = true; }));
+    }
+
+    ~CabbageBenchmark() override
+    {
+        stopThread (-1);
+    }
+
+    int returnValue = 0;
+
+private:
+    static BenchmarkCase withName (BenchmarkCase c, const String& setting,
+                                   std::function<void (BenchmarkCase&)> change = nullptr)
+    {
+        if (change != nullptr)
+            change (c);
+
+        c.name = setting;
+        return c;
+    }
+
+    //==============================================================================
+    void run() override
+    {
+        Array<var> results;
+
+        const String zeroLatencyError = checkZeroLatencyKsmps();
+
+        if (zeroLatencyError.isNotEmpty())
+        {
+            std::cerr << "Zero latency check failed: " << zeroLatencyError << std::endl;
+            returnValue = 1;
+        }
+
+        for (auto& benchmarkCase : cases)
+        {
+            if (threadShouldExit())
+                break;
+
+            std::cerr << "Running " << benchmarkCase.name << " (ksmps " << benchmarkCase.ksmps
+                      << ", block " << benchmarkCase.blockSize << ", channels " << benchmarkCase.numChannels
+                      << ", notes/s " << benchmarkCase.midiNotesPerSecond << ", widgets " << benchmarkCase.numWidgets << ")" << std::endl;
+
+            const var result = runCase (benchmarkCase);
+
+            if (result.hasProperty ("error"))
+                returnValue = 1;
+
+            results.add (result);
+        }
+
+        auto* report = new DynamicObject();
+        report->setProperty ("version", ProjectInfo::versionString);
+        report->setProperty ("date", Time::getCurrentTime().toISO8601 (true));
+        report->setProperty ("cpu", SystemStats::getCpuModel());
+        report->setProperty ("numCpus", SystemStats::getNumCpus());
+        report->setProperty ("operatingSystem", SystemStats::getOperatingSystemName());
+        report->setProperty ("sampleRate", sampleRate);
+        report->setProperty ("secondsPerCase", secondsPerCase);
+        report->setProperty ("zeroLatencyCheck", zeroLatencyError.isEmpty() ? String ("passed") : zeroLatencyError);
+        report->setProperty ("cases", results);
+
+        const String json = JSON::toString (var (report));
+
+        if (outputFile == File())
+            std::cout << json << std::endl;
+        else if (! outputFile.replaceWithText (json))
+            returnValue = 1;
+
+        MessageManager::getInstance()->stopDispatchLoop();
+    }
+
+    static void callOnMessageThread (std::function<void()> function)
+    {
+        MessageManager::getInstance()->callFunctionOnMessageThread ([] (void* data) -> void*
+        {
+            (*static_cast<std::function<void()>*> (data))();
+            return nullptr;
+        }, &function);
+    }
+
+    //==============================================================================
+    //with latency(-1), a short block should only lower ksmps to one that divides every block size so far
+    String checkZeroLatencyKsmps()
+    {
+        BenchmarkCase checkCase;
+        checkCase.numWidgets = 0;
+        checkCase.midiNotesPerSecond = 0;
+
+        TemporaryFile csdFile (".csd");
+        csdFile.getFile().replaceWithText (createInstrument (checkCase).replace ("pluginId(\"bnch\")", "pluginId(\"bnch\"), latency(-1)"));
+
+        std::unique_ptr<CabbagePluginProcessor> processor;
+
+        callOnMessageThread ([&processor, &csdFile]
+        {
+            processor.reset (new CabbagePluginProcessor (csdFile.getFile(), CabbagePluginProcessor::readBusesPropertiesFromXml (csdFile.getFile())));
+        });
+
+        //a recompile is queued on the message thread, so ksmps is read there after it
+        auto getKsmps = [&processor]
+        {
+            int ksmps = 0;
+            callOnMessageThread ([&processor, &ksmps] { ksmps = processor->getCsound() != nullptr ? (int) processor->getCsound()->GetKsmps() : 0; });
+            return ksmps;
+        };
+
+        String error;
+
+        if (processor->csdCompiledWithoutError())
+        {
+            processor->setRateAndBufferSizeDetails (sampleRate, 256);
+            processor->prepareToPlay (sampleRate, 256);
+
+            //block size, and the ksmps expected after it: 80 brings the gcd down to 16, and 96 is a multiple of that
+            const int blocks[][2] = { { 256, 32 }, { 80, 16 }, { 96, 16 }, { 256, 16 } };
+            const int numChannels = jmax (processor->getTotalNumInputChannels(), processor->getTotalNumOutputChannels());
+            MidiBuffer midiMessages;
+
+            if (getKsmps() != checkCase.ksmps)
+                error = "prepared with a block of 256, ksmps is " + String (getKsmps()) + " rather than " + String (checkCase.ksmps);
+
+            for (auto& block : blocks)
+            {
+                if (error.isNotEmpty())
+                    break;
+
+                AudioBuffer<float> buffer (numChannels, block[0]);
+                buffer.clear();
+                processor->processBlock (buffer, midiMessages);
+
+                const int ksmps = getKsmps();
+
+                if (ksmps != block[1])
+                    error = "after a block of " + String (block[0]) + ", ksmps is " + String (ksmps) + " rather than " + String (block[1]);
+            }
+
+            processor->releaseResources();
+        }
+        else
+        {
+            error = "Csound failed to compile the instrument";
+        }
+
+        callOnMessageThread ([&processor] { processor.reset(); });
+        return error;
+    }
+
+    //==============================================================================
+    var runCase (const BenchmarkCase& benchmarkCase)
+    {
+        auto* result = new DynamicObject();
+        var resultVar (result);
+
+        result->setProperty ("name", benchmarkCase.name);
+        result->setProperty ("ksmps", benchmarkCase.ksmps);
+        result->setProperty ("blockSize", benchmarkCase.blockSize);
+        result->setProperty ("channels", benchmarkCase.numChannels);
+        result->setProperty ("midiNotesPerSecond", benchmarkCase.midiNotesPerSecond);
+        result->setProperty ("widgets", benchmarkCase.numWidgets);
+        result->setProperty ("recording", benchmarkCase.isRecording);
+        result->setProperty ("editorOpen", benchmarkCase.isEditorOpen);
+
+        TemporaryFile csdFile (".csd");
+        csdFile.getFile().replaceWithText (createInstrument (benchmarkCase));
+
+        const int64 numSamples = (int64) (secondsPerCase * sampleRate);
+        const auto notes = createNotes (benchmarkCase, numSamples);
+
+        const String error = runCabbage (benchmarkCase, csdFile.getFile(), notes, numSamples, *result);
+
+        if (error.isNotEmpty())
+        {
+            result->setProperty ("error", error);
+            return resultVar;
+        }
+
+        const double csoundNsPerSample = runCsound (benchmarkCase, csdFile.getFile(), notes, numSamples);
+        result->setProperty ("csoundNsPerSample", csoundNsPerSample);
+        result->setProperty ("overheadNsPerSample", (double) result->getProperty ("nsPerSample") - csoundNsPerSample);
+        return resultVar;
+    }
+
+    String runCabbage (const BenchmarkCase& benchmarkCase, const File& csdFile, const std::vector<NoteEvent>& notes,
+                       int64 numSamples, DynamicObject& result)
+    {
+        std::unique_ptr<CabbagePluginProcessor> processor;
+
+        //processors and editors are created and destroyed on the message thread, as they are in a host
+        callOnMessageThread ([&processor, &csdFile]
+        {
+            processor.reset (new CabbagePluginProcessor (csdFile, CabbagePluginProcessor::readBusesPropertiesFromXml (csdFile)));
+        });
+
+        auto destroyProcessor = [&processor]
+        {
+            callOnMessageThread ([&processor]
+            {
+                if (auto* editor = processor->getActiveEditor())
+                {
+                    processor->editorBeingDeleted (editor);
+                    delete editor;
+                }
+
+                processor.reset();
+            });
+        };
+
+        if (! processor->csdCompiledWithoutError())
+        {
+            destroyProcessor();
+            return "Csound failed to compile the instrument";
+        }
+
+        result.setProperty ("widgetDataBytes", (int64) processor->getWidgetMemoryUsage());
+
+        BenchmarkPlayHead playHead;
+        processor->setPlayHead (&playHead);
+        processor->setRateAndBufferSizeDetails (sampleRate, benchmarkCase.blockSize);
+        processor->prepareToPlay (sampleRate, benchmarkCase.blockSize);
+
+        if (benchmarkCase.isEditorOpen)
+            callOnMessageThread ([&processor] { processor->createEditorIfNeeded(); });
+
+        TemporaryFile recordingFile (".wav");
+
+        if (benchmarkCase.isRecording)
+            processor->startRecording (recordingFile.getFile(), 24);
+
+        const int numChannels = jmax (processor->getTotalNumInputChannels(), processor->getTotalNumOutputChannels());
+        AudioBuffer<float> buffer (numChannels, benchmarkCase.blockSize);
+        AudioBuffer<float> noise (numChannels, benchmarkCase.blockSize);
+        Random random (1);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < benchmarkCase.blockSize; ++i)
+                noise.setSample (channel, i, random.nextFloat() * 0.5f - 0.25f);
+
+        MidiBuffer midiMessages;
+        midiMessages.ensureSize (8192);
+
+        //half a second to settle before anything is measured
+        const int64 numWarmUpSamples = (int64) (sampleRate * 0.5);
+        const int64 numBlocks = (numSamples + benchmarkCase.blockSize - 1) / benchmarkCase.blockSize;
+
+        std::vector<int64> blockTicks;
+        std::vector<int64> blockAllocations;
+        blockTicks.reserve ((size_t) numBlocks);
+        blockAllocations.reserve ((size_t) numBlocks);
+
+        size_t nextNote = 0;
+        int64 totalTicks = 0;
+
+        for (int64 position = -numWarmUpSamples; position < numSamples; position += benchmarkCase.blockSize)
+        {
+            buffer.makeCopyOf (noise, true);
+            midiMessages.clear();
+
+            for (; nextNote < notes.size() && notes[nextNote].samplePosition < position + benchmarkCase.blockSize; ++nextNote)
+            {
+                const auto& note = notes[nextNote];
+                const int offset = (int) jlimit ((int64) 0, (int64) benchmarkCase.blockSize - 1, note.samplePosition - position);
+                midiMessages.addEvent (note.isNoteOn ? MidiMessage::noteOn (1, note.noteNumber, (uint8) 100)
+                                                     : MidiMessage::noteOff (1, note.noteNumber), offset);
+            }
+
+            BenchmarkAllocations::count = 0;
+            BenchmarkAllocations::isCounting = true;
+            const int64 startTicks = Time::getHighResolutionTicks();
+
+            processor->processBlock (buffer, midiMessages);
+
+            const int64 ticks = Time::getHighResolutionTicks() - startTicks;
+            BenchmarkAllocations::isCounting = false;
+
+            playHead.advance (benchmarkCase.blockSize, sampleRate);
+
+            if (position < 0)
+                continue;
+
+            totalTicks += ticks;
+            blockTicks.push_back (ticks);
+            blockAllocations.push_back (BenchmarkAllocations::count.load());
+        }
+
+        if (benchmarkCase.isRecording)
+            processor->stopRecording();
+
+        processor->releaseResources();
+        processor->setPlayHead (nullptr);
+        destroyProcessor();
+
+        const double nsPerTick = 1.0e9 / (double) Time::getHighResolutionTicksPerSecond();
+        const double blockPeriodNs = 1.0e9 * benchmarkCase.blockSize / sampleRate;
+        std::sort (blockTicks.begin(), blockTicks.end());
+
+        auto percentile = [&blockTicks, nsPerTick] (double p)
+        {
+            return blockTicks.empty() ? 0.0 : blockTicks[(size_t) (p * (double) (blockTicks.size() - 1))] * nsPerTick;
+        };
+
+        int64 totalAllocations = 0, maxAllocations = 0, blocksWithAllocations = 0;
+
+        for (auto allocations : blockAllocations)
+        {
+            totalAllocations += allocations;
+            maxAllocations = jmax (maxAllocations, allocations);
+            blocksWithAllocations += allocations > 0 ? 1 : 0;
+        }
+
+        const double numMeasuredBlocks = jmax ((double) blockTicks.size(), 1.0);
+
+        result.setProperty ("nsPerSample", totalTicks * nsPerTick / (numMeasuredBlocks * benchmarkCase.blockSize));
+        result.setProperty ("blockNsP50", percentile (0.5));
+        result.setProperty ("blockNsP90", percentile (0.9));
+        result.setProperty ("blockNsP99", percentile (0.99));
+        result.setProperty ("blockNsP999", percentile (0.999));
+        result.setProperty ("blockNsMax", percentile (1.0));
+        result.setProperty ("blockPeriodNs", blockPeriodNs);
+        result.setProperty ("p99ShareOfBlockPeriod", percentile (0.99) / blockPeriodNs);
+        result.setProperty ("allocationsPerBlock", totalAllocations / numMeasuredBlocks);
+        result.setProperty ("maxAllocationsInBlock", maxAllocations);
+        result.setProperty ("blocksWithAllocations", blocksWithAllocations);
+        return {};
+    }
+
+    //renders the same instrument and notes with Csound alone, returning ns per sample
+    double runCsound (const BenchmarkCase& benchmarkCase, const File& csdFile, const std::vector<NoteEvent>& notes, int64 numSamples)
+    {
+        Csound csound;
+        csound.SetHostImplementedAudioIO (1, 0);
+        csound.SetHostImplementedMIDIIO (true);
+        csound.SetOption ((char*) "-n");
+        csound.SetOption ((char*) "-d");
+
+        if (csound.Compile (csdFile.getFullPathName().toUTF8().getAddress()) != 0 || csound.Start() != 0)
+            return 0;
+
+        //the notes become score events of the same length, timed from the end of the warm up
+        const double warmUpSeconds = 0.5;
+        String score;
+
+        for (size_t i = 0; i < notes.size(); ++i)
+        {
+            if (! notes[i].isNoteOn)
+                continue;
+
+            for (size_t j = i + 1; j < notes.size(); ++j)
+            {
+                if (! notes[j].isNoteOn && notes[j].noteNumber == notes[i].noteNumber)
+                {
+                    score << "i1 " << (warmUpSeconds + notes[i].samplePosition / sampleRate) << " "
+                          << ((notes[j].samplePosition - notes[i].samplePosition) / sampleRate) << " "
+                          << MidiMessage::getMidiNoteInHertz (notes[i].noteNumber) << " " << (100.0 / 127.0) << "\n";
+                    break;
+                }
+            }
+        }
+
+        csound.ReadScore (score.toUTF8().getAddress());
+
+        const int ksmps = (int) csound.GetKsmps();
+        const int64 numWarmUpCycles = (int64) (sampleRate * warmUpSeconds) / ksmps;
+        const int64 numCycles = numSamples / ksmps;
+
+        for (int64 i = 0; i < numWarmUpCycles; ++i)
+            csound.PerformKsmps();
+
+        const int64 startTicks = Time::getHighResolutionTicks();
+
+        for (int64 i = 0; i < numCycles; ++i)
+            if (csound.PerformKsmps() != 0)
+                break;
+
+        const int64 ticks = Time::getHighResolutionTicks() - startTicks;
+        csound.Stop();
+        csound.Cleanup();
+
+        return ticks * (1.0e9 / (double) Time::getHighResolutionTicksPerSecond()) / (double) jmax ((int64) 1, numCycles * ksmps);
+    }
+
+    //==============================================================================
+    String createInstrument (const BenchmarkCase& benchmarkCase) const
+    {
+        String csd;
+        csd << "<Cabbage>\n"
+            << "form caption(\"Benchmark\") size(800, 600), guiMode(\"queue\"), pluginId(\"bnch\")\n";
+
+        for (int i = 0; i < benchmarkCase.numWidgets; ++i)
+            csd << "rslider bounds(" << (i % 16) * 50 << ", " << (i / 16) * 50 << ", 50, 50), channel(\"w" << i
+                << "\"), range(0, 1, " << (i % 10) / 10.0 << ")\n";
+
+        csd << "</Cabbage>\n"
+            << "<CsoundSynthesizer>\n"
+            << "<CsOptions>\n"
+            << "-n -d -+rtmidi=NULL -M0 --midi-key-cps=4 --midi-velocity-amp=5\n"
+            << "</CsOptions>\n"
+            << "<CsInstruments>\n"
+            << "sr = " << (int) sampleRate << "\n"
+            << "ksmps = " << benchmarkCase.ksmps << "\n"
+            << "nchnls = " << benchmarkCase.numChannels << "\n"
+            << "nchnls_i = " << benchmarkCase.numChannels << "\n"
+            << "0dbfs = 1\n\n"
+            << "massign 0, 1\n"
+            << "gaVoices init 0\n\n"
+            << "instr 1\n"
+            << "aEnv madsr 0.005, 0.05, 0.7, 0.05\n"
+            << "aSig oscili p5 * 0.05, p4\n"
+            << "gaVoices = gaVoices + aSig * aEnv\n"
+            << "endin\n\n"
+            << "instr 2\n"
+            << "kLevel = 0\n";
+
+        for (int i = 0; i < benchmarkCase.numWidgets; ++i)
+            csd << "kW" << i << " chnget \"w" << i << "\"\n"
+                << "kLevel = kLevel + kW" << i << "\n";
+
+        csd << "kScale = 1 / (1 + kLevel)\n";
+
+        for (int channel = 1; channel <= benchmarkCase.numChannels; ++channel)
+            csd << "aIn" << channel << " inch " << channel << "\n"
+                << "outch " << channel << ", aIn" << channel << " * kScale + gaVoices\n";
+
+        csd << "clear gaVoices\n"
+            << "endin\n"
+            << "</CsInstruments>\n"
+            << "<CsScore>\n"
+            << "i2 0 z\n"
+            << "</CsScore>\n"
+            << "</CsoundSynthesizer>\n";
+
+        return csd;
+    }
+
+    //evenly spaced notes of a tenth of a second, on random keys
+    std::vector<NoteEvent> createNotes (const BenchmarkCase& benchmarkCase, int64 numSamples) const
+    {
+        std::vector<NoteEvent> notes;
+
+        if (benchmarkCase.midiNotesPerSecond <= 0)
+            return notes;
+
+        Random random (2);
+        const double samplesBetweenNotes = sampleRate / benchmarkCase.midiNotesPerSecond;
+        const int64 noteLength = (int64) (sampleRate * 0.1);
+        int64 keyReleasedAt[128] = {};
+
+        for (double time = 0; time < (double) numSamples; time += samplesBetweenNotes)
+        {
+            const int64 position = (int64) time;
+            const int noteNumber = 36 + random.nextInt (72);
+
+            //a key that is still down is left alone, so every note on has its own note off
+            if (position < keyReleasedAt[noteNumber])
+                continue;
+
+            keyReleasedAt[noteNumber] = position + noteLength;
+            notes.push_back ({ position, noteNumber, true });
+            notes.push_back ({ position + noteLength, noteNumber, false });
+        }
+
+        std::stable_sort (notes.begin(), notes.end(), [] (const NoteEvent& a, const NoteEvent& b)
+        {
+            return a.samplePosition < b.samplePosition;
+        });
+
+        return notes;
+    }
+
+    Array<BenchmarkCase> cases;
+    File outputFile;
+    double secondsPerCase = 10.0;
+    double sampleRate = 48000.0;
+
+    JUCE_DECLARE_NON_COPYABLE (CabbageBenchmark)
+};
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    ScopedJuceInitialiser_GUI juceInitialiser;
+
+    //the benchmark runs on its own thread while this one dispatches timer and async
+    //callbacks, so widgets are polled just as they are in a host
+    CabbageBenchmark benchmark (ArgumentList (argc, argv));
+    benchmark.startThread (9);
+    MessageManager::getInstance()->runDispatchLoop();
+    benchmark.stopThread (-1);
+
+    return benchmark.returnValue;
+}
@@ -21,6 +21,8 @@
 #include "Application/CabbageDocumentWindow.h"
 #include "Cabbage.h"
 #include "Utilities/CabbageUtilities.h"
+#include "Utilities/CabbageCompileChecker.h"
+#include "Utilities/CabbageOfflineRenderer.h"
 
 
 //==============================================================================
@@ -30,6 +32,25 @@ Cabbage::Cabbage()
 //==============================================================================
 void Cabbage::initialise (const String& commandLine)
 {
+    //when launched by the IDE to test instruments, don't open any windows
+    compileCheckWorker.reset (new CabbageCompileCheckWorker());
+
+    if (compileCheckWorker->initialiseFromCommandLine (commandLine, CabbageCompileChecker::commandLineUID))
+        return;
+
+    compileCheckWorker.reset();
+
+    //headless renders, see CabbageOfflineRenderer
+    offlineRenderer.reset (new CabbageOfflineRenderer());
+
+    if (offlineRenderer->startFromCommandLine (getCommandLineParameterArray()))
+    {
+        isRunningCommandLine = true;
+        return;
+    }
+
+    offlineRenderer.reset();
+
     documentWindow.reset (new CabbageDocumentWindow (getApplicationName(), getCommandLineParameters()));
 
     if (commandLine.isEmpty())
@@ -66,6 +87,9 @@ void Cabbage::anotherInstanceStarted (const String& commandLine)
 //==============================================================================
 void Cabbage::shutdown()
 {
+    compileCheckWorker.reset();
+    offlineRenderer.reset();
+
     if (! isRunningCommandLine)
         Logger::writeToLog ("Shutdown");
 }
@@ -25,6 +25,8 @@
 
 class CabbageProjectWindow;
 class CabbageMainDocumentWindow;
+class CabbageCompileCheckWorker;
+class CabbageOfflineRenderer;
 
 //==============================================================================
 class Cabbage  : public JUCEApplication
@@ -62,6 +64,8 @@ public:
 
 private:
     std::unique_ptr<CabbageDocumentWindow> documentWindow;
+    std::unique_ptr<CabbageCompileCheckWorker> compileCheckWorker;
+    std::unique_ptr<CabbageOfflineRenderer> offlineRenderer;
 };
 
 
@@ -347,6 +347,7 @@ public:
         add ("tableGridColor");
         add ("signalVariable");
         add ("protectedItems");
+        add ("automationRamp");
         add ("keyWidthScale");
         add ("overlayColour");
         add ("keyDownColour");
@@ -359,6 +360,7 @@ public:
         add ("trackerCentre");
 		add ("factoryFolder");
         add ("presetBrowser");
+        add ("stepsPerBeat");
         add ("sliderBounds");
         add ("markerColour");
         add ("valueTextBox");
@@ -424,6 +426,7 @@ public:
         add ("markerEnd");
         add ("menuColor");
         add ("cellWidth");
+        add ("smoothing");
         add ("popupText");
         add ("textColor");
         add ("fontStyle");
@@ -779,6 +782,7 @@ namespace CabbageIdentifierIds
     static const Identifier size = "size";
     static const Identifier sliderbounds = "sliderBounds";
     static const Identifier sliderrange = "sliderRange";
+    static const Identifier smoothing = "smoothing";
     static const Identifier sliderskew = "sliderSkew";
     static const Identifier skew = "skew";
     static const Identifier socketaddress = "socketAddress";
@@ -859,12 +863,22 @@ namespace CabbageIdentifierIds
     static const String nsp = "namespace";
     static const String numberofsteps = "numberOfSteps";
     static const String showstepnumbers = "showStepNumbers";
+    static const String stepsperbeat = "stepsPerBeat";
+    static const String automationramp = "automationRamp";
     static const String stringchannel = "string";
     static const String timeinsamples = "TIME_IN_SAMPLES";
     static const String timeinseconds = "TIME_IN_SECONDS";
     static const String timeSigDenom = "TIME_SIG_DENOM";
     static const String timeSigNum = "TIME_SIG_NUM";
     static const String updaterate = "updaterate";
+    //reserved channels written from CsoundPluginProcessor::processorStats
+    static const String cabbagecpuload = "CABBAGE_CPU_LOAD";
+    static const String cabbageblocktime = "CABBAGE_BLOCK_TIME";
+    static const String cabbageblocktimep99 = "CABBAGE_BLOCK_TIME_P99";
+    static const String cabbagekcycletime = "CABBAGE_KCYCLE_TIME";
+    static const String cabbagemidievents = "CABBAGE_MIDI_EVENTS";
+    static const String cabbagexruns = "CABBAGE_XRUNS";
+    static const String cabbagelockmisses = "CABBAGE_LOCK_MISSES";
     
 }
 
@@ -48,6 +48,7 @@ CabbageEditorContainer::CabbageEditorContainer (CabbageSettings* cabbageSettings
     outputConsole->setVisible (true);
     const int fontSizeConsole = settings->getUserSettings()->getIntValue("FontSizeConsole", 14);
     outputConsole->setFontSize (fontSizeConsole);
+    outputConsole->setScrollbackLines (settings->getUserSettings()->getIntValue ("ConsoleScrollbackLines", 5000));
     statusBar.addMouseListener (this, true);
 
     const int width = settings->getUserSettings()->getIntValue ("IDE_LastKnownWidth");
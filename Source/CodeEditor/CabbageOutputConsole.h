@@ -27,6 +27,7 @@ class CabbageOutputConsole : public Component, public KeyListener
 {
     std::unique_ptr<CodeEditorComponent> textEditor;
     int fontSize;
+    int scrollbackLines = 5000;
     Typeface::Ptr fontPtr;
 public:
     CabbageOutputConsole (ValueTree valueTree, CodeDocument& document): Component(), value (valueTree)
@@ -55,15 +56,29 @@ public:
         DBG("cleaing");
     }
 
+    //appends text to the end of the console, dropping the oldest lines once
+    //the scrollback limit is reached
     void setText (String text)
     {
         const MessageManagerLock lock;
-        String currentText = textEditor->getDocument().getAllContent();
-        textEditor->getDocument().replaceAllContent(currentText + text);
+        CodeDocument& document = textEditor->getDocument();
+        document.insertText (document.getNumCharacters(), text);
 
-        CodeDocument::Position endPos(textEditor->getDocument(), textEditor->getDocument().getAllContent().length());
-        textEditor->moveCaretTo(endPos, false);
-       
+        const int linesToRemove = document.getNumLines() - scrollbackLines;
+
+        if (linesToRemove > 0)
+            document.deleteSection (0, CodeDocument::Position (document, linesToRemove, 0).getPosition());
+
+        //console output is never undone, so don't let the undo history grow with it
+        document.clearUndoHistory();
+
+        CodeDocument::Position endPos (document, document.getNumCharacters());
+        textEditor->moveCaretTo (endPos, false);
+    }
+
+    void setScrollbackLines (int numLines)
+    {
+        scrollbackLines = jmax (100, numLines);
     }
 
     String getText()
@@ -3,29 +3,289 @@
 #include "../Utilities/CabbageExportPlugin.h"
 #include "../CabbageCommonHeaders.h"
 #include "../Utilities/CabbageUtilities.h"
+#include <map>
 
 
-const String getPluginInfo (File csdFile, String info)
+//everything the converter needs is on the form line, so parsing stops there
+ValueTree getFormData (const String& csdText)
 {
     StringArray csdLines;
-    csdLines.addLines (csdFile.loadFileAsString());
-    
+    csdLines.addLines (csdText);
+
     for (auto line : csdLines)
     {
+        if (line.contains ("</Cabbage>"))
+            break;
+
+        if (! line.trimStart().startsWith (CabbageWidgetTypes::form))
+            continue;
+
         ValueTree temp ("temp");
         CabbageWidgetData::setWidgetState (temp, line, 0);
-        
+
         if (CabbageWidgetData::getStringProp (temp, CabbageIdentifierIds::type) == CabbageWidgetTypes::form)
+            return temp;
+    }
+
+    return {};
+}
+
+const String getPluginInfo (File csdFile, String info)
+{
+    const ValueTree form = getFormData (csdFile.loadFileAsString());
+
+    if (form.isValid())
+    {
+        if(info == "id")
+            return CabbageWidgetData::getStringProp (form, CabbageIdentifierIds::pluginid);
+        else if(info == "manufacturer")
+            return CabbageWidgetData::getStringProp (form, CabbageIdentifierIds::manufacturer);
+    }
+
+    return String();
+}
+
+//==============================================================================
+// Batch mode, for exporting a whole release in one go:
+//
+//   CLIConverter --batch=exports.txt [--threads=N] [--cache=file] [--force]
+//
+// Each line of the manifest holds the options of a single export, and relative
+// paths are taken from the current directory:
+//
+//   --export-VST3=Synths/Pad.csd --destination=Release/VST3
+//
+// Instruments are exported in parallel, but the formats of one instrument are
+// exported in turn, as they write the same csd and bundled files. An export is
+// skipped when its csd, bundled files and plugin template all hash the same as
+// at its last successful export, as recorded in the cache file, which defaults
+// to the manifest with a .cache extension.
+//==============================================================================
+struct ExportJob
+{
+    String type, pluginId, cacheKey, contentHash;
+    File csdFile, destination, exportedFile;
+    bool attempted = false, succeeded = false;
+    double milliseconds = 0;
+};
+
+String hashFileOrDirectory (const File& file)
+{
+    if (! file.isDirectory())
+        return SHA256 (file).toHexString();
+
+    Array<File> files = file.findChildFiles (File::findFiles, true);
+    files.sort();
+    String hashes;
+
+    for (auto& child : files)
+        hashes << child.getRelativePathFrom (file) << SHA256 (child).toHexString();
+
+    return SHA256 (hashes.toUTF8()).toHexString();
+}
+
+//bundled files can be large samples, so they're identified by size and date rather than hashed
+String describeBundledFiles (const File& csdFile, const String& csdText, const ValueTree& form)
+{
+    StringArray fileNames, csdLines;
+    csdLines.addLines (csdText);
+
+    for (int i = csdLines.indexOf ("<CabbageIncludes>") + 1; i > 0 && i < csdLines.size() && csdLines[i] != "</CabbageIncludes>"; i++)
+        fileNames.add (csdLines[i]);
+
+    const var bundleFiles = CabbageWidgetData::getProperty (form, CabbageIdentifierIds::bundle);
+
+    for (int i = 0; i < bundleFiles.size(); i++)
+        fileNames.add (bundleFiles[i].toString());
+
+    String description;
+
+    for (auto& fileName : fileNames)
+    {
+        const File bundledFile = csdFile.getParentDirectory().getChildFile (fileName);
+        description << fileName << bundledFile.getSize() << bundledFile.getLastModificationTime().toMilliseconds();
+
+        if (bundledFile.isDirectory())
+            for (auto& child : bundledFile.findChildFiles (File::findFiles, true))
+                description << child.getFullPathName() << child.getSize() << child.getLastModificationTime().toMilliseconds();
+    }
+
+    return description;
+}
+
+std::map<String, String> loadExportCache (const File& cacheFile)
+{
+    std::map<String, String> hashForKey;
+    StringArray lines;
+    lines.addLines (cacheFile.loadFileAsString());
+
+    for (auto& line : lines)
+        if (line.contains ("\t"))
+            hashForKey[line.fromFirstOccurrenceOf ("\t", false, false)] = line.upToFirstOccurrenceOf ("\t", false, false);
+
+    return hashForKey;
+}
+
+int runBatchExport (const ArgumentList& arguments)
+{
+    const File manifest = File::getCurrentWorkingDirectory().getChildFile (arguments.getValueForOption ("--batch").unquoted());
+    const String cacheName = arguments.getValueForOption ("--cache").unquoted();
+    const File cacheFile = cacheName.isNotEmpty() ? File::getCurrentWorkingDirectory().getChildFile (cacheName)
+                                                  : manifest.withFileExtension (".cache");
+    const bool force = arguments.containsOption ("--force");
+
+    if (! manifest.existsAsFile())
+    {
+        std::cout << "Can't find " << manifest.getFullPathName() << "\n";
+        return 1;
+    }
+
+    std::vector<ExportJob> jobs;
+    StringArray lines;
+    lines.addLines (manifest.loadFileAsString());
+
+    for (auto& line : lines)
+    {
+        if (line.trim().isEmpty() || line.trim().startsWithChar ('#'))
+            continue;
+
+        StringArray lineArguments;
+        lineArguments.addTokens (line, true);
+        lineArguments.removeEmptyStrings();
+        ExportJob job;
+
+        for (auto& argument : lineArguments)
         {
-            if(info == "id")
-                return CabbageWidgetData::getStringProp (temp, CabbageIdentifierIds::pluginid);
-            else if(info == "manufacturer")
-                return CabbageWidgetData::getStringProp (temp, CabbageIdentifierIds::manufacturer);
+            if (argument.startsWith ("--export-"))
+            {
+                job.type = argument.fromFirstOccurrenceOf ("--export-", false, false).upToFirstOccurrenceOf ("=", false, false);
+                job.csdFile = File::getCurrentWorkingDirectory().getChildFile (argument.fromFirstOccurrenceOf ("=", false, false).unquoted());
+            }
+            else if (argument.startsWith ("--destination="))
+            {
+                job.destination = File::getCurrentWorkingDirectory().getChildFile (argument.fromFirstOccurrenceOf ("=", false, false).unquoted());
+            }
         }
-        
+
+        if (job.type.isEmpty() || job.csdFile == File())
+        {
+            std::cout << "Ignoring manifest line: " << line << "\n";
+            continue;
+        }
+
+        if (job.destination == File())
+            job.destination = job.csdFile.getParentDirectory();
+
+        jobs.push_back (job);
     }
-    
-    return String();
+
+    //the work of deciding what's changed is done up front, the plugin templates are shared by many jobs
+    PluginExporter pluginExporter;
+    std::map<String, String> templateHashes;
+    std::map<String, String> cachedHashes = loadExportCache (cacheFile);
+    std::map<String, std::vector<size_t>> jobsForCsd;
+    int numSkipped = 0;
+
+    for (size_t i = 0; i < jobs.size(); i++)
+    {
+        auto& job = jobs[i];
+        String fileExtension;
+        const File pluginTemplate = pluginExporter.getPluginTemplate (job.type, fileExtension);
+        const String csdText = job.csdFile.loadFileAsString();
+        const ValueTree form = getFormData (csdText);
+
+        if (templateHashes.find (pluginTemplate.getFullPathName()) == templateHashes.end())
+            templateHashes[pluginTemplate.getFullPathName()] = pluginTemplate.exists() ? hashFileOrDirectory (pluginTemplate) : String();
+
+        job.pluginId = CabbageWidgetData::getStringProp (form, CabbageIdentifierIds::pluginid);
+        job.exportedFile = job.destination.getChildFile (job.csdFile.getFileName()).withFileExtension (fileExtension);
+        job.cacheKey = job.type + "|" + job.csdFile.getFullPathName() + "|" + job.destination.getFullPathName();
+        job.contentHash = SHA256 ((csdText + templateHashes[pluginTemplate.getFullPathName()]
+                                   + describeBundledFiles (job.csdFile, csdText, form)).toUTF8()).toHexString();
+
+        if (! force && job.exportedFile.exists() && cachedHashes[job.cacheKey] == job.contentHash)
+        {
+            std::cout << "Skipped " << job.type << " " << job.csdFile.getFileName() << ", unchanged\n";
+            numSkipped++;
+            continue;
+        }
+
+        jobsForCsd[job.csdFile.getFullPathName()].push_back (i);
+    }
+
+    const int requestedThreads = arguments.getValueForOption ("--threads").getIntValue();
+    const int numThreads = jlimit (1, jmax (1, (int) jobsForCsd.size()), requestedThreads > 0 ? requestedThreads : SystemStats::getNumCpus());
+    const double batchStart = Time::getMillisecondCounterHiRes();
+    CriticalSection outputLock;
+
+    {
+        ThreadPool pool (numThreads);
+
+        for (auto& csdJobs : jobsForCsd)
+        {
+            auto& jobIndices = csdJobs.second;
+
+            pool.addJob ([&jobs, &jobIndices, &outputLock]
+            {
+                PluginExporter exporter;
+
+                for (auto i : jobIndices)
+                {
+                    auto& job = jobs[i];
+                    job.destination.createDirectory();
+                    const Time startTime = Time::getCurrentTime();
+                    const double start = Time::getMillisecondCounterHiRes();
+#if CabbagePro
+                    exporter.exportPlugin (job.type, job.csdFile, job.pluginId, job.destination.getFullPathName(), false, true);
+#else
+                    exporter.exportPlugin (job.type, job.csdFile, job.pluginId, job.destination.getFullPathName(), false, false);
+#endif
+                    job.milliseconds = Time::getMillisecondCounterHiRes() - start;
+                    job.attempted = true;
+                    //file systems can round modification times down to the second
+                    job.succeeded = job.exportedFile.exists()
+                                    && job.exportedFile.getLastModificationTime() >= startTime - RelativeTime::seconds (2);
+
+                    const ScopedLock sl (outputLock);
+                    std::cout << (job.succeeded ? "Exported " : "Failed to export ") << job.type << " "
+                              << job.csdFile.getFileName() << " in " << roundToInt (job.milliseconds) << " ms\n";
+                }
+            });
+        }
+
+        while (pool.getNumJobs() > 0)
+            Thread::sleep (50);
+    }
+
+    int numExported = 0, numFailed = 0;
+
+    for (auto& job : jobs)
+    {
+        if (job.succeeded)
+        {
+            cachedHashes[job.cacheKey] = job.contentHash;
+            numExported++;
+        }
+        else if (job.attempted)
+        {
+            cachedHashes.erase (job.cacheKey);
+            numFailed++;
+        }
+    }
+
+    StringArray cacheLines;
+
+    for (auto& entry : cachedHashes)
+        if (entry.second.isNotEmpty())
+            cacheLines.add (entry.second + "\t" + entry.first);
+
+    cacheFile.replaceWithText (cacheLines.joinIntoString ("\n"));
+
+    std::cout << numExported << " exported, " << numSkipped << " skipped, " << numFailed << " failed in "
+              << String ((Time::getMillisecondCounterHiRes() - batchStart) / 1000.0, 1) << " s on "
+              << numThreads << " threads\n";
+
+    return numFailed > 0 ? 1 : 0;
 }
 
 int main (int argc, char* argv[])
@@ -34,9 +294,15 @@ int main (int argc, char* argv[])
     String args;
     // Your code goes here!
     juce::ignoreUnused (argc, argv);
+
+    const ArgumentList arguments (argc, argv);
+
+    if (arguments.containsOption ("--batch"))
+        return runBatchExport (arguments);
     
     std::cout << "Usage: CLIConverter --export-TYPE=\"name of csd file\" --destination=\"some absolute or relative dir\"\n";
-    std::cout << "If you leave out the destination, exports will be placed into the same folder as the csd file\n\n";
+    std::cout << "If you leave out the destination, exports will be placed into the same folder as the csd file\n";
+    std::cout << "Or: CLIConverter --batch=\"manifest\" [--threads=N] [--cache=\"file\"] [--force], with one export per manifest line\n\n";
 
     
     for( int i = 0 ; i < argc ; i++)
@@ -350,17 +350,10 @@ void CabbageLookAndFeel2::drawGroupComponentOutline(Graphics& g, int w, int h, c
 
 
     //if valid SVG file....
-    if (imgFile.existsAsFile() && imgFile.hasFileExtension(".csd") == false)
+    if (CabbageImageCache::fileExists(imgFile) && imgFile.hasFileExtension(".csd") == false)
     {
-        if (imgFile.hasFileExtension("svg"))
-            drawFromSVG(g, imgFile, 0, 0, group.getWidth(), group.getHeight(), AffineTransform());
-        else if (imgFile.hasFileExtension("png"))
-        {
-            Image image = ImageCache::getFromFile(imgFile);
-            image = image.rescaled(group.getWidth(), group.getHeight());
-            g.drawImage(image, 0, 0, group.getWidth(), group.getHeight(), 0, 0, group.getWidth(), group.getHeight());
-
-        }
+        if (imgFile.hasFileExtension("svg") || imgFile.hasFileExtension("png"))
+            CabbageImageCache::draw(g, imgFile, group.getLocalBounds(), AffineTransform(), &group);
     }
     else
     {
@@ -414,19 +407,18 @@ void CabbageLookAndFeel2::drawToggleButton(Graphics& g, ToggleButton& button, bo
     }
 
 
-    if (imgButtonOnFile.existsAsFile() && imgButtonOffFile.existsAsFile()
+    if (CabbageImageCache::fileExists(imgButtonOnFile) && CabbageImageCache::fileExists(imgButtonOffFile)
         && imgButtonOnFile.hasFileExtension(".csd") == false
         && imgButtonOffFile.hasFileExtension(".csd") == false) //if image files exist, draw them..)    //if image files exist, draw them..
     {
         if (imgButtonOnFile.hasFileExtension("png") && imgButtonOffFile.hasFileExtension("png"))
         {
-            image = ImageCache::getFromFile(File(toggleState == true ? imgButtonOnFile : imgButtonOffFile));
-            image = image.rescaled(button.getWidth(), button.getHeight());
-            g.drawImage(image, 0.f, (button.getHeight() - tickWidth) * 0.5f, button.getWidth(), tickWidth, 0, 0, button.getWidth(), button.getHeight(), false);
+            CabbageImageCache::draw(g, toggleState == true ? imgButtonOnFile : imgButtonOffFile,
+                                    Rectangle<float>(0.f, (button.getHeight() - tickWidth) * 0.5f, button.getWidth(), tickWidth).toNearestInt(), AffineTransform(), &button);
         }
         else if (imgButtonOnFile.hasFileExtension("svg") && imgButtonOffFile.hasFileExtension("svg"))
         {
-            drawFromSVG(g, toggleState == true ? imgButtonOnFile : imgButtonOffFile, 0, 0, button.getWidth(), button.getHeight(), AffineTransform());
+            drawFromSVG(g, toggleState == true ? imgButtonOnFile : imgButtonOffFile, 0, 0, button.getWidth(), button.getHeight(), AffineTransform(), &button);
         }
     }
 
@@ -568,7 +560,6 @@ void CabbageLookAndFeel2::drawRotarySlider(Graphics& g, int x, int y, int width,
         const bool isMouseOver = slider.isMouseOverOrDragging() && slider.isEnabled();
         bool useSliderBackgroundImg = false;
         bool useSliderSVG = false;
-        Image image;
         const File imgSlider(slider.getProperties().getWithDefault(CabbageIdentifierIds::imgslider, "").toString());
         const File imgSliderBackground(slider.getProperties().getWithDefault(CabbageIdentifierIds::imgsliderbg, "").toString());
 
@@ -576,17 +567,15 @@ void CabbageLookAndFeel2::drawRotarySlider(Graphics& g, int x, int y, int width,
         const float outerRadiusProportion = slider.getProperties().getWithDefault("trackerouterradius", 1);
 
         //if valid background SVG file....
-        if (imgSliderBackground.existsAsFile() && imgSliderBackground.hasFileExtension(".csd") == false)
+        if (CabbageImageCache::fileExists(imgSliderBackground) && imgSliderBackground.hasFileExtension(".csd") == false)
         {
             if (imgSliderBackground.hasFileExtension("png"))
             {
-                image = ImageCache::getFromFile(imgSliderBackground);
-                image = image.rescaled(slider.getWidth(), slider.getHeight());
-                g.drawImage(image, rx, ry, diameter, diameter, 0, 0, slider.getWidth(), slider.getHeight(), false);
+                CabbageImageCache::draw(g, imgSliderBackground, Rectangle<float>(rx, ry, diameter, diameter).toNearestInt(), AffineTransform(), &slider);
             }
             else if (imgSliderBackground.hasFileExtension("svg"))
             {
-                drawFromSVG(g, imgSliderBackground, 0, 0, slider.getWidth(), slider.getHeight(), AffineTransform());
+                drawFromSVG(g, imgSliderBackground, 0, 0, slider.getWidth(), slider.getHeight(), AffineTransform(), &slider);
             }
 
             useSliderBackgroundImg = true;
@@ -608,7 +597,7 @@ void CabbageLookAndFeel2::drawRotarySlider(Graphics& g, int x, int y, int width,
                 g.fillPath(filledArc);
             }
 
-            if (imgSlider.existsAsFile() && imgSlider.hasFileExtension(".csd") == false)
+            if (CabbageImageCache::fileExists(imgSlider) && imgSlider.hasFileExtension(".csd") == false)
             {
                 if (slider.findColour(Slider::trackColourId).getAlpha() == 0)
                     g.setColour(Colours::transparentBlack);
@@ -627,18 +616,13 @@ void CabbageLookAndFeel2::drawRotarySlider(Graphics& g, int x, int y, int width,
 
                 if (imgSlider.hasFileExtension("png"))
                 {
-                    image = ImageCache::getFromFile(imgSlider);
-                    image = image.rescaled(slider.getWidth(), slider.getHeight());
-                    std::unique_ptr<Drawable> drawable(Drawable::createFromImageFile(imgSlider));
-                    drawable->setTransformToFit(Rectangle<float>(0, 0, slider.getWidth(), slider.getWidth()), RectanglePlacement::centred);
-                    drawable->draw(g, 1.f, AffineTransform::rotation(angle,
-                        slider.getWidth() / 2, slider.getWidth() / 2));
-                    //g.drawImage(image, rx, ry, diameter, diameter, 0, 0, slider.getWidth(), slider.getHeight(), false);
+                    CabbageImageCache::draw(g, imgSlider, Rectangle<int>(slider.getWidth(), slider.getWidth()), AffineTransform::rotation(angle,
+                        slider.getWidth() / 2, slider.getWidth() / 2), &slider, RectanglePlacement::centred);
                 }
                 else if (imgSlider.hasFileExtension("svg"))
                 {
                     drawFromSVG(g, imgSlider, 0, 0, slider.getWidth(), slider.getHeight(), AffineTransform::rotation(angle,
-                        slider.getWidth() / 2, slider.getWidth() / 2));
+                        slider.getWidth() / 2, slider.getWidth() / 2), &slider);
                 }
 
                 useSliderSVG = true;
@@ -832,7 +816,7 @@ void CabbageLookAndFeel2::drawLinearSliderBackground(Graphics& g, int x, int y,
     const File imgSliderBackground(slider.getProperties().getWithDefault("imgsliderbg", "").toString());
 
     //if valid background SVG file....
-    if (imgSliderBackground.existsAsFile() && imgSliderBackground.hasFileExtension("csd") == false)
+    if (CabbageImageCache::fileExists(imgSliderBackground) && imgSliderBackground.hasFileExtension("csd") == false)
     {
         return;
     }
@@ -989,7 +973,7 @@ void CabbageLookAndFeel2::drawLinearSliderThumb(Graphics& g, int x, int y, int w
 
     const File imgSlider(slider.getProperties().getWithDefault("imgslider", "").toString());
 
-    if (imgSlider.existsAsFile() && imgSlider.hasFileExtension("csd") == false)
+    if (CabbageImageCache::fileExists(imgSlider) && imgSlider.hasFileExtension("csd") == false)
     {
         return;
     }
@@ -1064,27 +1048,20 @@ void CabbageLookAndFeel2::drawButtonBackground(Graphics& g, Button& button, cons
     File imgButtonOnFile = File(button.getProperties().getWithDefault("imgbuttonon", "").toString());
     File imgButtonOffFile = File(button.getProperties().getWithDefault("imgbuttonoff", "").toString());
     File imgButtonOverFile = File(button.getProperties().getWithDefault("imgbuttonover", "").toString());
-    if (imgButtonOverFile.existsAsFile() == false)
+    if (CabbageImageCache::fileExists(imgButtonOverFile) == false)
         imgButtonOverFile = imgButtonOffFile;
 
-    if (imgButtonOnFile.existsAsFile() && imgButtonOffFile.existsAsFile()
+    if (CabbageImageCache::fileExists(imgButtonOnFile) && CabbageImageCache::fileExists(imgButtonOffFile)
         && imgButtonOnFile.hasFileExtension(".csd") == false
         && imgButtonOffFile.hasFileExtension(".csd") == false) //if image files exist, draw them..
     {
-        if (imgButtonOnFile.hasFileExtension("png") && imgButtonOffFile.hasFileExtension("png"))
+        if ((imgButtonOnFile.hasFileExtension("png") && imgButtonOffFile.hasFileExtension("png"))
+            || (imgButtonOnFile.hasFileExtension("svg") && imgButtonOffFile.hasFileExtension("svg")))
         {
-            Image image = ImageCache::getFromFile(File(toggleState == true ? imgButtonOnFile : imgButtonOffFile));
             if (isMouseOverButton && toggleState == false)
-                image = ImageCache::getFromFile(File(imgButtonOverFile));
-            image = image.rescaled(button.getWidth(), button.getHeight());
-            g.drawImage(image, 0.0f, 0, button.getWidth(), button.getHeight(), 0, 0, button.getWidth(), button.getHeight(), false);
-        }
-        else if (imgButtonOnFile.hasFileExtension("svg") && imgButtonOffFile.hasFileExtension("svg"))
-        {
-            if (isMouseOverButton && toggleState == false)
-                drawFromSVG(g, imgButtonOverFile, 0, 0, button.getWidth(), button.getHeight(), AffineTransform());
+                CabbageImageCache::draw(g, imgButtonOverFile, button.getLocalBounds(), AffineTransform(), &button);
             else
-                drawFromSVG(g, toggleState == true ? imgButtonOnFile : imgButtonOffFile, 0, 0, button.getWidth(), button.getHeight(), AffineTransform());
+                CabbageImageCache::draw(g, toggleState == true ? imgButtonOnFile : imgButtonOffFile, button.getLocalBounds(), AffineTransform(), &button);
         }
     }
 
@@ -1219,24 +1196,11 @@ void CabbageLookAndFeel2::drawTwoValueThumb(Graphics& g, float x, float y, float
     g.strokePath(p, PathStrokeType(outlineThickness));
 }
 //if using an SVG..
-void CabbageLookAndFeel2::drawFromSVG(Graphics& g, File svgFile, int x, int y, int newWidth, int newHeight, AffineTransform affine)
+void CabbageLookAndFeel2::drawFromSVG(Graphics& g, File svgFile, int x, int y, int newWidth, int newHeight, AffineTransform affine, Component* componentToRepaint)
 {
-    if(svgFile.existsAsFile())
-    {
-        std::unique_ptr<XmlElement> svg(XmlDocument::parse(svgFile.loadFileAsString()));
-
-        if (svg == nullptr)
-            jassert(false);
-
-        std::unique_ptr<Drawable> drawable;
-
-        if (svg != nullptr)
-        {
-            drawable = Drawable::createFromSVG(*svg);
-            drawable->setTransformToFit(Rectangle<float>(x, y, newWidth, newHeight), RectanglePlacement::stretchToFit);
-            drawable->draw(g, 1.f, affine);
-        }
-    }
+    //rasterised off the message thread, nothing is drawn until it or a placeholder is ready
+    if(CabbageImageCache::fileExists(svgFile))
+        CabbageImageCache::draw(g, svgFile, Rectangle<int>(x, y, newWidth, newHeight), affine, componentToRepaint);
 }
 
 void CabbageLookAndFeel2::drawAlertBox (Graphics& g,
@@ -23,6 +23,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include "JuceHeader.h"
 #include "../CabbageCommonHeaders.h"
+#include "../Utilities/CabbageImageCache.h"
 
 inline std::unique_ptr<Drawable> createDrawableFromSVG (const char* data)
 {
@@ -96,7 +97,7 @@ public:
     void drawAlertBox (Graphics& g, AlertWindow& alert, const Rectangle<int>& textArea, TextLayout& textLayout) override;
     Image drawCheckMark(Colour colour);
 
-    static void drawFromSVG (Graphics& g, File svgFile, int x, int y, int newWidth, int newHeight, AffineTransform affine);
+    static void drawFromSVG (Graphics& g, File svgFile, int x, int y, int newWidth, int newHeight, AffineTransform affine, Component* componentToRepaint = nullptr);
 
     void drawSphericalThumb (Graphics& g, const float x, const float y, const float w, const float h, const Colour& colour, const float outlineThickness);
 
@@ -136,8 +137,8 @@ public:
 //    Font getPopupMenuFont() override;
 //    Font getMenuBarFont (MenuBarComponent&, int itemIndex, const String& itemText) override;
 private:
-
-    
+    //keeps decoded images alive for as long as any editor is open
+    SharedResourcePointer<CabbageImageCache> imageCache;
 
 };
 
@@ -75,9 +75,12 @@ void CabbageSettings::setDefaultSettings()
     defaultPropSet->setValue ("CabbageManualDir", cabbageHelp);
     defaultPropSet->setValue ("CabbagePlantDir", homeDir + "/Plants");
     defaultPropSet->setValue ("CompileOnSave", 1);
+    defaultPropSet->setValue ("ConsoleScrollbackLines", 5000);
     defaultPropSet->setValue ("CsoundManualDir", manualPath);
     defaultPropSet->setValue ("CustomThemeDir", themePath);
+    defaultPropSet->setValue ("ParallelGraphProcessing", 1);
     defaultPropSet->setValue ("DisableAutoComplete", 0);
+    defaultPropSet->setValue ("EnableTracing", 0);
     defaultPropSet->setValue ("DisableCompilerErrorWarning", 0);
     defaultPropSet->setValue ("DisableCabbageTagsWarning", 0);
     defaultPropSet->setValue ("DisablePluginIdWarning", 0);
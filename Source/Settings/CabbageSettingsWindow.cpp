@@ -328,6 +328,12 @@ void CabbageSettingsWindow::addMiscProperties()
 #endif
     //editorProps.add (new BooleanPropertyComponent (compileOnSaveValue, "Compiling", "Compile on save"));
     editorProps.add (new BooleanPropertyComponent (autoCompleteValue, "Auto-complete", "Show auto complete popup"));
+#if Cabbage_Trace
+    tracingValue.setValue (settings.getUserSettings()->getIntValue ("EnableTracing"));
+    tracingValue.addListener (this);
+    randProps.add (new BooleanPropertyComponent (tracingValue, "Tracing", "Record a timeline of the audio and GUI threads"));
+    randProps.add (new WriteTraceButtonProperty());
+#endif
 	randProps.add(new ButtonProperty("Reset don't show again preferences", settings));
 
     const int scrollBy = settings.getUserSettings()->getIntValue ("numberOfLinesToScroll");
@@ -465,6 +471,11 @@ void CabbageSettingsWindow::valueChanged (Value& value)
         settings.getUserSettings()->setValue ("performAdHocCodesign", value.getValue().toString());
 	else if (value.refersToSameSourceAs(UDPPortValue)) 
 		settings.getUserSettings()->setValue ("UDP Port", value.getValue().toString());
+    else if (value.refersToSameSourceAs (tracingValue))
+    {
+        settings.getUserSettings()->setValue ("EnableTracing", value.getValue().toString());
+        CabbageTrace::setEnabled (value.getValue());
+    }
 }
 
 void CabbageSettingsWindow::filenameComponentChanged (FilenameComponent* fileComponent)
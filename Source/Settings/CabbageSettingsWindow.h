@@ -25,6 +25,7 @@
 #include "../Utilities/CabbageColourProperty.h"
 #include "../Utilities/CabbageFilePropertyComponent.h"
 #include "../Utilities/CabbageUtilities.h"
+#include "../Utilities/CabbageTrace.h"
 #include "../BinaryData/CabbageBinaryData.h"
 #include "../CodeEditor/CsoundTokeniser.h"
 #include "../LookAndFeel/PropertyPanelLookAndFeel.h"
@@ -133,6 +134,27 @@ public:
 		String text;
 	};
 
+    //saves what has been traced so far, see CabbageTrace
+    class WriteTraceButtonProperty : public ButtonPropertyComponent
+    {
+    public:
+        WriteTraceButtonProperty() : ButtonPropertyComponent ("Trace file", true) {}
+
+        String getButtonText() const override
+        {
+            return "Write trace file";
+        }
+
+        void buttonClicked() override
+        {
+            const File traceFile = File::getSpecialLocation (File::userDocumentsDirectory)
+                                       .getNonexistentChildFile ("CabbageTrace", ".json");
+
+            if (CabbageTrace::writeChromeTrace (traceFile))
+                traceFile.revealToUser();
+        }
+    };
+
 private:
     PropertyPanel colourPanel, miscPanel;
     std::unique_ptr<PropertyPanelLookAndFeel> propertyPanelLook;
@@ -145,7 +167,7 @@ private:
     ImageButton audioSettingsButton, colourSettingsButton, miscSettingsButton, codeRepoButton;
 
 	Value alwaysOnTopPluginValue, resetNotifications, autoConnectNodes, alwaysOnTopGraphValue, UDPPortValue, recordingBitDepth,
-    showLastOpenedFileValue, compileOnSaveValue, breakLinesValue, autoCompleteValue, enableKioskMode, adhocSigningValue;
+    showLastOpenedFileValue, compileOnSaveValue, breakLinesValue, autoCompleteValue, enableKioskMode, adhocSigningValue, tracingValue;
     Viewport viewport;
 
 };
@@ -0,0 +1,197 @@
+/*
+  Copyright (C) 2016 Rory Walsh
+
+  Cabbage is free software; you can redistribute it
+  and/or modify it under the terms of the GNU General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  Cabbage is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public
+  License along with Csound; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+  02111-1307 USA
+*/
+
+#include "CabbageCompileChecker.h"
+#include "CabbageUtilities.h"
+#include "../Audio/Plugins/CabbagePluginProcessor.h"
+#include "../Audio/Plugins/GenericCabbagePluginProcessor.h"
+
+static MemoryBlock valueTreeToMemoryBlock (const ValueTree& tree)
+{
+    MemoryOutputStream data;
+    tree.writeToStream (data);
+    return data.getMemoryBlock();
+}
+
+//==============================================================================
+String CabbageCompileChecker::Diagnostics::getSummary() const
+{
+    String summary;
+
+    if (crashed)
+        summary << "Csound crashed while " << (compileFinished ? "running" : "compiling") << " this instrument. It has not been started.\n";
+    else if (timedOut)
+        summary << "Compile check timed out after " << cyclesRun << " k-cycles.\n";
+
+    for (const auto& error : errors)
+        summary << error << "\n";
+
+    summary << "Compile: " << String (compileMs, 1) << " ms, " << cyclesRun << " k-cycles: " << String (performMs, 1) << " ms\n";
+    return summary;
+}
+
+//==============================================================================
+CabbageCompileChecker::~CabbageCompileChecker()
+{
+    killWorkerProcess();
+}
+
+bool CabbageCompileChecker::launchWorkerIfNeeded()
+{
+    if (! workerIsRunning)
+        workerIsRunning = launchWorkerProcess (File::getSpecialLocation (File::currentExecutableFile), commandLineUID, 0, 0);
+
+    return workerIsRunning;
+}
+
+CabbageCompileChecker::Diagnostics CabbageCompileChecker::check (const File& csdFile, int numCycles, int timeoutMs)
+{
+    //if the worker can't be started there is nothing to test with, so let the file through
+    if (! launchWorkerIfNeeded())
+        return {};
+
+    {
+        const ScopedLock sl (resultLock);
+        currentResult = {};
+    }
+
+    resultReceived.reset();
+
+    ValueTree request ("CompileCheck");
+    request.setProperty ("file", csdFile.getFullPathName(), nullptr);
+    request.setProperty ("cycles", numCycles, nullptr);
+
+    const bool finished = sendMessageToWorker (valueTreeToMemoryBlock (request)) && resultReceived.wait (timeoutMs);
+
+    Diagnostics result;
+
+    {
+        const ScopedLock sl (resultLock);
+        result = currentResult;
+    }
+
+    if (! finished && ! result.crashed)
+    {
+        //most likely stuck in a perf-time loop or still compiling. Its reply can't be matched
+        //to a later check, so it is replaced, and the new worker starts up while the IDE runs
+        result.timedOut = true;
+        killWorkerProcess();
+        workerIsRunning = false;
+        launchWorkerIfNeeded();
+    }
+
+    StringArray lines;
+    lines.addLines (result.output);
+
+    for (const auto& line : lines)
+        if (line.containsIgnoreCase ("error"))
+            result.errors.add (line.trim());
+
+    result.passed = ! result.crashed;
+    return result;
+}
+
+void CabbageCompileChecker::handleMessageFromWorker (const MemoryBlock& message)
+{
+    const ValueTree reply = ValueTree::readFromData (message.getData(), message.getSize());
+    bool isFinished = false;
+
+    {
+        const ScopedLock sl (resultLock);
+        currentResult.output << reply.getProperty ("output").toString();
+
+        if (reply.hasType ("Compiled"))
+        {
+            currentResult.compileFinished = true;
+            currentResult.compileResult = reply.getProperty ("compileResult");
+            currentResult.compileMs = reply.getProperty ("compileMs");
+        }
+        else if (reply.hasType ("Finished"))
+        {
+            currentResult.cyclesRun = reply.getProperty ("cyclesRun");
+            currentResult.performMs = reply.getProperty ("performMs");
+            isFinished = true;
+        }
+    }
+
+    if (isFinished)
+        resultReceived.signal();
+}
+
+void CabbageCompileChecker::handleConnectionLost()
+{
+    {
+        const ScopedLock sl (resultLock);
+        currentResult.crashed = true;
+    }
+
+    workerIsRunning = false;
+    resultReceived.signal();
+}
+
+//==============================================================================
+void CabbageCompileCheckWorker::handleMessageFromCoordinator (const MemoryBlock& message)
+{
+    const ValueTree request = ValueTree::readFromData (message.getData(), message.getSize());
+
+    //processors are created on the message thread, just as they are in the IDE
+    MessageManager::callAsync ([this, request]
+    {
+        const File csdFile (request.getProperty ("file").toString());
+        const int numCycles = request.getProperty ("cycles", 16);
+        const auto busesProperties = CabbagePluginProcessor::readBusesPropertiesFromXml (csdFile);
+        std::unique_ptr<CsoundPluginProcessor> processor;
+
+        double startTime = Time::getMillisecondCounterHiRes();
+
+        if (CabbageUtilities::hasCabbageTags (csdFile))
+            processor.reset (new CabbagePluginProcessor (csdFile, busesProperties));
+        else
+            processor.reset (new GenericCabbagePluginProcessor (csdFile, busesProperties));
+
+        ValueTree compiled ("Compiled");
+        compiled.setProperty ("compileResult", processor->csdCompiledWithoutError() ? 0 : 1, nullptr);
+        compiled.setProperty ("compileMs", Time::getMillisecondCounterHiRes() - startTime, nullptr);
+        compiled.setProperty ("output", processor->getCsoundOutput(), nullptr);
+        sendResult (compiled);
+
+        int cyclesRun = 0;
+        startTime = Time::getMillisecondCounterHiRes();
+
+        if (processor->csdCompiledWithoutError())
+            while (cyclesRun < numCycles && processor->getCsound()->PerformKsmps() == 0)
+                ++cyclesRun;
+
+        ValueTree finished ("Finished");
+        finished.setProperty ("cyclesRun", cyclesRun, nullptr);
+        finished.setProperty ("performMs", Time::getMillisecondCounterHiRes() - startTime, nullptr);
+        finished.setProperty ("output", processor->getCsoundOutput(), nullptr);
+        sendResult (finished);
+    });
+}
+
+void CabbageCompileCheckWorker::handleConnectionLost()
+{
+    JUCEApplication::quit();
+}
+
+void CabbageCompileCheckWorker::sendResult (const ValueTree& result)
+{
+    sendMessageToCoordinator (valueTreeToMemoryBlock (result));
+}
@@ -0,0 +1,93 @@
+/*
+  Copyright (C) 2016 Rory Walsh
+
+  Cabbage is free software; you can redistribute it
+  and/or modify it under the terms of the GNU General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  Cabbage is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public
+  License along with Csound; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+  02111-1307 USA
+*/
+
+#ifndef CABBAGECOMPILECHECKER_H_INCLUDED
+#define CABBAGECOMPILECHECKER_H_INCLUDED
+
+#include "JuceHeader.h"
+
+//==============================================================================
+// Tests instruments for crashes before they are loaded into the IDE's graph.
+// A second instance of Cabbage is launched once as a resident worker, and each
+// check asks it to compile a file and run a number of k-cycles. If Csound takes
+// the worker down, the crash is reported and a new worker is launched on the
+// next check.
+//==============================================================================
+class CabbageCompileChecker : private ChildProcessCoordinator
+{
+public:
+    struct Diagnostics
+    {
+        bool passed = true;
+        bool crashed = false;
+        bool timedOut = false;
+        bool compileFinished = false;
+        int compileResult = 0;
+        int cyclesRun = 0;
+        double compileMs = 0;
+        double performMs = 0;
+        StringArray errors;
+        String output;
+
+        String getSummary() const;
+    };
+
+    CabbageCompileChecker() = default;
+    ~CabbageCompileChecker() override;
+
+    //blocks the message thread until the worker replies, crashes, or timeoutMs has passed,
+    //so the default keeps the 400 ms bound of the old one-off csound check. A check that
+    //times out still passes, as only i-time errors and crashes can be detected here
+    Diagnostics check (const File& csdFile, int numCycles = 16, int timeoutMs = 400);
+
+    //starts the worker ahead of the first check, so its start-up isn't spent inside the timeout
+    void launchWorker()     {   launchWorkerIfNeeded();   }
+
+    static constexpr const char* commandLineUID = "cabbageCompileCheck";
+
+private:
+    bool launchWorkerIfNeeded();
+    void handleMessageFromWorker (const MemoryBlock& message) override;
+    void handleConnectionLost() override;
+
+    std::atomic<bool> workerIsRunning { false };
+    WaitableEvent resultReceived;
+    CriticalSection resultLock;
+    Diagnostics currentResult;
+
+    JUCE_DECLARE_NON_COPYABLE (CabbageCompileChecker)
+};
+
+//==============================================================================
+// Runs inside the worker process, see Cabbage::initialise()
+class CabbageCompileCheckWorker : public ChildProcessWorker
+{
+public:
+    CabbageCompileCheckWorker() = default;
+
+    void handleMessageFromCoordinator (const MemoryBlock& message) override;
+    void handleConnectionLost() override;
+
+private:
+    void sendResult (const ValueTree& result);
+
+    JUCE_DECLARE_NON_COPYABLE (CabbageCompileCheckWorker)
+};
+
+#endif  // CABBAGECOMPILECHECKER_H_INCLUDED
@@ -9,7 +9,17 @@
  */
 
 #include "CabbageExportPlugin.h"
-#include <fstream>
+#include <iostream>
+
+#if JUCE_LINUX
+ #include <fcntl.h>
+ #include <unistd.h>
+ #include <sys/ioctl.h>
+ #include <sys/stat.h>
+ #include <linux/fs.h>
+#elif JUCE_MAC
+ #include <sys/clonefile.h>
+#endif
 
 //===============   methods for exporting plugins ==============================
 void PluginExporter::exportPlugin (String type, File csdFile, String pluginId, String destination, bool promptForFilename, bool encrypt)
@@ -23,108 +33,12 @@ void PluginExporter::exportPlugin (String type, File csdFile, String pluginId, S
     if(csdFile.existsAsFile())
     {
         
-        String pluginFilename, fileExtension;
-        File thisFile = File::getSpecialLocation (File::currentApplicationFile);
-#if defined(JUCE_LINUX)	
-        String currentApplicationDirectory = "/usr/bin";
-#else
-        String currentApplicationDirectory = thisFile.getParentDirectory().getFullPathName();
-#endif
-        
-        
-        if (CabbageUtilities::getTargetPlatform() == CabbageUtilities::TargetPlatformTypes::Linux)
-        {
-            if(type == "Standalone")
-                fileExtension = "";
-            else
-                fileExtension = "so";
-        }
-        else if (CabbageUtilities::getTargetPlatform() == CabbageUtilities::TargetPlatformTypes::OSX)
-        {
-            if(type == "Standalone")
-                fileExtension = "app";
-            else if(type.contains("VST3"))
-                fileExtension = "vst3";
-            else if(type.contains("VST"))
-                fileExtension = "vst";
-            else
-                fileExtension = "component";
-            
-            currentApplicationDirectory = thisFile.getFullPathName() + "/Contents";
-        }
-        else
-        {
-            if(type == "Standalone")
-                fileExtension = "exe";
-            else if(type.contains("VST3"))
-                fileExtension = "vst3";
-            else
-                fileExtension = "dll";
-        }
-        
-// #if CabbagePro && JUCE_MAC
-//         const String pluginDesc = String(JucePlugin_Manufacturer);
-// #else
-        const String pluginDesc = String(PluginDesc);
-// #endifs
-
-#ifdef JUCE_LINUX
-    if(type == "VST3i")
-        currentApplicationDirectory = currentApplicationDirectory+"/CabbagePluginSynth.vst3/Contents/x86_64-linux";
-    else if(type == "VST3")
-        currentApplicationDirectory = currentApplicationDirectory+"/CabbagePluginEffect.vst3/Contents/x86_64-linux";
-#endif
-
-        if (type == "VSTi" || type == "AUi" || type == "VST3i")
-            pluginFilename = currentApplicationDirectory + String ("/"+pluginDesc.replace(" ", "_")+"Synth." + fileExtension);
-        else  if (type == "VST" || type == "AU" || type == "VST3")
-            pluginFilename = currentApplicationDirectory + String ("/"+pluginDesc.replace(" ", "_")+"Effect." + fileExtension);
-        else  if (type == "AUMIDIFx")
-            pluginFilename = currentApplicationDirectory + String ("/"+pluginDesc.replace(" ", "_")+"MidiEffect." + fileExtension);
-        else if (type.contains (String ("LV2-ins")))
-            pluginFilename = currentApplicationDirectory + String ("/"+pluginDesc.replace(" ", "_")+"SynthLV2." + fileExtension);
-        else if (type.contains (String ("LV2-fx")))
-            pluginFilename = currentApplicationDirectory + String ("/"+pluginDesc.replace(" ", "_")+"EffectLV2." + fileExtension);
-        else if (type == "VCVRack")
-        {
-            fileExtension = "";
-            pluginFilename = currentApplicationDirectory+"/CabbageRack/";
-            if(!File(pluginFilename).exists())
-                pluginFilename = File::getSpecialLocation (File::currentApplicationFile).getParentDirectory().getFullPathName()+"/CabbageRack/";
-        }
-		else if (type == "Unity")
-		{
-			fileExtension = ((CabbageUtilities::getTargetPlatform() == CabbageUtilities::TargetPlatformTypes::OSX) ? String("bundle") : String("dll"));
-			pluginFilename = currentApplicationDirectory + ((CabbageUtilities::getTargetPlatform() == CabbageUtilities::TargetPlatformTypes::OSX) ? String("/AudioPluginDemo.bundle") : String("/AudioPluginDemo.dll"));
-		}
-        else if (type == "FMOD")
-        {
-            fileExtension = ((CabbageUtilities::getTargetPlatform() == CabbageUtilities::TargetPlatformTypes::OSX) ? String("bundle") : String("dll"));
-            pluginFilename = currentApplicationDirectory + ((CabbageUtilities::getTargetPlatform() == CabbageUtilities::TargetPlatformTypes::OSX) ? String("/fmod_csound.dylib") : String("/fmod_csound64.dll"));
-        }
-        else if (type == "FMODFx")
-        {
-            fileExtension = ((CabbageUtilities::getTargetPlatform() == CabbageUtilities::TargetPlatformTypes::OSX) ? String("bundle") : String("dll"));
-            pluginFilename = currentApplicationDirectory + ((CabbageUtilities::getTargetPlatform() == CabbageUtilities::TargetPlatformTypes::OSX) ? String("/fmod_csound_fx.dylib") : String("/fmod_csound64_fx.dll"));
-            
-        }
-        else  if (type == "Standalone")
-        {
-            if (CabbageUtilities::getTargetPlatform() == CabbageUtilities::TargetPlatformTypes::Linux)
-                pluginFilename = currentApplicationDirectory + "/" + pluginDesc;
-            else
-                pluginFilename = currentApplicationDirectory + "/" + pluginDesc + "." + fileExtension;
-        }
-        
-#if !CLIConverter
-        File VSTData (pluginFilename);
-#else
-        File VSTData (pluginFilename.replace("/CLIConverter/Contents", ""));
-#endif
+        String fileExtension;
+        File VSTData = getPluginTemplate (type, fileExtension);
         
         if (!VSTData.exists())
         {
-            CabbageUtilities::showMessage("Error", pluginFilename + " cannot be found? It should be in the Cabbage root folder", &lookAndFeel);
+            reportExportError (VSTData.getFullPathName() + " cannot be found? It should be in the Cabbage root folder");
             return;
         }
         
@@ -191,6 +105,111 @@ void PluginExporter::exportPlugin (String type, File csdFile, String pluginId, S
 }
 
 
+//==============================================================================
+// The prebuilt Cabbage binary that's copied and patched to make an export of the given type
+//==============================================================================
+File PluginExporter::getPluginTemplate (const String& type, String& fileExtension)
+{
+    String pluginFilename;
+    File thisFile = File::getSpecialLocation (File::currentApplicationFile);
+#if defined(JUCE_LINUX)	
+    String currentApplicationDirectory = "/usr/bin";
+#else
+    String currentApplicationDirectory = thisFile.getParentDirectory().getFullPathName();
+#endif
+    
+    
+    if (CabbageUtilities::getTargetPlatform() == CabbageUtilities::TargetPlatformTypes::Linux)
+    {
+        if(type == "Standalone")
+            fileExtension = "";
+        else
+            fileExtension = "so";
+    }
+    else if (CabbageUtilities::getTargetPlatform() == CabbageUtilities::TargetPlatformTypes::OSX)
+    {
+        if(type == "Standalone")
+            fileExtension = "app";
+        else if(type.contains("VST3"))
+            fileExtension = "vst3";
+        else if(type.contains("VST"))
+            fileExtension = "vst";
+        else
+            fileExtension = "component";
+        
+        currentApplicationDirectory = thisFile.getFullPathName() + "/Contents";
+    }
+    else
+    {
+        if(type == "Standalone")
+            fileExtension = "exe";
+        else if(type.contains("VST3"))
+            fileExtension = "vst3";
+        else
+            fileExtension = "dll";
+    }
+    
+// #if CabbagePro && JUCE_MAC
+//         const String pluginDesc = String(JucePlugin_Manufacturer);
+// #else
+    const String pluginDesc = String(PluginDesc);
+// #endifs
+
+#ifdef JUCE_LINUX
+    if(type == "VST3i")
+        currentApplicationDirectory = currentApplicationDirectory+"/CabbagePluginSynth.vst3/Contents/x86_64-linux";
+    else if(type == "VST3")
+        currentApplicationDirectory = currentApplicationDirectory+"/CabbagePluginEffect.vst3/Contents/x86_64-linux";
+#endif
+
+    if (type == "VSTi" || type == "AUi" || type == "VST3i")
+        pluginFilename = currentApplicationDirectory + String ("/"+pluginDesc.replace(" ", "_")+"Synth." + fileExtension);
+    else  if (type == "VST" || type == "AU" || type == "VST3")
+        pluginFilename = currentApplicationDirectory + String ("/"+pluginDesc.replace(" ", "_")+"Effect." + fileExtension);
+    else  if (type == "AUMIDIFx")
+        pluginFilename = currentApplicationDirectory + String ("/"+pluginDesc.replace(" ", "_")+"MidiEffect." + fileExtension);
+    else if (type.contains (String ("LV2-ins")))
+        pluginFilename = currentApplicationDirectory + String ("/"+pluginDesc.replace(" ", "_")+"SynthLV2." + fileExtension);
+    else if (type.contains (String ("LV2-fx")))
+        pluginFilename = currentApplicationDirectory + String ("/"+pluginDesc.replace(" ", "_")+"EffectLV2." + fileExtension);
+    else if (type == "VCVRack")
+    {
+        fileExtension = "";
+        pluginFilename = currentApplicationDirectory+"/CabbageRack/";
+        if(!File(pluginFilename).exists())
+            pluginFilename = File::getSpecialLocation (File::currentApplicationFile).getParentDirectory().getFullPathName()+"/CabbageRack/";
+    }
+		else if (type == "Unity")
+		{
+			fileExtension = ((CabbageUtilities::getTargetPlatform() == CabbageUtilities::TargetPlatformTypes::OSX) ? String("bundle") : String("dll"));
+			pluginFilename = currentApplicationDirectory + ((CabbageUtilities::getTargetPlatform() == CabbageUtilities::TargetPlatformTypes::OSX) ? String("/AudioPluginDemo.bundle") : String("/AudioPluginDemo.dll"));
+		}
+    else if (type == "FMOD")
+    {
+        fileExtension = ((CabbageUtilities::getTargetPlatform() == CabbageUtilities::TargetPlatformTypes::OSX) ? String("bundle") : String("dll"));
+        pluginFilename = currentApplicationDirectory + ((CabbageUtilities::getTargetPlatform() == CabbageUtilities::TargetPlatformTypes::OSX) ? String("/fmod_csound.dylib") : String("/fmod_csound64.dll"));
+    }
+    else if (type == "FMODFx")
+    {
+        fileExtension = ((CabbageUtilities::getTargetPlatform() == CabbageUtilities::TargetPlatformTypes::OSX) ? String("bundle") : String("dll"));
+        pluginFilename = currentApplicationDirectory + ((CabbageUtilities::getTargetPlatform() == CabbageUtilities::TargetPlatformTypes::OSX) ? String("/fmod_csound_fx.dylib") : String("/fmod_csound64_fx.dll"));
+        
+    }
+    else  if (type == "Standalone")
+    {
+        if (CabbageUtilities::getTargetPlatform() == CabbageUtilities::TargetPlatformTypes::Linux)
+            pluginFilename = currentApplicationDirectory + "/" + pluginDesc;
+        else
+            pluginFilename = currentApplicationDirectory + "/" + pluginDesc + "." + fileExtension;
+    }
+    
+#if !CLIConverter
+    return File (pluginFilename);
+#else
+    return File (pluginFilename.replace("/CLIConverter/Contents", ""));
+#endif
+}
+
 void PluginExporter::writePluginFileToDisk (File fc, File csdFile, File VSTData, String fileExtension, String pluginId, String type,  bool encrypt)
 {
     
@@ -234,6 +253,18 @@ void PluginExporter::writePluginFileToDisk (File fc, File csdFile, File VSTData,
         
         return;
     }
+
+    //the ID is patched into the binary below, so it has to be settled before anything is copied
+    if(pluginId.isEmpty())
+    {
+        reportExportError ("The plugin ID identifier in " + csdFile.getFullPathName() + " is empty, or the pluginid identifier string contains a typo. Certain hosts may not recognise your plugin. Please use a unique ID for each plugin.");
+        pluginId = "Cab2";
+    }
+    else if (pluginId.getNumBytesAsUTF8() != 4)
+    {
+        reportExportError ("Exporting: " + csdFile.getFullPathName() + ", the plugin ID must be four characters.");
+        return;
+    }
     
     //plugin files on OSX are bundles, so we need to recursively delete all files in bundle
     if (CabbageUtilities::getTargetPlatform() == CabbageUtilities::TargetPlatformTypes::OSX)
@@ -251,7 +282,11 @@ void PluginExporter::writePluginFileToDisk (File fc, File csdFile, File VSTData,
 
     auto mkdir = "mkdir " + exportedPlugin.getParentDirectory().getFullPathName().toStdString();
     system(mkdir.c_str());
+   #if JUCE_LINUX
+    auto command = "cp -Rf --reflink=auto " + VSTData.getFullPathName().toStdString() + " " +exportedPlugin.getFullPathName().toStdString();
+   #else
     auto command = "cp -Rf " + VSTData.getFullPathName().toStdString() + " " +exportedPlugin.getFullPathName().toStdString();
+   #endif
     system(command.c_str());
     
 #else
@@ -260,7 +295,7 @@ void PluginExporter::writePluginFileToDisk (File fc, File csdFile, File VSTData,
 
         Logger::writeToLog("Could not create plugin file. Check write access");
 
-        CabbageUtilities::showMessage ("Error", "Exporting: " + csdFile.getFullPathName() + ", Can't copy plugin to this location. It currently be in use, or you may be trying to install to a system folder you don't have permission to write in. Please try exporting to a different location.", &lookAndFeel);
+        reportExportError ("Exporting: " + csdFile.getFullPathName() + ", Can't copy plugin to this location. It currently be in use, or you may be trying to install to a system folder you don't have permission to write in. Please try exporting to a different location.");
 
         return;
     }
@@ -306,7 +341,11 @@ void PluginExporter::writePluginFileToDisk (File fc, File csdFile, File VSTData,
             else
                   bin = File(exportedPlugin.getFullPathName() + String ("/Contents/MacOS/"+pluginDesc));
             
-            setUniquePluginId (bin, exportedCsdFile, pluginId);
+            if (! setUniquePluginId (bin, exportedCsdFile, pluginId))
+            {
+                exportedPlugin.deleteRecursively();
+                return;
+            }
             
             File pl (exportedPlugin.getFullPathName() + String ("/Contents/Info.plist"));
             String newPList = pl.loadFileAsString();
@@ -317,7 +356,7 @@ void PluginExporter::writePluginFileToDisk (File fc, File csdFile, File VSTData,
                 File pluginBinary (exportedPlugin.getFullPathName() + String ("/Contents/MacOS/") + fc.getFileNameWithoutExtension());
 
                 if (bin.moveFileTo (pluginBinary) == false)
-                    CabbageUtilities::showMessage ("Error", "Could not copy library binary file. Make sure the two Cabbage .vst files are located in the Cabbage.app folder", &lookAndFeel);
+                    reportExportError ("Could not copy library binary file. Make sure the two Cabbage .vst files are located in the Cabbage.app folder");
 
 #if CabbagePro
                 newPList = newPList.replace (pluginDesc+"Effect", fc.getFileNameWithoutExtension());
@@ -355,12 +394,6 @@ void PluginExporter::writePluginFileToDisk (File fc, File csdFile, File VSTData,
             
 #endif
             newPList = newPList.replace (toReplace, pluginName);
-            if(pluginId.isEmpty())
-            {
-                CabbageUtilities::showMessage ("Error", "The plugin ID identifier in " + csdFile.getFullPathName() + " is empty, or the pluginid identifier string contains a typo. Certain hosts may not recognise your plugin. Please use a unique ID for each plugin.", &lookAndFeel);
-                pluginId = "Cab2";
-            }
-            
             const String auId = "<string>" + pluginId + "</string>";
             newPList = newPList.replace ("<string>RORY</string>", auId);
             
@@ -383,7 +416,13 @@ void PluginExporter::writePluginFileToDisk (File fc, File csdFile, File VSTData,
         else
             exportedCsdFile.replaceWithText (csdFile.loadFileAsString());
 
-        setUniquePluginId(exportedPlugin, exportedCsdFile, pluginId);
+        if (! setUniquePluginId (exportedPlugin, exportedCsdFile, pluginId))
+        {
+            exportedPlugin.deleteFile();
+            exportedCsdFile.deleteFile();
+            return;
+        }
+
         addFilesToPluginBundle(csdFile, exportedPlugin);
     }
             
@@ -392,56 +431,95 @@ void PluginExporter::writePluginFileToDisk (File fc, File csdFile, File VSTData,
 //==============================================================================
 // Set unique plugin ID for each plugin based on the file name
 //==============================================================================
-int PluginExporter::setUniquePluginId (File binFile, File csdFile, String pluginId)
+bool PluginExporter::setUniquePluginId (File binFile, File csdFile, String pluginId)
 {
-    size_t file_size;
-    //both mac and Windows encode the plugin IDs differently, so we run through a loop of both possibilities..
-    const char* pluginIDToReplace[] = { "RORY", "YROR" };
-    
-    long loc;
-    std::fstream mFile (binFile.getFullPathName().toUTF8(), std::ios_base::in | std::ios_base::out | std::ios_base::binary);
-    
-    for(int i = 0 ; i < 2 ; i++)
+    //the ID is written over a four byte marker, anything longer or shorter would corrupt the binary
+    if (pluginId.getNumBytesAsUTF8() != 4)
     {
-        if (mFile.is_open())
+        reportExportError ("Exporting: " + csdFile.getFullPathName() + ", the plugin ID must be four characters.");
+        return false;
+    }
+
+    //patched in place through a shared mapping, so the binary is never read into memory
+    MemoryMappedFile mappedFile (binFile, MemoryMappedFile::readWrite);
+
+    if (mappedFile.getData() == nullptr)
+    {
+        reportExportError ("Exporting: " + csdFile.getFullPathName() + ", " + binFile.getFullPathName() + " could not be opened to set the plugin ID.");
+        return false;
+    }
+
+    int numExpected = 0;
+    const int numReplaced = replacePluginIdMarkers ((uint8*) mappedFile.getData(), mappedFile.getSize(), pluginId.toRawUTF8(), numExpected);
+
+    //markers that overlap can't all be replaced, and a binary like that can't be trusted to load with the new ID
+    if (numExpected == 0 || numReplaced != numExpected)
+    {
+        reportExportError ("Exporting: " + csdFile.getFullPathName() + ", expected to set the plugin ID in " + String (numExpected)
+                           + " places in " + binFile.getFullPathName() + " but set it in " + String (numReplaced) + ". The plugin template may be damaged or already exported.");
+        return false;
+    }
+
+    return true;
+}
+
+void PluginExporter::reportExportError (const String& message)
+{
+    Logger::writeToLog (message);
+#if CLIConverter
+    std::cerr << message << "\n";
+#else
+    CabbageUtilities::showMessage ("Error", message, &lookAndFeel);
+#endif
+}
+
+int PluginExporter::replacePluginIdMarkers (uint8* data, size_t size, const char* pluginId, int& numFound)
+{
+    //both mac and Windows encode the plugin IDs differently, so both byte orders are found in the one scan.
+    //Each has an R in its first two bytes, and memchr is vectorised in every libc, so only those are checked
+    std::vector<size_t> forwardMarkers, reversedMarkers;
+
+    for (auto* r = (uint8*) memchr (data, 'R', size); r != nullptr; r = (uint8*) memchr (r + 1, 'R', size - (size_t) (r + 1 - data)))
+    {
+        const size_t position = (size_t) (r - data);
+
+        if (position + 4 <= size && memcmp (r, "RORY", 4) == 0)
+            forwardMarkers.push_back (position);
+
+        if (position >= 1 && position + 3 <= size && memcmp (r - 1, "YROR", 4) == 0)
+            reversedMarkers.push_back (position - 1);
+    }
+
+    numFound = (int) (forwardMarkers.size() + reversedMarkers.size());
+    int numReplaced = 0;
+
+    for (auto position : forwardMarkers)
+    {
+        memcpy (data + position, pluginId, 4);
+        ++numReplaced;
+    }
+
+    //a reversed marker overlapping one just replaced is no longer a marker
+    for (auto position : reversedMarkers)
+    {
+        if (memcmp (data + position, "YROR", 4) == 0)
         {
-            mFile.seekg (0, std::ios::end);
-            file_size = mFile.tellg();
-            unsigned char* buffer = (unsigned char*)malloc (sizeof (unsigned char) * file_size);
-            
-            //set plugin ID, do this a few times in case the plugin ID appear in more than one place.
-            for (int r = 0; r < 10; r++)
-            {
-                mFile.seekg (0, std::ios::beg);
-                mFile.read ((char*)&buffer[0], file_size);
-                loc = cabbageFindPluginId (buffer, file_size, pluginIDToReplace[i]);
-                
-                if (loc < 0)
-                {
-                    break;
-                }
-                else
-                {
-                    mFile.seekg (loc, std::ios::beg);
-                    mFile.write (pluginId.toUTF8(), 4);
-                }
-            }
-            
-            free (buffer);
-            
+            memcpy (data + position, pluginId, 4);
+            ++numReplaced;
         }
-        else
-            DBG ("===============================\nError/n=======================================\n" + csdFile.getFullPathName()+" File could not be opened");
     }
-    mFile.close();
-    
-    return 1;
+
+    return numReplaced;
 }
 //==============================================================================
 // Bundles files with VST
 //==============================================================================
 void PluginExporter::addFilesToPluginBundle (File csdFile, File exportDir)
 {
+    //batch exports run in parallel, and instruments exported to the same folder often bundle the same files
+    static CriticalSection bundleLock;
+    const ScopedLock sl (bundleLock);
+
     StringArray invalidFiles;
     StringArray csdArray;
     csdArray.addLines (csdFile.loadFileAsString());
@@ -456,7 +534,7 @@ void PluginExporter::addFilesToPluginBundle (File csdFile, File exportDir)
             
             if (includeFile.exists())
             {
-                includeFile.copyFileTo(newFile);
+                cloneOrCopyFile(includeFile, newFile);
             }
             else
             {
@@ -465,9 +543,8 @@ void PluginExporter::addFilesToPluginBundle (File csdFile, File exportDir)
         }
         
         if (invalidFiles.size() > 0)
-            CabbageUtilities::showMessage(
-                                          "Cabbage could not bundle the following files\n" + invalidFiles.joinIntoString("\n") +
-                                          "\nPlease make sure they are located in the same folder as your .csd file.", &lookAndFeel);
+            reportExportError ("Cabbage could not bundle the following files\n" + invalidFiles.joinIntoString("\n") +
+                               "\nPlease make sure they are located in the same folder as your .csd file.");
     }
     
     StringArray linesFromCsd;
@@ -490,7 +567,7 @@ void PluginExporter::addFilesToPluginBundle (File csdFile, File exportDir)
                     File newFile(exportDir.getParentDirectory().getFullPathName() + "/" + bundleFiles[i].toString());
                     
                     if (bundleFile.existsAsFile())
-                        bundleFile.copyFileTo(newFile);
+                        cloneOrCopyFile(bundleFile, newFile);
                     else if(bundleFile.exists())
                         bundleFile.copyDirectoryTo(newFile);
                     else
@@ -502,42 +579,41 @@ void PluginExporter::addFilesToPluginBundle (File csdFile, File exportDir)
     }
     
     if (invalidFiles.size() > 0)
-        CabbageUtilities::showMessage(
-                                      "Cabbage could not bundle the following files\n" + invalidFiles.joinIntoString("\n") +
-                                      "\nPlease make sure they are located in the same folder as your .csd file.", &lookAndFeel);
+        reportExportError ("Cabbage could not bundle the following files\n" + invalidFiles.joinIntoString("\n") +
+                           "\nPlease make sure they are located in the same folder as your .csd file.");
     
 }
 
 
 
-long PluginExporter::cabbageFindPluginId (unsigned char* buf, size_t len, const char* s)
+bool PluginExporter::cloneOrCopyFile (const File& source, const File& target)
 {
-    long i, j;
-    size_t slen = strlen (s);
-    size_t imax = len - slen - 1;
-    long ret = -1;
-    int match;
-    
-    for (i = 0; i < imax; i++)
+    if (! target.deleteFile())
+        return false;
+
+#if JUCE_LINUX && defined (FICLONE)
+    const int in = open (source.getFullPathName().toRawUTF8(), O_RDONLY);
+
+    if (in >= 0)
     {
-        match = 1;
-        
-        for (j = 0; j < slen; j++)
-        {
-            if (buf[i + j] != s[j])
-            {
-                match = 0;
-                break;
-            }
-        }
-        
-        if (match)
-        {
-            ret = i;
-            break;
-        }
+        struct stat info;
+        const int out = fstat (in, &info) == 0 ? open (target.getFullPathName().toRawUTF8(), O_WRONLY | O_CREAT | O_EXCL, info.st_mode & 0777) : -1;
+        const bool cloned = out >= 0 && ioctl (out, FICLONE, in) == 0;
+
+        if (out >= 0)
+            close (out);
+
+        close (in);
+
+        if (cloned)
+            return true;
+
+        target.deleteFile();
     }
-    
-    //return position of plugin ID
-    return ret;
+#elif JUCE_MAC
+    if (clonefile (source.getFullPathName().toRawUTF8(), target.getFullPathName().toRawUTF8(), 0) == 0)
+        return true;
+#endif
+
+    return source.copyFileTo (target);
 }
@@ -34,11 +34,18 @@ public:
     PluginExporter():lookAndFeel(), settings(nullptr){}
     void settingsToUse(PropertiesFile* cabSettings){   settings = cabSettings; }
 
-    long cabbageFindPluginId (unsigned char* buf, size_t len, const char* s);
-    int setUniquePluginId (File binFile, File csdFile, String pluginId);
+    //false, after reporting why, if the ID wasn't set everywhere the template has a marker for it
+    bool setUniquePluginId (File binFile, File csdFile, String pluginId);
+    //returns the number of IDs replaced, and numFound the number of markers the scan found
+    static int replacePluginIdMarkers (uint8* data, size_t size, const char* pluginId, int& numFound);
+    //shows an alert in the IDE, the Converter has no GUI so it goes to stderr
+    void reportExportError (const String& message);
     void writePluginFileToDisk (File fc, File csdFile, File VSTData, String fileExtension, String pluginId, String type, bool encrypt = false);
     void addFilesToPluginBundle (File csdFile, File exportDir);
     void exportPlugin (String type, File csdFile, String pluginId, String destination="", bool promptForFilename = true, bool encrypt = false);
+    File getPluginTemplate (const String& type, String& fileExtension);
+    //a copy-on-write clone where the file system supports them (APFS, Btrfs, XFS), and a plain copy elsewhere
+    static bool cloneOrCopyFile (const File& source, const File& target);
 
     bool adhocSign = false;
     
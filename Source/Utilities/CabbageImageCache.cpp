@@ -0,0 +1,337 @@
+/*
+  Copyright (C) 2016 Rory Walsh
+
+  Cabbage is free software; you can redistribute it
+  and/or modify it under the terms of the GNU General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  Cabbage is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public
+  License along with Csound; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+  02111-1307 USA
+*/
+
+#include "CabbageImageCache.h"
+
+CabbageImageCache::CabbageImageCache() : Thread ("Cabbage image decoder")
+{
+    startThread (3);
+}
+
+CabbageImageCache::~CabbageImageCache()
+{
+    cancelPendingUpdate();
+    signalThreadShouldExit();
+    notify();
+    stopThread (2000);
+}
+
+//==============================================================================
+Image CabbageImageCache::getImage (const File& file, int width, int height, Component* componentToRepaint)
+{
+    const String key = createKey (file, width, height);
+    const ScopedLock sl (lock);
+
+    if (! entries.contains (key))
+        queue (key, file, width, height);
+
+    auto& entry = entries.getReference (key);
+
+    if (! entry.isDecoding)
+        return entry.image;
+
+    if (componentToRepaint != nullptr)
+        entry.components.addIfNotAlreadyThere (componentToRepaint);
+
+    return entry.image.isValid() ? entry.image : findPlaceholder (file);
+}
+
+void CabbageImageCache::prepare (const File& file, int width, int height)
+{
+    const String key = createKey (file, width, height);
+    const ScopedLock sl (lock);
+
+    if (! entries.contains (key))
+        queue (key, file, width, height);
+}
+
+void CabbageImageCache::draw (Graphics& g, const File& file, Rectangle<int> area, AffineTransform transform, Component* componentToRepaint,
+                              RectanglePlacement placement)
+{
+    if (area.isEmpty())
+        return;
+
+    SharedResourcePointer<CabbageImageCache> cache;
+
+    if (! (placement == RectanglePlacement (RectanglePlacement::stretchToFit)) && ! file.hasFileExtension ("svg"))
+    {
+        const Image image = cache->getImage (file, 0, 0, componentToRepaint);
+
+        if (image.isValid())
+            g.drawImageTransformed (image, placement.getTransformToFit (image.getBounds().toFloat(), area.toFloat()).followedBy (transform));
+
+        return;
+    }
+
+    const float scale = jmax (1.f, g.getInternalContext().getPhysicalPixelScaleFactor());
+    const Image image = cache->getImage (file, roundToInt (area.getWidth() * scale), roundToInt (area.getHeight() * scale), componentToRepaint);
+
+    //scaled to fit, as a placeholder can be a different size
+    if (image.isValid())
+        g.drawImageTransformed (image, AffineTransform::scale (area.getWidth() / (float) image.getWidth(), area.getHeight() / (float) image.getHeight())
+                                           .translated ((float) area.getX(), (float) area.getY())
+                                           .followedBy (transform));
+}
+
+bool CabbageImageCache::fileExists (const File& file)
+{
+    if (file == File())
+        return false;
+
+    SharedResourcePointer<CabbageImageCache> cache;
+    const String path = file.getFullPathName();
+
+    {
+        const ScopedLock sl (cache->lock);
+
+        if (cache->fileStates.contains (path))
+            return cache->fileStates[path].exists;
+    }
+
+    //from here on the decoder thread keeps it up to date
+    const FileState state = readFileState (file);
+    const ScopedLock sl (cache->lock);
+    cache->fileStates.set (path, state);
+    return state.exists;
+}
+
+//==============================================================================
+void CabbageImageCache::run()
+{
+    uint32 lastFileCheck = 0;
+
+    while (! threadShouldExit())
+    {
+        String key;
+        File file;
+        int width = 0, height = 0;
+
+        {
+            const ScopedLock sl (lock);
+
+            if (! pendingKeys.isEmpty())
+            {
+                key = pendingKeys[0];
+                pendingKeys.remove (0);
+                const auto& entry = entries.getReference (key);
+                file = entry.file;
+                width = entry.width;
+                height = entry.height;
+            }
+        }
+
+        if (key.isEmpty())
+        {
+            if (Time::getMillisecondCounter() - lastFileCheck >= (uint32) fileCheckIntervalMs)
+            {
+                checkForChangedFiles();
+                lastFileCheck = Time::getMillisecondCounter();
+            }
+
+            wait (fileCheckIntervalMs);
+            continue;
+        }
+
+        //the state is read first, so a file written while it is decoded is decoded again
+        const FileState state = readFileState (file);
+
+        if (state.exists && file.hasFileExtension ("svg") && width > 0 && height > 0)
+        {
+            std::shared_ptr<XmlElement> svg (XmlDocument::parse (file));
+            const ScopedLock sl (lock);
+            fileStates.set (file.getFullPathName(), state);
+
+            if (svg != nullptr)
+                svgsToRasterise.push_back ({ key, svg, width, height });
+            else
+                setImage (key, Image());
+        }
+        else
+        {
+            const Image image = state.exists ? decode (file, width, height) : Image();
+            const ScopedLock sl (lock);
+            fileStates.set (file.getFullPathName(), state);
+            //files that fail to decode are cached too, so they aren't retried on every paint
+            setImage (key, image);
+        }
+
+        triggerAsyncUpdate();
+    }
+}
+
+void CabbageImageCache::handleAsyncUpdate()
+{
+    std::vector<ParsedSvg> svgs;
+
+    {
+        const ScopedLock sl (lock);
+        svgs.swap (svgsToRasterise);
+    }
+
+    for (auto& parsed : svgs)
+    {
+        const Image image = rasterise (*parsed.svg, parsed.width, parsed.height);
+        const ScopedLock sl (lock);
+        setImage (parsed.key, image);
+    }
+
+    Array<Component::SafePointer<Component>> components;
+
+    {
+        const ScopedLock sl (lock);
+        components.swapWith (componentsToRepaint);
+    }
+
+    for (auto& component : components)
+        if (component != nullptr)
+            component->repaint();
+}
+
+void CabbageImageCache::queue (const String& key, const File& file, int width, int height)
+{
+    auto& entry = entries.getReference (key);
+    entry.file = file;
+    entry.width = width;
+    entry.height = height;
+    entry.isDecoding = true;
+    pendingKeys.addIfNotAlreadyThere (key);
+    notify();
+}
+
+void CabbageImageCache::setImage (const String& key, const Image& image)
+{
+    //evicted while it was being decoded
+    if (! entries.contains (key))
+        return;
+
+    auto getSizeInBytes = [] (const Image& i) { return i.isValid() ? (int64) i.getWidth() * i.getHeight() * 4 : (int64) 0; };
+
+    auto& entry = entries.getReference (key);
+    cacheSizeBytes += getSizeInBytes (image) - getSizeInBytes (entry.image);
+    entry.image = image;
+    entry.isDecoding = false;
+    componentsToRepaint.addArray (entry.components);
+
+    keysInInsertionOrder.removeString (key);
+    keysInInsertionOrder.add (key);
+
+    //oldest images go first, anything still in use will simply be decoded again
+    while (cacheSizeBytes > maxCacheSizeBytes && keysInInsertionOrder.size() > 1)
+    {
+        cacheSizeBytes -= getSizeInBytes (entries[keysInInsertionOrder[0]].image);
+        entries.remove (keysInInsertionOrder[0]);
+        pendingKeys.removeString (keysInInsertionOrder[0]);
+        keysInInsertionOrder.remove (0);
+    }
+}
+
+void CabbageImageCache::checkForChangedFiles()
+{
+    StringArray paths;
+
+    {
+        const ScopedLock sl (lock);
+
+        for (HashMap<String, FileState>::Iterator i (fileStates); i.next();)
+            paths.add (i.getKey());
+    }
+
+    for (const auto& path : paths)
+    {
+        const FileState state = readFileState (File (path));
+        const ScopedLock sl (lock);
+
+        if (fileStates[path] == state)
+            continue;
+
+        fileStates.set (path, state);
+
+        StringArray keysForFile;
+
+        for (HashMap<String, Entry>::Iterator i (entries); i.next();)
+            if (i.getValue().file.getFullPathName() == path)
+                keysForFile.add (i.getKey());
+
+        //the old images are still returned until the new ones are ready
+        for (const auto& key : keysForFile)
+        {
+            const auto& entry = entries.getReference (key);
+            queue (key, entry.file, entry.width, entry.height);
+        }
+    }
+}
+
+Image CabbageImageCache::findPlaceholder (const File& file) const
+{
+    Image placeholder;
+
+    for (HashMap<String, Entry>::Iterator i (entries); i.next();)
+    {
+        const auto& entry = i.getValue();
+
+        if (entry.image.isValid() && entry.file == file
+            && entry.image.getWidth() * entry.image.getHeight() > placeholder.getWidth() * placeholder.getHeight())
+            placeholder = entry.image;
+    }
+
+    return placeholder;
+}
+
+CabbageImageCache::FileState CabbageImageCache::readFileState (const File& file)
+{
+    FileState state;
+    state.exists = file.existsAsFile();
+
+    if (state.exists)
+        state.modificationTime = file.getLastModificationTime();
+
+    return state;
+}
+
+String CabbageImageCache::createKey (const File& file, int width, int height)
+{
+    return file.getFullPathName() + "_" + String (width) + "x" + String (height);
+}
+
+Image CabbageImageCache::rasterise (const XmlElement& svg, int width, int height)
+{
+    if (auto drawable = Drawable::createFromSVG (svg))
+    {
+        Image image (Image::ARGB, width, height, true);
+        Graphics g (image);
+        drawable->drawWithin (g, Rectangle<float> ((float) width, (float) height), RectanglePlacement::stretchToFit, 1.f);
+        return image;
+    }
+
+    return {};
+}
+
+Image CabbageImageCache::decode (const File& file, int width, int height)
+{
+    //SVGs without a size can't be rasterised, the rest are parsed in run() and rasterised on the message thread
+    if (file.hasFileExtension ("svg"))
+        return {};
+
+    Image image = ImageFileFormat::loadFrom (file);
+
+    if (image.isValid() && width > 0 && height > 0 && (image.getWidth() != width || image.getHeight() != height))
+        image = image.rescaled (width, height, Graphics::highResamplingQuality);
+
+    return image;
+}
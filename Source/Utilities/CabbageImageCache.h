@@ -0,0 +1,116 @@
+/*
+  Copyright (C) 2016 Rory Walsh
+
+  Cabbage is free software; you can redistribute it
+  and/or modify it under the terms of the GNU General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  Cabbage is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public
+  License along with Csound; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+  02111-1307 USA
+*/
+
+#ifndef CABBAGEIMAGECACHE_H_INCLUDED
+#define CABBAGEIMAGECACHE_H_INCLUDED
+
+#include "JuceHeader.h"
+
+//==============================================================================
+// Decoded image and SVG files, keyed by file and size. Images are decoded and
+// scaled on a background thread, either when an editor opens and prepares
+// them or the first time they are painted, and the component that asked is
+// repainted once they are ready. SVGs are read and parsed on that thread too,
+// but Drawables are only safe on the message thread, so they are built and
+// rasterised there. The same thread checks the
+// files it knows about once a second and decodes any that changed again, so
+// painting never has to touch the disk. Access it through a
+// SharedResourcePointer so that all plugin instances in a process share the
+// one cache.
+//==============================================================================
+class CabbageImageCache : private Thread,
+                          private AsyncUpdater
+{
+public:
+    CabbageImageCache();
+    ~CabbageImageCache() override;
+
+    //returns an invalid image until the file has been decoded. While it is
+    //being decoded, the same file at another size is returned as a placeholder
+    //if there is one, and a file that changed keeps its old image until the new
+    //one is ready. A width or height of 0 keeps the image's own size. SVGs need both.
+    Image getImage (const File& file, int width, int height, Component* componentToRepaint = nullptr);
+
+    //starts decoding a file before it is painted, i.e, when an editor opens
+    void prepare (const File& file, int width, int height);
+
+    //draws an image or SVG file placed in area, at the display's pixel density. Images
+    //that aren't stretched are decoded at their own size, SVGs are always stretched
+    static void draw (Graphics& g, const File& file, Rectangle<int> area,
+                      AffineTransform transform = AffineTransform(), Component* componentToRepaint = nullptr,
+                      RectanglePlacement placement = RectanglePlacement::stretchToFit);
+
+    //whether the file existed when the cache last checked, for paint routines that
+    //fall back to their own drawing when there is no image. A file is only looked
+    //at here the first time it is asked about.
+    static bool fileExists (const File& file);
+
+private:
+    struct Entry
+    {
+        File file;
+        int width = 0, height = 0;
+        Image image;
+        bool isDecoding = false;
+        //repainted each time the image is decoded, including after the file changes
+        Array<Component::SafePointer<Component>> components;
+    };
+
+    struct FileState
+    {
+        bool exists = false;
+        Time modificationTime;
+
+        bool operator== (const FileState& other) const noexcept   {   return exists == other.exists && modificationTime == other.modificationTime;   }
+    };
+
+    struct ParsedSvg
+    {
+        String key;
+        std::shared_ptr<XmlElement> svg;
+        int width = 0, height = 0;
+    };
+
+    void run() override;
+    void handleAsyncUpdate() override;
+    void queue (const String& key, const File& file, int width, int height);
+    void setImage (const String& key, const Image& image);
+    void checkForChangedFiles();
+    Image findPlaceholder (const File& file) const;
+    static FileState readFileState (const File& file);
+    static String createKey (const File& file, int width, int height);
+    static Image decode (const File& file, int width, int height);
+    static Image rasterise (const XmlElement& svg, int width, int height);
+
+    static constexpr int64 maxCacheSizeBytes = 256 * 1024 * 1024;
+    static constexpr int fileCheckIntervalMs = 1000;
+
+    CriticalSection lock;
+    HashMap<String, Entry> entries;
+    HashMap<String, FileState> fileStates;
+    StringArray keysInInsertionOrder;
+    int64 cacheSizeBytes = 0;
+    StringArray pendingKeys;
+    Array<Component::SafePointer<Component>> componentsToRepaint;
+    std::vector<ParsedSvg> svgsToRasterise;
+
+    JUCE_DECLARE_NON_COPYABLE (CabbageImageCache)
+};
+
+#endif  // CABBAGEIMAGECACHE_H_INCLUDED
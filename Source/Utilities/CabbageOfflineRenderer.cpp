@@ -0,0 +1,411 @@
+/*
+  Copyright (C) 2016 Rory Walsh
+
+  Cabbage is free software; you can redistribute it
+  and/or modify it under the terms of the GNU General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  Cabbage is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public
+  License along with Csound; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+  02111-1307 USA
+*/
+
+#include "CabbageOfflineRenderer.h"
+#include "../Audio/Plugins/CabbagePluginProcessor.h"
+#include "../Audio/Plugins/CabbageRealtimeAudit.h"
+#include <iostream>
+
+//==============================================================================
+// Stands in for a host transport that starts playing at zero when the render
+// starts, and moves on by each block as it is rendered.
+struct OfflineRenderPlayHead  : public AudioPlayHead
+{
+    OfflineRenderPlayHead (const CabbageOfflineRenderer::Job& job)
+    {
+        info.bpm = job.bpm;
+        info.timeSigNumerator = job.timeSigNumerator;
+        info.timeSigDenominator = job.timeSigDenominator;
+        info.isPlaying = true;
+        info.frameRate = AudioPlayHead::fpsUnknown;
+    }
+
+    bool getCurrentPosition (CurrentPositionInfo& result) override
+    {
+        result = info;
+        return true;
+    }
+
+    void advance (int numSamples, double sampleRate)
+    {
+        info.timeInSamples += numSamples;
+        info.timeInSeconds = info.timeInSamples / sampleRate;
+        info.ppqPosition = info.timeInSeconds * info.bpm / 60.0;
+
+        const double quarterNotesPerBar = info.timeSigNumerator * 4.0 / jmax (1, info.timeSigDenominator);
+        info.ppqPositionOfLastBarStart = std::floor (info.ppqPosition / quarterNotesPerBar) * quarterNotesPerBar;
+    }
+
+    CurrentPositionInfo info;
+};
+
+//==============================================================================
+// Processors are created, set up and destroyed on the message thread, as they
+// are in a host, because their timer reads the widget state and Csound from
+// there. Only processBlock runs on the render threads.
+static void callOnMessageThread (std::function<void()> function)
+{
+    MessageManager::getInstance()->callFunctionOnMessageThread ([] (void* data) -> void*
+    {
+        (*static_cast<std::function<void()>*> (data))();
+        return nullptr;
+    }, &function);
+}
+
+struct MessageThreadProcessor
+{
+    explicit MessageThreadProcessor (const File& csdFile)
+    {
+        callOnMessageThread ([this, &csdFile]
+        {
+            processor.reset (new CabbagePluginProcessor (csdFile, CabbagePluginProcessor::readBusesPropertiesFromXml (csdFile)));
+        });
+    }
+
+    ~MessageThreadProcessor()
+    {
+        callOnMessageThread ([this]
+        {
+            processor->releaseResources();
+            processor->setPlayHead (nullptr);
+            processor.reset();
+        });
+    }
+
+    std::unique_ptr<CabbagePluginProcessor> processor;
+};
+
+//==============================================================================
+CabbageOfflineRenderer::CabbageOfflineRenderer() : Thread ("Cabbage offline renderer")
+{
+}
+
+CabbageOfflineRenderer::~CabbageOfflineRenderer()
+{
+    stopThread (-1);
+}
+
+bool CabbageOfflineRenderer::startFromCommandLine (const StringArray& commandLineParameters)
+{
+    ArgumentList arguments ("Cabbage", commandLineParameters);
+
+    if (! arguments.containsOption (commandLineFlag))
+        return false;
+
+    const String batchFileName = arguments.getValueForOption ("--batch");
+
+    if (batchFileName.isNotEmpty())
+    {
+        StringArray lines;
+        lines.addLines (File::getCurrentWorkingDirectory().getChildFile (batchFileName.unquoted()).loadFileAsString());
+
+        for (auto& line : lines)
+        {
+            if (line.trim().isEmpty() || line.trim().startsWithChar ('#'))
+                continue;
+
+            //options on the line come first, so they win over those on the command line
+            StringArray lineArguments;
+            lineArguments.addTokens (line, true);
+            lineArguments.removeEmptyStrings();
+            lineArguments.addArray (commandLineParameters);
+            jobs.add (parseJob (ArgumentList ("Cabbage", lineArguments)));
+        }
+    }
+    else
+    {
+        jobs.add (parseJob (arguments));
+    }
+
+    const int requestedThreads = arguments.getValueForOption ("--threads").getIntValue();
+    numThreads = jlimit (1, jmax (1, jobs.size()), requestedThreads > 0 ? requestedThreads : SystemStats::getNumCpus());
+
+    const String auditReportName = arguments.getValueForOption ("--rt-audit-report").unquoted();
+
+    if (auditReportName.isNotEmpty())
+        auditReportFile = File::getCurrentWorkingDirectory().getChildFile (auditReportName);
+
+    startThread();
+    return true;
+}
+
+CabbageOfflineRenderer::Job CabbageOfflineRenderer::parseJob (const ArgumentList& arguments)
+{
+    auto fileOption = [&arguments] (const String& option)
+    {
+        const String fileName = arguments.getValueForOption (option).unquoted();
+        return fileName.isEmpty() ? File() : File::getCurrentWorkingDirectory().getChildFile (fileName);
+    };
+
+    Job job;
+    job.csdFile = fileOption ("--csd");
+    job.outputFile = fileOption ("--output");
+    job.inputFile = fileOption ("--input");
+    job.midiFile = fileOption ("--midi");
+    job.stateFile = fileOption ("--state");
+    job.presetFile = fileOption ("--presets");
+    job.presetName = arguments.getValueForOption ("--preset").unquoted();
+
+    if (job.presetFile == File())
+        job.presetFile = job.csdFile.withFileExtension (".snaps");
+
+    if (job.outputFile == File())
+        job.outputFile = job.csdFile.getSiblingFile (job.csdFile.getFileNameWithoutExtension()
+                                                     + (job.presetName.isNotEmpty() ? "_" + job.presetName : String())
+                                                     + ".wav");
+
+    auto numberOption = [&arguments] (const String& option, double defaultValue)
+    {
+        const String value = arguments.getValueForOption (option);
+        return value.isEmpty() ? defaultValue : value.getDoubleValue();
+    };
+
+    job.durationSeconds = numberOption ("--duration", -1);
+    job.sampleRate = numberOption ("--samplerate", 44100);
+    job.blockSize = (int) numberOption ("--blocksize", 512);
+    job.bitDepth = (int) numberOption ("--bitdepth", 24);
+    job.bpm = numberOption ("--bpm", 120);
+
+    const String timeSig = arguments.getValueForOption ("--timesig");
+
+    if (timeSig.contains ("/"))
+    {
+        job.timeSigNumerator = timeSig.upToFirstOccurrenceOf ("/", false, false).getIntValue();
+        job.timeSigDenominator = timeSig.fromFirstOccurrenceOf ("/", false, false).getIntValue();
+    }
+
+    return job;
+}
+
+//==============================================================================
+void CabbageOfflineRenderer::run()
+{
+    CriticalSection errorLock;
+
+    {
+        ThreadPool pool (numThreads);
+
+        for (auto& job : jobs)
+        {
+            pool.addJob ([&job, &errorLock, this]
+            {
+                const String error = render (job);
+                const ScopedLock sl (errorLock);
+
+                if (error.isNotEmpty())
+                    errors.add (job.csdFile.getFileName() + ": " + error);
+
+                std::cout << (error.isEmpty() ? "Rendered " + job.outputFile.getFullPathName()
+                                              : "Failed to render " + job.csdFile.getFullPathName() + ": " + error) << std::endl;
+            });
+        }
+
+        while (pool.getNumJobs() > 0 && ! threadShouldExit())
+            wait (50);
+    }
+
+    if (auditReportFile != File())
+    {
+        CabbageRealtimeAudit::writeReport (auditReportFile);
+        std::cout << CabbageRealtimeAudit::getNumViolations() << " real-time violations, see "
+                  << auditReportFile.getFullPathName() << std::endl;
+    }
+
+    //audited builds also fail when anything on the audio path allocated or locked, so the
+    //audit batch can fail a CI run. Without the audit there are never any violations
+    const int numViolations = CabbageRealtimeAudit::getNumViolations();
+    const int returnValue = errors.isEmpty() && numViolations == 0 ? 0 : 1;
+
+    if (numViolations > 0 && auditReportFile == File())
+        std::cout << numViolations << " real-time violations, pass --rt-audit-report=file to see where" << std::endl;
+
+    MessageManager::callAsync ([returnValue]
+    {
+        JUCEApplicationBase::getInstance()->setApplicationReturnValue (returnValue);
+        JUCEApplicationBase::quit();
+    });
+}
+
+String CabbageOfflineRenderer::render (const Job& job)
+{
+    if (! job.csdFile.existsAsFile())
+        return "can't find " + job.csdFile.getFullPathName();
+
+    if (job.sampleRate <= 0 || job.blockSize <= 0)
+        return "invalid sample rate or block size";
+
+    AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<AudioFormatReader> inputReader;
+
+    if (job.inputFile != File())
+    {
+        inputReader.reset (formatManager.createReaderFor (job.inputFile));
+
+        if (inputReader == nullptr)
+            return "can't read " + job.inputFile.getFullPathName();
+    }
+
+    MidiMessageSequence midiEvents;
+
+    if (job.midiFile != File())
+    {
+        FileInputStream midiStream (job.midiFile);
+        MidiFile midiFile;
+
+        if (! midiStream.openedOk() || ! midiFile.readFrom (midiStream))
+            return "can't read " + job.midiFile.getFullPathName();
+
+        midiFile.convertTimestampTicksToSeconds();
+
+        for (int track = 0; track < midiFile.getNumTracks(); ++track)
+            midiEvents.addSequence (*midiFile.getTrack (track), 0);
+
+        midiEvents.sort();
+        midiEvents.updateMatchedPairs();
+    }
+
+    double durationSeconds = job.durationSeconds;
+
+    if (durationSeconds <= 0 && inputReader != nullptr)
+        durationSeconds = inputReader->lengthInSamples / inputReader->sampleRate;
+
+    //leave a second for releases after the last MIDI event
+    if (durationSeconds <= 0 && midiEvents.getNumEvents() > 0)
+        durationSeconds = midiEvents.getEndTime() + 1.0;
+
+    if (durationSeconds <= 0)
+        durationSeconds = 10.0;
+
+    MemoryBlock state;
+
+    if (job.stateFile != File() && ! job.stateFile.loadFileAsData (state))
+        return "can't read " + job.stateFile.getFullPathName();
+
+    if (job.presetName.isNotEmpty() && ! job.presetFile.existsAsFile())
+        return "can't find preset file " + job.presetFile.getFullPathName();
+
+    //declared first, so it outlives the processor
+    OfflineRenderPlayHead playHead (job);
+    MessageThreadProcessor processorOwner (job.csdFile);
+    auto& processor = *processorOwner.processor;
+
+    if (! processor.csdCompiledWithoutError())
+        return "Csound failed to compile the instrument";
+
+    callOnMessageThread ([&]
+    {
+        processor.setPlayHead (&playHead);
+        processor.setNonRealtime (true);
+        processor.setRateAndBufferSizeDetails (job.sampleRate, job.blockSize);
+        processor.prepareToPlay (job.sampleRate, job.blockSize);
+
+        //state is applied after prepareToPlay, as a sample rate change recompiles the instrument
+        if (state.getSize() > 0)
+            processor.setStateInformation (state.getData(), (int) state.getSize());
+
+        if (job.presetName.isNotEmpty())
+            processor.restorePluginPreset (job.presetName, job.presetFile.getFullPathName());
+    });
+
+    const int numOutputChannels = processor.getTotalNumOutputChannels();
+    const int numInputChannels = processor.getTotalNumInputChannels();
+
+    job.outputFile.getParentDirectory().createDirectory();
+    job.outputFile.deleteFile();
+    std::unique_ptr<FileOutputStream> outputStream (job.outputFile.createOutputStream());
+
+    if (outputStream == nullptr)
+        return "can't write to " + job.outputFile.getFullPathName();
+
+    WavAudioFormat wavFormat;
+    std::unique_ptr<AudioFormatWriter> writer (wavFormat.createWriterFor (outputStream.get(), job.sampleRate, (unsigned int) numOutputChannels,
+                                                                          jlimit (16, 32, job.bitDepth), {}, 0));
+
+    if (writer == nullptr)
+        return "can't create a " + String (job.bitDepth) + "-bit .wav file with " + String (numOutputChannels) + " channels";
+
+    outputStream.release();
+
+    //the instrument's own latency is rendered and dropped, so the file lines up with its input
+    const int latency = processor.getLatencySamples();
+    const int64 numSamplesToWrite = (int64) std::ceil (durationSeconds * job.sampleRate);
+    const int64 numSamplesToRender = numSamplesToWrite + latency;
+
+    AudioBuffer<float> buffer (jmax (numInputChannels, numOutputChannels), job.blockSize);
+    MidiBuffer midiMessages;
+
+    //an input file at another sample rate is resampled to the render rate, rather than being
+    //read sample for sample, which would play it back at the wrong speed and pitch
+    std::unique_ptr<AudioFormatReaderSource> inputSource;
+    std::unique_ptr<ResamplingAudioSource> resampledInput;
+
+    if (inputReader != nullptr && numInputChannels > 0 && inputReader->sampleRate != job.sampleRate)
+    {
+        if (inputReader->sampleRate <= 0)
+            return "invalid sample rate in " + job.inputFile.getFullPathName();
+
+        inputSource.reset (new AudioFormatReaderSource (inputReader.get(), false));
+        resampledInput.reset (new ResamplingAudioSource (inputSource.get(), false, buffer.getNumChannels()));
+        resampledInput->setResamplingRatio (inputReader->sampleRate / job.sampleRate);
+        resampledInput->prepareToPlay (job.blockSize, job.sampleRate);
+    }
+    int nextMidiEvent = 0;
+
+    for (int64 position = 0; position < numSamplesToRender; position += job.blockSize)
+    {
+        const int numSamples = (int) jmin ((int64) job.blockSize, numSamplesToRender - position);
+        AudioBuffer<float> block (buffer.getArrayOfWritePointers(), buffer.getNumChannels(), numSamples);
+        block.clear();
+
+        if (resampledInput != nullptr)
+            resampledInput->getNextAudioBlock (AudioSourceChannelInfo (&block, 0, numSamples));
+        else if (inputReader != nullptr && numInputChannels > 0)
+            inputReader->read (&block, 0, numSamples, position, true, true);
+
+        midiMessages.clear();
+        const double blockEndSeconds = (position + numSamples) / job.sampleRate;
+
+        for (; nextMidiEvent < midiEvents.getNumEvents(); ++nextMidiEvent)
+        {
+            const auto& message = midiEvents.getEventPointer (nextMidiEvent)->message;
+
+            if (message.getTimeStamp() >= blockEndSeconds)
+                break;
+
+            if (! message.isMetaEvent())
+                midiMessages.addEvent (message, jlimit (0, numSamples - 1, (int) (message.getTimeStamp() * job.sampleRate - position)));
+        }
+
+        processor.processBlock (block, midiMessages);
+        playHead.advance (numSamples, job.sampleRate);
+
+        const int64 firstSampleToWrite = jmax ((int64) 0, (int64) latency - position);
+
+        if (firstSampleToWrite < numSamples)
+        {
+            AudioBuffer<float> output (block.getArrayOfWritePointers(), numOutputChannels, (int) firstSampleToWrite,
+                                       numSamples - (int) firstSampleToWrite);
+            writer->writeFromAudioSampleBuffer (output, 0, output.getNumSamples());
+        }
+    }
+
+    return {};
+}
@@ -0,0 +1,95 @@
+/*
+  Copyright (C) 2016 Rory Walsh
+
+  Cabbage is free software; you can redistribute it
+  and/or modify it under the terms of the GNU General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  Cabbage is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public
+  License along with Csound; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+  02111-1307 USA
+*/
+
+#ifndef CABBAGEOFFLINERENDERER_H_INCLUDED
+#define CABBAGEOFFLINERENDERER_H_INCLUDED
+
+#include "JuceHeader.h"
+
+//==============================================================================
+// Renders instruments to audio files without an editor or an audio device, as
+// fast as they will run. Started from Cabbage::initialise() when the command
+// line contains --render, for example
+//
+//   Cabbage --render --csd=synth.csd --preset=Pad --midi=chords.mid --output=pad.wav
+//   Cabbage --render --batch=jobs.txt --threads=8
+//
+// Each line of a batch file holds the options for one render, and any option
+// missing from a line is taken from the command line. Renders run in parallel
+// on a thread pool, and the application quits with a non-zero return value if
+// any of them fail.
+//
+// Options:
+//   --csd=file         instrument to render
+//   --output=file      .wav file to write, defaults to the csd's name
+//   --preset=name      preset to apply, from --presets, or the csd's .snaps file
+//   --presets=file     preset file to read --preset from
+//   --state=file       plugin state to apply, as saved by a host
+//   --input=file       audio file fed to the instrument's inputs, resampled to
+//                      --samplerate if its own rate differs
+//   --midi=file        MIDI file played into the instrument
+//   --duration=secs    length of the render, defaults to the input or MIDI file
+//   --samplerate=n     defaults to 44100
+//   --blocksize=n      defaults to 512
+//   --bitdepth=n       16, 24 or 32, defaults to 24
+//   --bpm=n            host tempo, defaults to 120
+//   --timesig=n/d      host time signature, defaults to 4/4
+//   --rt-audit-report=file  with -DRealtimeAudit=1 builds, where to write the
+//                      real-time audit report once every render is done. Those
+//                      builds exit with 1 if the audit recorded any violation
+//==============================================================================
+class CabbageOfflineRenderer : private Thread
+{
+public:
+    struct Job
+    {
+        File csdFile, outputFile, inputFile, midiFile, stateFile, presetFile;
+        String presetName;
+        double durationSeconds = -1;
+        double sampleRate = 44100;
+        double bpm = 120;
+        int blockSize = 512;
+        int bitDepth = 24;
+        int timeSigNumerator = 4, timeSigDenominator = 4;
+    };
+
+    CabbageOfflineRenderer();
+    ~CabbageOfflineRenderer() override;
+
+    //returns false if the command line doesn't ask for a render
+    bool startFromCommandLine (const StringArray& commandLineParameters);
+
+    //renders a single job on the calling thread, returning an error message if it fails
+    static String render (const Job& job);
+
+    static constexpr const char* commandLineFlag = "--render";
+
+private:
+    void run() override;
+    static Job parseJob (const ArgumentList& arguments);
+
+    Array<Job> jobs;
+    int numThreads = 1;
+    StringArray errors;
+    File auditReportFile;
+
+    JUCE_DECLARE_NON_COPYABLE (CabbageOfflineRenderer)
+};
+
+#endif  // CABBAGEOFFLINERENDERER_H_INCLUDED
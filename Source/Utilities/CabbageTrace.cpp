@@ -0,0 +1,259 @@
+/*
+  Copyright (C) 2016 Rory Walsh
+
+  Cabbage is free software; you can redistribute it
+  and/or modify it under the terms of the GNU General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  Cabbage is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public
+  License along with Csound; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+  02111-1307 USA
+*/
+
+#include "CabbageTrace.h"
+
+#if Cabbage_Trace
+
+namespace
+{
+    struct Zone
+    {
+        const char* name;
+        int64 startTicks, endTicks;
+    };
+
+    constexpr int maxThreads = 32;
+    constexpr uint64 zonesPerThread = 8192;
+
+    //written only by the thread that holds it, and read when the trace is saved.
+    //A slot is handed on when its thread exits, and the zones it recorded are kept
+    struct ThreadZones
+    {
+        Zone zones[zonesPerThread];
+        std::atomic<uint64> numWritten { 0 };
+        std::atomic<bool> inUse { false };
+
+        //the name is set once per thread that takes the slot, so a lock held for a copy is fine
+        SpinLock nameLock;
+        String threadName;
+        int numEarlierThreads = 0;
+    };
+
+    std::atomic<bool> enabled { false };
+    //one past the highest slot ever taken, so the trace also covers threads that have exited
+    std::atomic<int> numSlotsUsed { 0 };
+
+    //allocated the first time tracing is enabled and never freed, as threads
+    //may still be recording while statics are destroyed at exit
+    std::atomic<ThreadZones*> allThreadZones { nullptr };
+
+    //gives the slot back when its thread exits, so pools that keep starting threads don't run out
+    struct ThreadSlot
+    {
+        ~ThreadSlot()
+        {
+            if (index >= 0)
+                allThreadZones.load()[index].inUse.store (false, std::memory_order_release);
+        }
+
+        int index = -1;
+    };
+
+    thread_local ThreadSlot threadSlot;
+
+    ThreadZones* claimThreadZones()
+    {
+        auto* threadZones = allThreadZones.load();
+
+        if (threadZones == nullptr)
+            return nullptr;
+
+        if (threadSlot.index >= 0)
+            return threadZones + threadSlot.index;
+
+        //a thread that found every slot taken tries again with its next zone
+        for (int slot = 0; slot < maxThreads; ++slot)
+        {
+            auto& zones = threadZones[slot];
+            bool expected = false;
+
+            if (zones.inUse.load (std::memory_order_relaxed)
+                || ! zones.inUse.compare_exchange_strong (expected, true, std::memory_order_acquire))
+                continue;
+
+            String name;
+
+            //copying a thread's name only bumps a reference count
+            if (MessageManager::getInstanceWithoutCreating() != nullptr
+                && MessageManager::getInstanceWithoutCreating()->isThisTheMessageThread())
+                name = "Message thread";
+            else if (auto* thread = Thread::getCurrentThread())
+                name = thread->getThreadName();
+
+            {
+                const SpinLock::ScopedLockType sl (zones.nameLock);
+
+                if (zones.numWritten.load (std::memory_order_relaxed) > 0)
+                    ++zones.numEarlierThreads;
+
+                zones.threadName = name;
+            }
+
+            for (int used = numSlotsUsed.load(); used <= slot && ! numSlotsUsed.compare_exchange_weak (used, slot + 1);)
+                ;
+
+            threadSlot.index = slot;
+            return &zones;
+        }
+
+        return nullptr;
+    }
+
+    //plugins have no settings, so they are traced through an environment variable
+    struct TraceFileAtExit
+    {
+        TraceFileAtExit()
+            : fileName (SystemStats::getEnvironmentVariable ("CABBAGE_TRACE_FILE", {}))
+        {
+            if (fileName.isNotEmpty())
+                CabbageTrace::setEnabled (true);
+        }
+
+        ~TraceFileAtExit()
+        {
+            if (fileName.isNotEmpty())
+                CabbageTrace::writeChromeTrace (File::getCurrentWorkingDirectory().getChildFile (fileName));
+        }
+
+        const String fileName;
+    };
+
+    TraceFileAtExit traceFileAtExit;
+}
+
+void CabbageTrace::addZone (const char* name, int64 startTicks) noexcept
+{
+    //acquire, so a thread that sees tracing enabled also sees the zones allocated for it
+    if (! enabled.load (std::memory_order_acquire))
+        return;
+
+    const int64 endTicks = Time::getHighResolutionTicks();
+
+    if (auto* threadZones = claimThreadZones())
+    {
+        const uint64 index = threadZones->numWritten.load (std::memory_order_relaxed);
+        threadZones->zones[index % zonesPerThread] = { name, startTicks, endTicks };
+        threadZones->numWritten.store (index + 1, std::memory_order_release);
+    }
+}
+
+void CabbageTrace::setEnabled (bool shouldRecord)
+{
+    if (shouldRecord && allThreadZones.load() == nullptr)
+        allThreadZones = new ThreadZones[maxThreads];
+
+    enabled = shouldRecord;
+}
+
+bool CabbageTrace::isEnabled() noexcept
+{
+    return enabled.load (std::memory_order_relaxed);
+}
+
+bool CabbageTrace::writeChromeTrace (const File& file)
+{
+    auto* threadZones = allThreadZones.load();
+
+    if (threadZones == nullptr)
+        return false;
+
+    struct ThreadCopy
+    {
+        String name;
+        std::vector<Zone> zones;
+    };
+
+    std::vector<ThreadCopy> threads;
+    int64 firstTicks = std::numeric_limits<int64>::max();
+
+    for (int i = 0; i < numSlotsUsed.load(); ++i)
+    {
+        auto& source = threadZones[i];
+        const uint64 numWritten = source.numWritten.load (std::memory_order_acquire);
+
+        if (numWritten == 0)
+            continue;
+
+        const uint64 first = numWritten > zonesPerThread ? numWritten - zonesPerThread : 0;
+
+        ThreadCopy copy;
+
+        {
+            const SpinLock::ScopedLockType sl (source.nameLock);
+            copy.name = source.threadName.isNotEmpty() ? source.threadName : "Thread " + String (i);
+
+            if (source.numEarlierThreads > 0)
+                copy.name << " (and " << source.numEarlierThreads << " earlier threads)";
+        }
+
+        for (auto index = first; index < numWritten; ++index)
+            copy.zones.push_back (source.zones[index % zonesPerThread]);
+
+        //zones the thread overwrote while they were being copied are dropped
+        const uint64 numWrittenAfter = source.numWritten.load (std::memory_order_acquire);
+
+        if (numWrittenAfter > first + zonesPerThread)
+        {
+            const auto numOverwritten = (size_t) jmin ((uint64) copy.zones.size(), numWrittenAfter - first - zonesPerThread);
+            copy.zones.erase (copy.zones.begin(), copy.zones.begin() + (std::ptrdiff_t) numOverwritten);
+        }
+
+        for (auto& zone : copy.zones)
+            firstTicks = jmin (firstTicks, zone.startTicks);
+
+        threads.push_back (std::move (copy));
+    }
+
+    auto toMicroseconds = [] (int64 ticks) { return String (Time::highResolutionTicksToSeconds (ticks) * 1000000.0, 3); };
+
+    MemoryOutputStream json;
+    json << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool isFirstEvent = true;
+
+    for (size_t tid = 0; tid < threads.size(); ++tid)
+    {
+        const String threadName = threads[tid].name.isNotEmpty() ? threads[tid].name : "Thread " + String ((int) tid);
+
+        json << (isFirstEvent ? "" : ",\n")
+             << "{\"ph\":\"M\",\"pid\":1,\"tid\":" << (int) tid
+             << ",\"name\":\"thread_name\",\"args\":{\"name\":\"" << JSON::escapeString (threadName) << "\"}}";
+        isFirstEvent = false;
+
+        for (auto& zone : threads[tid].zones)
+        {
+            json << ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":" << (int) tid
+                 << ",\"name\":\"" << JSON::escapeString (zone.name)
+                 << "\",\"ts\":" << toMicroseconds (zone.startTicks - firstTicks)
+                 << ",\"dur\":" << toMicroseconds (zone.endTicks - zone.startTicks) << "}";
+        }
+    }
+
+    json << "\n]}\n";
+    return file.replaceWithData (json.getData(), json.getDataSize());
+}
+
+#else
+
+void CabbageTrace::addZone (const char*, int64) noexcept {}
+void CabbageTrace::setEnabled (bool) {}
+bool CabbageTrace::isEnabled() noexcept     {   return false;   }
+bool CabbageTrace::writeChromeTrace (const File&)   {   return false;   }
+
+#endif
@@ -0,0 +1,70 @@
+/*
+  Copyright (C) 2016 Rory Walsh
+
+  Cabbage is free software; you can redistribute it
+  and/or modify it under the terms of the GNU General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  Cabbage is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public
+  License along with Csound; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+  02111-1307 USA
+*/
+
+#ifndef CABBAGETRACE_H_INCLUDED
+#define CABBAGETRACE_H_INCLUDED
+
+#include "JuceHeader.h"
+
+#ifndef Cabbage_Trace
+ #define Cabbage_Trace 0
+#endif
+
+//==============================================================================
+// A timeline of what each thread was doing, for finding out why an instrument
+// glitched. It is built in by configuring with -DTracing=1. Zones are written
+// to a fixed ring for each thread, so recording one never locks or allocates,
+// and the last few seconds of every thread are kept. writeChromeTrace() saves
+// them as Chrome trace JSON, which chrome://tracing and ui.perfetto.dev open.
+//
+// Nothing is recorded until setEnabled (true). The IDE turns tracing on and
+// off from its settings. Plugins and the standalone turn it on at load when the
+// CABBAGE_TRACE_FILE environment variable names a file, and write the trace
+// to that file when the process exits.
+//
+// Without the build option, ScopedZone is empty and nothing is recorded.
+//==============================================================================
+class CabbageTrace
+{
+public:
+    //the name must be a string literal, as only the pointer is kept
+    struct ScopedZone
+    {
+#if Cabbage_Trace
+        explicit ScopedZone (const char* zoneName) noexcept
+            : name (zoneName), startTicks (Time::getHighResolutionTicks()) {}
+
+        ~ScopedZone()   {   addZone (name, startTicks);   }
+
+        const char* const name;
+        const int64 startTicks;
+#else
+        explicit ScopedZone (const char*) noexcept {}
+#endif
+    };
+
+    //records a zone from startTicks until now, for zones that begin and end in different functions
+    static void addZone (const char* name, int64 startTicks) noexcept;
+
+    static void setEnabled (bool shouldRecord);
+    static bool isEnabled() noexcept;
+    static bool writeChromeTrace (const File& file);
+};
+
+#endif  // CABBAGETRACE_H_INCLUDED
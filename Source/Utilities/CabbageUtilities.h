@@ -1079,9 +1079,14 @@ public:
 
     //==========================================================================================
     const static String getPlantFileAsXmlString(File xmlFile)
+    {
+        return getPlantTextAsXmlString(xmlFile.loadFileAsString());
+    }
+
+    const static String getPlantTextAsXmlString(const String& xmlText)
     {
         StringArray linesFromXmlFile;
-        linesFromXmlFile.addLines(xmlFile.loadFileAsString());
+        linesFromXmlFile.addLines(xmlText);
         bool shouldReplaceChars = false;
         for( int i = 0 ; i < linesFromXmlFile.size()-1; i++)
         {
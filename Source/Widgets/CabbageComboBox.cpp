@@ -136,7 +136,7 @@ CabbageComboBox::CabbageComboBox (ValueTree wData, CabbagePluginEditor* _owner)
         }
         else
         {
-            owner->sendChannelDataToCsound (getChannel(), getValue());
+            owner->sendChannelDataToCsound (getChannelHandle(), getValue());
             setSelectedItemIndex (getValue() - 1, dontSendNotification);
         }
     }
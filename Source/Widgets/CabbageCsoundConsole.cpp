@@ -78,7 +78,18 @@ void CabbageCsoundConsole::timerCallback()
 
         if (csoundOutputString.isNotEmpty())
         {
+            //always append, regardless of where the user last clicked
+            moveCaretToEnd();
             insertTextAtCaret (csoundOutputString);
+
+            const int charsToRemove = getTotalNumChars() - maxNumChars;
+
+            if (charsToRemove > 0)
+            {
+                setHighlightedRegion ({ 0, charsToRemove });
+                insertTextAtCaret ({});
+                moveCaretToEnd();
+            }
         }
     }
 }
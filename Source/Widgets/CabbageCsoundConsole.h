@@ -54,6 +54,7 @@ public:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CabbageCsoundConsole)
 
 private:
+    static constexpr int maxNumChars = 64 * 1024;
     bool monospaced = false;
     Font monospacedFont;
     Font defaultFont;
@@ -84,7 +84,7 @@ void CabbageEncoder::labelTextChanged (Label* label)
     currentEncValue = value;
     valueLabel.setText (createValueText(labelValue, 3, "", postfix), dontSendNotification);
     widgetData.setPropertyExcludingListener(this, CabbageIdentifierIds::value, currentEncValue, nullptr);
-    owner->sendChannelDataToCsound (getChannel(), currentEncValue);
+    owner->sendChannelDataToCsound (getChannelHandle(), currentEncValue);
     
     showPopup();
 }
@@ -106,7 +106,7 @@ void CabbageEncoder::mouseWheelMove (const MouseEvent& event, const MouseWheelDe
 
 
         repaint();
-        owner->sendChannelDataToCsound (getChannel(), currentEncValue);
+        owner->sendChannelDataToCsound (getChannelHandle(), currentEncValue);
         widgetData.setPropertyExcludingListener(this, CabbageIdentifierIds::value, currentEncValue, nullptr);
         showPopup();
     }
@@ -121,7 +121,7 @@ void CabbageEncoder::mouseDown (const MouseEvent& e)
             velocity = 1;
             currentEncValue = startingValue;
             repaint();
-            owner->sendChannelDataToCsound (getChannel(), currentEncValue);
+            owner->sendChannelDataToCsound (getChannelHandle(), currentEncValue);
             widgetData.setPropertyExcludingListener(this, CabbageIdentifierIds::value, currentEncValue, nullptr);
             showPopup();
             firstDrag = true;
@@ -161,7 +161,7 @@ void CabbageEncoder::mouseDrag (const MouseEvent& e)
 
             firstDrag = false;
 
-            owner->sendChannelDataToCsound (getChannel(), currentEncValue);
+            owner->sendChannelDataToCsound (getChannelHandle(), currentEncValue);
             widgetData.setPropertyExcludingListener(this, CabbageIdentifierIds::value, currentEncValue, nullptr);
             showPopup();
         }
@@ -20,6 +20,40 @@
 #include "CabbageEventSequencer.h"
 #include "../Audio/Plugins/CabbagePluginEditor.h"
 
+//==============================================================================
+// A single 60Hz timer shared by every sequencer in the process, so step changes
+// are coalesced into at most one update a frame however many grids are open
+// and however fast they're stepping.
+//==============================================================================
+class CabbageEventSequencer::StepTimer : private Timer
+{
+public:
+    void addSequencer (CabbageEventSequencer* sequencer)
+    {
+        sequencers.addIfNotAlreadyThere (sequencer);
+
+        if (! isTimerRunning())
+            startTimerHz (60);
+    }
+
+    void removeSequencer (CabbageEventSequencer* sequencer)
+    {
+        sequencers.removeFirstMatchingValue (sequencer);
+
+        if (sequencers.isEmpty())
+            stopTimer();
+    }
+
+private:
+    void timerCallback() override
+    {
+        for (auto* sequencer : sequencers)
+            sequencer->updateCurrentStepPosition();
+    }
+
+    Array<CabbageEventSequencer*> sequencers;
+};
+
 CabbageEventSequencer::CabbageEventSequencer (ValueTree wData, CabbagePluginEditor* _owner)
     : widgetData (wData),
     vp ("SequencerContainer"),
@@ -45,6 +79,10 @@ CabbageEventSequencer::CabbageEventSequencer (ValueTree wData, CabbagePluginEdit
 
     setColours(wData);
     updateCurrentStepPosition();
+    stepTimer->addSequencer (this);
+
+	//matrix belongs to processor, and keeps its cells when the editor is reopened..
+    sequencerIndex = owner->createEventMatrix(numColumns, numRows, getChannel());
 
     var props = CabbageWidgetData::getProperty(wData, CabbageIdentifierIds::celldata);
 
@@ -52,18 +90,11 @@ CabbageEventSequencer::CabbageEventSequencer (ValueTree wData, CabbagePluginEdit
     {
         setCellData(int(props[0]), int(props[1]), props[2].toString());
     }
-
-	//matrix belongs to processor..
-    owner->createEventMatrix(numColumns, numRows, getChannel());
-    //init matrix data:
-    for( int x = 0 ; x < numColumns ; x++)
-        for( int y = 0 ; y < numRows ; y++)
-            owner->setEventMatrixData(x, y, getChannel(), String());
-
 }
 
 CabbageEventSequencer::~CabbageEventSequencer()
 {
+    stepTimer->removeSequencer (this);
     widgetData.removeListener(this);
     cells.getUnchecked (0)->clear();
     cells.clear();
@@ -156,10 +187,13 @@ TextEditor* CabbageEventSequencer::getEditor (int column, int row)
 
 void CabbageEventSequencer::setColours(ValueTree wData)
 {
+    backgroundColour = Colour::fromString (CabbageWidgetData::getStringProp (wData, CabbageIdentifierIds::backgroundcolour));
+    highlightColour = Colour::fromString (CabbageWidgetData::getStringProp (wData, CabbageIdentifierIds::highlightcolour));
+
     for(int x = 0 ; x < numColumns ; x++)
         for(int y = 0 ; y < numRows ; y++)
         {
-            getEditor(x, y)->setColour(TextEditor::backgroundColourId, Colour::fromString (CabbageWidgetData::getStringProp (wData, CabbageIdentifierIds::backgroundcolour)));
+            getEditor(x, y)->setColour(TextEditor::backgroundColourId, backgroundColour);
             getEditor(x, y)->setColour(TextEditor::textColourId, Colour::fromString (CabbageWidgetData::getStringProp (wData, CabbageIdentifierIds::fontcolour)));
             getEditor(x, y)->setColour(TextEditor::highlightColourId, Colour::fromString (CabbageWidgetData::getStringProp (wData, CabbageIdentifierIds::activecellcolour)));
             getEditor(x, y)->setColour(TextEditor::outlineColourId, Colour::fromString (CabbageWidgetData::getStringProp (wData, CabbageIdentifierIds::outlinecolour)));
@@ -172,48 +206,41 @@ void CabbageEventSequencer::setColours(ValueTree wData)
         if (i % int(CabbageWidgetData::getNumProp(wData, CabbageIdentifierIds::showstepnumbers)) == 0)
         {
             stepNumbers[i]->setColour(Label::outlineColourId, Colour::fromString (CabbageWidgetData::getStringProp (wData, CabbageIdentifierIds::outlinecolour)));
-            stepNumbers[i]->setColour(Label::backgroundColourId, Colour::fromString (CabbageWidgetData::getStringProp (wData, CabbageIdentifierIds::backgroundcolour)));
+            stepNumbers[i]->setColour(Label::backgroundColourId, backgroundColour);
         }
     }
+
+    //every cell is back to the background colour, so the next frame highlights the current step again
+    displayedBeat = -1;
 }
 
 void CabbageEventSequencer::updateCurrentStepPosition()
 {
-    const MessageManagerLock j;
+    const int beat = currentBeat.load();
 
-    if(orientation == "vertical")
-    {
-        for (int x = 0; x < numColumns; x++)
-            for (int y = 0; y < numRows; y++)
-            {
-                if (currentBeat == y)
-                    getEditor(x, y)->setColour(TextEditor::backgroundColourId, Colour::fromString(
-                            CabbageWidgetData::getStringProp(widgetData, CabbageIdentifierIds::highlightcolour)));
-                else
-                    getEditor(x, y)->setColour(TextEditor::backgroundColourId, Colour::fromString(
-                            CabbageWidgetData::getStringProp(widgetData, CabbageIdentifierIds::backgroundcolour)));
+    if (beat == displayedBeat)
+        return;
 
+    //only the cells of the step being left and the step being entered are recoloured, and so repainted
+    setStepColour(displayedBeat, backgroundColour);
+    setStepColour(beat, highlightColour);
+    displayedBeat = beat;
+}
 
-                getEditor(x, y)->lookAndFeelChanged();
-            }
+void CabbageEventSequencer::setStepColour(int step, Colour colour)
+{
+    //a step is a row of cells in a vertical sequencer, and a column otherwise
+    if(orientation == "vertical")
+    {
+        if (isPositiveAndBelow(step, numRows))
+            for (int x = 0; x < numColumns; x++)
+                getEditor(x, step)->setColour(TextEditor::backgroundColourId, colour);
     }
     else
     {
-        for (int y = 0; y < numRows; y++)
-        {
-            for (int x = 0; x < numColumns; x++)
-            {
-                if (currentBeat == x)
-                    getEditor(x, y)->setColour(TextEditor::backgroundColourId, Colour::fromString(
-                            CabbageWidgetData::getStringProp(widgetData, CabbageIdentifierIds::highlightcolour)));
-                else
-                    getEditor(x, y)->setColour(TextEditor::backgroundColourId, Colour::fromString(
-                            CabbageWidgetData::getStringProp(widgetData, CabbageIdentifierIds::backgroundcolour)));
-
-
-                getEditor(x, y)->lookAndFeelChanged();
-            }
-        }
+        if (isPositiveAndBelow(step, numColumns))
+            for (int y = 0; y < numRows; y++)
+                getEditor(step, y)->setColour(TextEditor::backgroundColourId, colour);
     }
 }
 
@@ -252,7 +279,7 @@ void CabbageEventSequencer::setCellData(int col, int row, const String data)
 	{
 		getEditor(col, row)->setText(data.trimStart());
 		getEditor(col, row)->setText(data.trimStart());
-		owner->setEventMatrixData(col, row, getChannel(), newData);
+		owner->setEventMatrixData(sequencerIndex, col, row, newData);
 	}
 
 }
@@ -321,8 +348,7 @@ void CabbageEventSequencer::valueTreePropertyChanged (ValueTree& valueTree, cons
 {
     if(prop == CabbageIdentifierIds::value)
     {
-        currentBeat = CabbageWidgetData::getNumProp(widgetData, CabbageIdentifierIds::value);
-        updateCurrentStepPosition();
+        currentBeat = (int) CabbageWidgetData::getNumProp(widgetData, CabbageIdentifierIds::value);
     }
 
     else if(prop == CabbageIdentifierIds::celldata)
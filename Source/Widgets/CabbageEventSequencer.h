@@ -39,7 +39,9 @@ public:
     void swapFocusForEditors (KeyPress key, int col, int row);
     void highlightEditorText (int col, int row);
     void setCellData(int col, int row, const String data);
+    //shows the step last set through the value identifier, called once a frame from the message thread
     void updateCurrentStepPosition();
+    void setStepColour (int step, Colour colour);
     void arrangeTextEditors(ValueTree wData);
 
     //ValueTree::Listener virtual methods....
@@ -58,9 +60,15 @@ public:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CabbageEventSequencer)
 
 private:
+    class StepTimer;
+
     int numColumns = 0;
     int numRows = 0;
-    int currentBeat = 0;
+    //set from whichever thread updates the value, and shown by the next frame's updateCurrentStepPosition()
+    std::atomic<int> currentBeat { 0 };
+    int displayedBeat = -1;
+    Colour backgroundColour, highlightColour;
+    int sequencerIndex = -1;
     int numbersWidth = 20;
     Viewport vp;
     Component seqContainer;
@@ -68,4 +76,5 @@ private:
     OwnedArray<Label> stepNumbers;
     CabbagePluginEditor* owner;
     String orientation = "";
+    SharedResourcePointer<StepTimer> stepTimer;
 };
@@ -31,15 +31,15 @@ CabbageWidgetBase(_owner)
 
 void CabbageForm::textDropped (const String& text, int x, int y)
 {
-    owner->sendChannelDataToCsound(CabbageIdentifierIds::mousex, x);
-    owner->sendChannelDataToCsound(CabbageIdentifierIds::mousey, y);
+    owner->sendChannelDataToCsound(owner->getChannelHandle(CabbageIdentifierIds::mousex), x);
+    owner->sendChannelDataToCsound(owner->getChannelHandle(CabbageIdentifierIds::mousey), y);
     owner->sendChannelStringDataToCsound(CabbageIdentifierIds::lastTextDropped, text);
 }
 
 void CabbageForm::filesDropped (const StringArray& files, int x, int y)
 {
-    owner->sendChannelDataToCsound(CabbageIdentifierIds::mousex, x);
-    owner->sendChannelDataToCsound(CabbageIdentifierIds::mousey, y);
+    owner->sendChannelDataToCsound(owner->getChannelHandle(CabbageIdentifierIds::mousex), x);
+    owner->sendChannelDataToCsound(owner->getChannelHandle(CabbageIdentifierIds::mousey), y);
     owner->sendChannelStringDataToCsound(CabbageIdentifierIds::lastFileDropped, files[0]);
 }
 
@@ -64,8 +64,7 @@ CabbageImage::CabbageImage (ValueTree wData, CabbagePluginEditor* owner, bool is
             {
                 imgFile = File(path).getParentDirectory().getChildFile(fileBase64).getFullPathName();
             }
-			if (File(imgFile).existsAsFile())
-				img = ImageCache::getFromFile(imgFile);
+			usesImageFile = File(imgFile).existsAsFile() && ! imgFile.hasFileExtension(".svg");
 		}
 	}
 
@@ -120,9 +119,12 @@ void CabbageImage::paint (Graphics& g)
         else
         {
 
+            if (usesImageFile)
+                img = imageCache->getImage(imgFile, 0, 0, this);
+
             if (imgFile.hasFileExtension(".svg"))
             {
-                CabbageLookAndFeel2::drawFromSVG(g, imgFile, 0, 0, getWidth(), getHeight(), AffineTransform());
+                CabbageLookAndFeel2::drawFromSVG(g, imgFile, 0, 0, getWidth(), getHeight(), AffineTransform(), this);
             }
             else if (img.isValid())
 
@@ -132,7 +134,7 @@ void CabbageImage::paint (Graphics& g)
                     cropheight == 0 ? img.getHeight() : cropheight);
             }
 
-            else
+            else if (! usesImageFile)
             {
                 g.fillAll(Colours::transparentBlack);
                 g.setColour(mainColour);
@@ -171,7 +173,7 @@ void CabbageImage::paint (Graphics& g)
 //==============================================================================
 void CabbageImage::mouseDown (const MouseEvent& e)
 {
-    owner->sendChannelDataToCsound (getChannel(), currentToggleValue);
+    owner->sendChannelDataToCsound (getChannelHandle(), currentToggleValue);
     currentToggleValue =! currentToggleValue;
 }
 
@@ -270,6 +272,7 @@ void CabbageImage::updateImage(ValueTree& valueTree)
         if (result)
         {
             img = ImageCache::getFromMemory(out.getData(), out.getDataSize());
+            usesImageFile = false;
         }
         else
         {
@@ -282,8 +285,8 @@ void CabbageImage::updateImage(ValueTree& valueTree)
             {
                 imgFile = File(path).getParentDirectory().getChildFile(fileBase64).getFullPathName();
             }
-            if (File(imgFile).existsAsFile())
-                img = ImageCache::getFromFile(imgFile);
+            img = Image();
+            usesImageFile = File(imgFile).existsAsFile() && ! imgFile.hasFileExtension(".svg");
         }
     }
 
@@ -22,6 +22,7 @@
 
 #include "../CabbageCommonHeaders.h"
 #include "CabbageWidgetBase.h"
+#include "../Utilities/CabbageImageCache.h"
 
 class CabbagePluginEditor;
 
@@ -37,6 +38,9 @@ class CabbageImage : public Component, public ValueTree::Listener, public Cabbag
     bool isLineWidget = false, isParent = false;
     bool currentToggleValue = 0;
     Image img;
+    //set when img comes from imgFile, which is decoded in the background
+    bool usesImageFile = false;
+    SharedResourcePointer<CabbageImageCache> imageCache;
     bool usesSVGElement = false;
     double prevWidth = 0, prevHeight = 0;
     std::unique_ptr<Drawable> drawable;
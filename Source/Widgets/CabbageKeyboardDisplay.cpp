@@ -24,6 +24,7 @@ CabbageKeyboardDisplay::CabbageKeyboardDisplay(ValueTree wData, CabbagePluginEdi
 	MidiKeyboardDisplay(MidiKeyboardDisplay::horizontalKeyboard),
     scrollbars(CabbageWidgetData::getNumProp(wData, CabbageIdentifierIds::scrollbars)),
     keyWidth(CabbageWidgetData::getNumProp(wData, CabbageIdentifierIds::keywidth)),
+    noteState(_owner->getProcessor().getKeyboardNoteState(wData.getType().toString())),
     widgetData(wData),
     CabbageWidgetBase(_owner)
 {
@@ -38,47 +39,37 @@ CabbageKeyboardDisplay::CabbageKeyboardDisplay(ValueTree wData, CabbagePluginEdi
 	setScrollButtonsVisible(scrollbars == 1 ? true : false);
     
 	updateColours(wData);
-    colourPressedNotes(wData);
+    updateKeys(noteState.getSnapshot());
 
+    //the processor sets the held notes as Csound sends them, they're shown at most once a frame
+    startTimerHz(60);
+}
+
+void CabbageKeyboardDisplay::timerCallback()
+{
+    updateKeys(noteState.getSnapshot());
 }
 
 void CabbageKeyboardDisplay::colourPressedNotes(ValueTree wData)
 {
-    var notesPressed = CabbageWidgetData::getProperty(wData, CabbageIdentifierIds::keypressed);
-    Array<var>* array = notesPressed.getArray();
-    Array<int> keys;
-    if (array)
-    {
-        if (array->size()>0)
-        {
-            for( int i = 0 ; i < array->size() ; i++)
-            {
-                if(!keys.contains(int(array->getReference(i))))
-                   keys.add(int(array->getReference(i)));
-            }
-            notesDown = keys;
-        }
-    }
-    else
-    {
-        const int note = CabbageWidgetData::getProperty(wData, CabbageIdentifierIds::keypressed);
-        notesDown = Array<int>(note);
-    }
-    
-    
-    updateKeys();
+    noteState.setNotes(CabbageWidgetData::getProperty(wData, CabbageIdentifierIds::keypressed));
+    updateKeys(noteState.getSnapshot());
 }
 void CabbageKeyboardDisplay::valueTreePropertyChanged(ValueTree& valueTree, const Identifier& prop)
 {
-	setOrientation(CabbageWidgetData::getStringProp(valueTree, CabbageIdentifierIds::kind) == "horizontal" ? MidiKeyboardDisplay::horizontalKeyboard : MidiKeyboardDisplay::verticalKeyboardFacingRight);
+    if (prop == CabbageIdentifierIds::keypressed)
+    {
+        colourPressedNotes(valueTree);
+        return;
+    }
 
+    if (prop == CabbageIdentifierIds::kind)
+	    setOrientation(CabbageWidgetData::getStringProp(valueTree, CabbageIdentifierIds::kind) == "horizontal" ? MidiKeyboardDisplay::horizontalKeyboard : MidiKeyboardDisplay::verticalKeyboardFacingRight);
 
-    
-	updateColours(valueTree);
-	handleCommonUpdates(this, valueTree, false, prop);      //handle comon updates such as bounds, alpha, rotation, visible, etc
-    
-    colourPressedNotes(valueTree);
+    if (prop.toString().containsIgnoreCase("colour"))
+	    updateColours(valueTree);
 
+	handleCommonUpdates(this, valueTree, false, prop);      //handle comon updates such as bounds, alpha, rotation, visible, etc
 }
 
 
@@ -428,7 +419,7 @@ void MidiKeyboardDisplay::paint(Graphics& g)
 			if (noteNum >= rangeStart && noteNum <= rangeEnd)
 				drawWhiteNote(noteNum, g, getRectangleForKey(noteNum),
 					false,
-					notesDown.contains(noteNum), lineColour, textColour);
+					keysCurrentlyDrawnDown[noteNum], lineColour, textColour);
 		}
 	}
 
@@ -486,7 +477,7 @@ void MidiKeyboardDisplay::paint(Graphics& g)
 			if (noteNum >= rangeStart && noteNum <= rangeEnd)
 				drawBlackNote(noteNum, g, getRectangleForKey(noteNum),
 					false,
-					notesDown.contains(noteNum), blackNoteColour);
+					keysCurrentlyDrawnDown[noteNum], blackNoteColour);
 		}
 	}
 }
@@ -871,13 +862,13 @@ void MidiKeyboardDisplay::mouseWheelMove(const MouseEvent&, const MouseWheelDeta
 }
 
 
-void MidiKeyboardDisplay::updateKeys()
+void MidiKeyboardDisplay::updateKeys(const BigInteger& notesDown)
 {
     bool isOn = false;
     for (int i = rangeStart; i <= rangeEnd; ++i)
     {
         
-        isOn = notesDown.contains(i);
+        isOn = notesDown[i];
 
         if (keysCurrentlyDrawnDown[i] != isOn)
         {
@@ -52,8 +52,8 @@ public:
 	~MidiKeyboardDisplay() override;
 
 	//==============================================================================
-    void updateKeys();
-    Array<int> notesDown;
+    //repaints only the keys whose state differs from the last update
+    void updateKeys(const BigInteger& notesDown);
 	void setVelocity(float velocity, bool useMousePositionForVelocity);
 	void setMidiChannel(int midiChannelNumber);
 	int getMidiChannel() const noexcept { return midiChannel; }
@@ -330,12 +330,15 @@ private:
 
 // Add any new custom widgets here to avoid having to edit makefiles and projects
 // Each Cabbage widget should inherit from ValueTree listener, and CabbageWidgetBase
-class CabbageKeyboardDisplay : public MidiKeyboardDisplay, public ValueTree::Listener, public CabbageWidgetBase
+class CabbageKeyboardDisplay : public MidiKeyboardDisplay, public ValueTree::Listener, public CabbageWidgetBase, private Timer
 {
 	int scrollbars;
 	float keyWidth;
 	String kind;
     CabbagePluginEditor* owner = {};
+    CabbageKeyboardNoteState& noteState;
+
+    void timerCallback() override;
 
 public:
 
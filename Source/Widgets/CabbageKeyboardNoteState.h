@@ -0,0 +1,89 @@
+/*
+  Copyright (C) 2016 Rory Walsh
+
+  Cabbage is free software; you can redistribute it
+  and/or modify it under the terms of the GNU General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  Cabbage is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU General Public
+  License along with Csound; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+  02111-1307 USA
+*/
+
+#ifndef CABBAGEKEYBOARDNOTESTATE_H_INCLUDED
+#define CABBAGEKEYBOARDNOTESTATE_H_INCLUDED
+
+#include "JuceHeader.h"
+
+//==============================================================================
+// The notes a keyboarddisplay shows as held, as 128 bits. The processor owns
+// one per keyboard and sets it whenever Csound sends new notes, and the display
+// takes a snapshot once a frame and repaints only the keys that changed. Reads
+// and writes are lock free. Each half is its own atomic, so a snapshot taken
+// mid-write can show one half of a new chord a frame before the other.
+//==============================================================================
+class CabbageKeyboardNoteState
+{
+public:
+    explicit CabbageKeyboardNoteState (const String& widgetName) : name (widgetName) {}
+
+    const String& getName() const noexcept     {   return name;   }
+
+    //accepts a single note number, or an array of them, as sent by cabbageSet or keyPressed()
+    void setNotes (const var& notes)
+    {
+        uint64 bits[2] = {};
+
+        auto addNote = [&bits] (int note)
+        {
+            if (isPositiveAndBelow (note, 128))
+                bits[note / 64] |= (uint64) 1 << (note % 64);
+        };
+
+        if (auto* array = notes.getArray())
+        {
+            for (auto& note : *array)
+                addNote (int (note));
+        }
+        else if (! notes.isVoid() && ! notes.isUndefined())
+        {
+            addNote (int (notes));
+        }
+
+        lowNotes.store (bits[0], std::memory_order_relaxed);
+        highNotes.store (bits[1], std::memory_order_relaxed);
+    }
+
+    void clear()
+    {
+        lowNotes.store (0, std::memory_order_relaxed);
+        highNotes.store (0, std::memory_order_relaxed);
+    }
+
+    //BigInteger keeps 128 bits inline, so taking a snapshot doesn't allocate
+    BigInteger getSnapshot() const
+    {
+        const uint64 halves[2] = { lowNotes.load (std::memory_order_relaxed), highNotes.load (std::memory_order_relaxed) };
+        BigInteger notes;
+
+        for (int i = 0; i < 4; ++i)
+            notes.setBitRangeAsInt (i * 32, 32, (uint32) (halves[i / 2] >> ((i % 2) * 32)));
+
+        return notes;
+    }
+
+private:
+    const String name;
+    std::atomic<uint64> lowNotes { 0 }, highNotes { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (CabbageKeyboardNoteState)
+};
+
+#endif  // CABBAGEKEYBOARDNOTESTATE_H_INCLUDED
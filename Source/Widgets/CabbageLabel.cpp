@@ -91,7 +91,7 @@ void CabbageLabel::mouseDown (const MouseEvent& event)
     if (!event.mods.isPopupMenu())
     {
         counter = (counter == 0 ? 1 : 0);
-        owner->sendChannelDataToCsound (getChannel(), counter);
+        owner->sendChannelDataToCsound (getChannelHandle(), counter);
     }
 }
 
@@ -96,7 +96,7 @@ CabbageListBox::CabbageListBox(ValueTree wData, CabbagePluginEditor* _owner):
         }
         else
         {
-            owner->sendChannelDataToCsound (getChannel(), getValue());
+            owner->sendChannelDataToCsound (getChannelHandle(), getValue());
             listBox.selectRow (getValue() - 1, dontSendNotification);
         }
     }
@@ -345,7 +345,7 @@ void CabbageListBox::clicked(int row)
         }
         
         owner->restorePluginStateFrom (presets[row], fileName.getFullPathName());
-        owner->sendChannelDataToCsound (getChannel(), row+1);
+        owner->sendChannelDataToCsound (getChannelHandle(), row+1);
     }
     else if (CabbageWidgetData::getStringProp (widgetData, CabbageIdentifierIds::channeltype).contains ("string"))
     {
@@ -358,7 +358,7 @@ void CabbageListBox::clicked(int row)
     }
     else
     {
-        owner->sendChannelDataToCsound(getChannel(), row+1);
+        owner->sendChannelDataToCsound(getChannelHandle(), row+1);
     }
 }
 
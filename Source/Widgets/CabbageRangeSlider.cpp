@@ -106,8 +106,8 @@ void CabbageRangeSlider::setSliderValues (ValueTree wData)
     slider.setSkewFactor (sliderSkew);
 
     slider.setMinAndMaxValues (minValue, maxValue, dontSendNotification);
-    owner->sendChannelDataToCsound(getChannelArray()[0], minValue);
-    owner->sendChannelDataToCsound(getChannelArray()[1], maxValue);
+    owner->sendChannelDataToCsound(getChannelArrayHandle(0), minValue);
+    owner->sendChannelDataToCsound(getChannelArrayHandle(1), maxValue);
 }
 
 void CabbageRangeSlider::setCurrentValues (float newMin, float newMax)
@@ -163,19 +163,16 @@ CabbageSlider::CabbageSlider(ValueTree wData, CabbagePluginEditor* _owner)
     sliderBounds = CabbageWidgetData::getProperty(wData, CabbageIdentifierIds::sliderbounds);
 
         
-    const File sliderImageFile = File(CabbageWidgetData::getStringProp(wData, CabbageIdentifierIds::csdfile)).getParentDirectory().getChildFile(CabbageWidgetData::getStringProp(wData, CabbageIdentifierIds::imgslider));
-    const File sliderBackgroundFile = File(CabbageWidgetData::getStringProp(wData, CabbageIdentifierIds::csdfile)).getParentDirectory().getChildFile(CabbageWidgetData::getStringProp(wData, CabbageIdentifierIds::imgsliderbg));
+    const File thumbFile = File(CabbageWidgetData::getStringProp(wData, CabbageIdentifierIds::csdfile)).getParentDirectory().getChildFile(CabbageWidgetData::getStringProp(wData, CabbageIdentifierIds::imgslider));
+    const File backgroundFile = File(CabbageWidgetData::getStringProp(wData, CabbageIdentifierIds::csdfile)).getParentDirectory().getChildFile(CabbageWidgetData::getStringProp(wData, CabbageIdentifierIds::imgsliderbg));
     if (!isFilmStripSlider) {
-        if (sliderImageFile.existsAsFile())
-        {
-            sliderThumbImage = ImageCache::getFromFile(sliderImageFile);
-            thumb.setThumbImage(sliderThumbImage);
-        }
-        if (sliderBackgroundFile.existsAsFile())
-        {
-            sliderBgImage = ImageCache::getFromFile(sliderBackgroundFile);
-        }
-        
+        //decoded in the background, and picked up in paint once they're ready
+        if (thumbFile.existsAsFile())
+            sliderImageFile = thumbFile;
+        if (backgroundFile.existsAsFile())
+            sliderBackgroundFile = backgroundFile;
+
+        updateSliderImages();
     }
     
     
@@ -225,8 +222,15 @@ CabbageSlider::~CabbageSlider()
 void CabbageSlider::paint(Graphics& g)
 {
     g.fillAll(Colours::transparentWhite);
+
+    if ((sliderImageFile != File() && sliderThumbImage.isNull()) || (sliderBackgroundFile != File() && sliderBgImage.isNull()))
+        updateSliderImages();
+
     if (isFilmStripSlider)
     {
+        if (filmStrip.isNull())
+            updateFilmStrip();
+
         const float sliderPos = (float)slider.valueToProportionOfLength(slider.getValue());
 
         int sliderValue = sliderPos * (numFrames - 1);
@@ -258,7 +262,6 @@ void CabbageSlider::initFilmStrip(ValueTree wData)
 {
     numFrames = CabbageWidgetData::getNumProp(wData, CabbageIdentifierIds::filmstripframes);
     String path = CabbageWidgetData::getStringProp(wData, CabbageIdentifierIds::csdfile);
-    File imageFile;
     if (path.isEmpty())
     {
         imageFile = File::getCurrentWorkingDirectory().getChildFile(CabbageWidgetData::getStringProp(wData, CabbageIdentifierIds::filmstripimage)).getFullPathName();
@@ -270,17 +273,47 @@ void CabbageSlider::initFilmStrip(ValueTree wData)
     
     if (imageFile.existsAsFile())
     {
+        //the strip is decoded in the background and drawn once it's ready
         isFilmStripSlider = true;
-        //ImageCache::addImageToCache(ImageFileFormat::loadFrom(imageFile), imageFile.hashCode64());
-        filmStrip = ImageCache::getFromFile(imageFile);
-        if (!filmStrip.isNull())
-        {
-            slider.getProperties().set("filmstrip", 1);
-            frameHeight = filmStrip.getHeight() / numFrames;
-            frameWidth = filmStrip.getWidth();
-        }
+        slider.getProperties().set("filmstrip", 1);
+        updateFilmStrip();
     }
 }
+
+void CabbageSlider::updateFilmStrip()
+{
+    filmStrip = imageCache->getImage(imageFile, 0, 0, this);
+
+    if (!filmStrip.isNull())
+    {
+        frameHeight = filmStrip.getHeight() / numFrames;
+        frameWidth = filmStrip.getWidth();
+    }
+}
+void CabbageSlider::updateSliderImages()
+{
+    const bool hadThumbImage = sliderThumbImage.isValid();
+
+    if (sliderImageFile != File())
+    {
+        sliderThumbImage = imageCache->getImage(sliderImageFile, 0, 0, this);
+        thumb.setThumbImage(sliderThumbImage);
+        thumb.repaint();
+    }
+
+    if (sliderBackgroundFile != File())
+        sliderBgImage = imageCache->getImage(sliderBackgroundFile, 0, 0, this);
+
+    //the thumb's size sets the slider's layout, which can't change in the middle of a paint
+    if (! hadThumbImage && sliderThumbImage.isValid())
+    {
+        MessageManager::callAsync([safeThis = Component::SafePointer<CabbageSlider>(this)] {
+            if (safeThis != nullptr)
+                safeThis->resized();
+        });
+    }
+}
+
 void CabbageSlider::initialiseSlider(ValueTree wData, Slider& currentSlider)
 {
     remove1 = CabbageWidgetData::getNumProp(wData, CabbageIdentifierIds::filmStripRemoveFrom1);
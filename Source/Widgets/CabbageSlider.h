@@ -118,6 +118,7 @@ class CabbageSlider
     Slider slider;
     BubbleMessageComponent popupBubble;
     Image sliderThumbImage, sliderBgImage;
+    File sliderImageFile, sliderBackgroundFile;
 
     void mouseDrag (const MouseEvent& event) override;
     void mouseMove (const MouseEvent& event) override;
@@ -141,6 +142,7 @@ class CabbageSlider
     bool imageIsNull = true;
     Image filmStrip;
     File imageFile;
+    SharedResourcePointer<CabbageImageCache> imageCache;
     int frameWidth = 32, frameHeight = 32;
    juce::Rectangle<float> filmStripBounds = {0, 0, 80, 80};
     Label filmStripValueBox;
@@ -153,6 +155,8 @@ public:
 
     void showPopupBubble(int time);
     void initFilmStrip(ValueTree wData);
+    void updateFilmStrip();
+    void updateSliderImages();
     void setTextBoxWidth();
     void setSliderVelocity (ValueTree wData);
     void resized() override;
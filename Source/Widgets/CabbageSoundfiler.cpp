@@ -99,12 +99,12 @@ void CabbageSoundfiler::changeListenerCallback (ChangeBroadcaster* source)
     const float position = getScrubberPosition();
     const float length = getLoopLength();
 
-    owner->sendChannelDataToCsound (getChannelArray()[0], position);
+    owner->sendChannelDataToCsound (getChannelArrayHandle(0), position);
     CabbageWidgetData::setNumProp(widgetData, CabbageIdentifierIds::regionstart, position);
     CabbageWidgetData::setNumProp(widgetData, CabbageIdentifierIds::regionlength, length);
 
     if (getChannelArray().size() > 1)
-        owner->sendChannelDataToCsound (getChannelArray()[1], length);
+        owner->sendChannelDataToCsound (getChannelArrayHandle(1), length);
 }
 
 void CabbageSoundfiler::resized()
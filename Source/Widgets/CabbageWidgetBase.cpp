@@ -45,6 +45,7 @@ void CabbageWidgetBase::initialiseCommonAttributes (Component* child, ValueTree
     visible = CabbageWidgetData::getNumProp (data, CabbageIdentifierIds::visible);
     active = CabbageWidgetData::getNumProp (data, CabbageIdentifierIds::active);
     channel = CabbageWidgetData::getStringProp (data, CabbageIdentifierIds::channel);
+    channelHandle = resolveChannelHandle (channel);
     file = CabbageWidgetData::getStringProp (data, CabbageIdentifierIds::file);
     tooltipText = CabbageWidgetData::getStringProp (data, CabbageIdentifierIds::popuptext);
     child->setBounds (CabbageWidgetData::getBounds (data));
@@ -189,10 +190,19 @@ void CabbageWidgetBase::setChannel (ValueTree data)
     if ( channel != CabbageWidgetData::getStringProp (data, CabbageIdentifierIds::channel))
     {
         channel = CabbageWidgetData::getStringProp (data, CabbageIdentifierIds::channel);
+        channelHandle = resolveChannelHandle (channel);
         CabbageWidgetData::setProperty (data, CabbageIdentifierIds::channel,  channel);
     }
 }
 
+int CabbageWidgetBase::resolveChannelHandle (const String& channelName) const
+{
+    if (editor == nullptr || channelName.isEmpty())
+        return -1;
+
+    return editor->getChannelHandle (channelName);
+}
+
 float CabbageWidgetBase::getCurrentValue (ValueTree data)
 {
     if ( currentValue != CabbageWidgetData::getNumProp (data, CabbageIdentifierIds::value))
@@ -220,6 +230,11 @@ void CabbageWidgetBase::populateTextArrays (ValueTree data)
 
     channelArray.add (CabbageWidgetData::getStringProp (data, CabbageIdentifierIds::channel));
 
+    channelArrayHandles.clearQuick();
+
+    for (const auto& channelName : channelArray)
+        channelArrayHandles.add (resolveChannelHandle (channelName));
+
     const Array<var>* textArrayVar = CabbageWidgetData::getProperty (data, CabbageIdentifierIds::text).getArray();
 
     if (textArrayVar && textArrayVar->size() > 1)
@@ -34,6 +34,8 @@ class CabbageWidgetBase
     float rotate = 0.f, alpha = 0.f, currentValue = 0.f;
     String tooltipText = {}, text = {}, channel = {}, csdFile = {}, file = {}, behind ={};
     StringArray channelArray = {};   //can be used if widget supports multiple channels
+    int channelHandle = -1;          //mailbox handles for the above, see CabbagePluginEditor::getChannelHandle()
+    Array<int> channelArrayHandles;
     StringArray textArray = {};      //can be used used if widget supports multiple text items
     CabbagePluginEditor* editor;
     int customRadioGroupId = 0;
@@ -66,6 +68,14 @@ public:
     {
         return channelArray;
     }
+    int getChannelHandle() const
+    {
+        return channelHandle;
+    }
+    int getChannelArrayHandle (int index) const
+    {
+        return isPositiveAndBelow (index, channelArrayHandles.size()) ? channelArrayHandles.getUnchecked (index) : -1;
+    }
     const String&  getCsdFile() const
     {
         return csdFile;
@@ -144,6 +154,7 @@ public:
 
     void populateTextArrays (ValueTree data);
     void setChannel (ValueTree value);
+    int resolveChannelHandle (const String& channelName) const;
     float getCurrentValue (ValueTree data);
     static int getSVGHeight (File svgFile);
     static int getSVGWidth (File svgFile);
@@ -20,6 +20,8 @@
 
 
 #include "CabbageWidgetData.h"
+#include <map>
+#include <set>
 #define MAX_MATRIX_SIZE 64
 
 //#include "CabbageWidgetDataInitMethods.cpp"
@@ -30,8 +32,188 @@ constexpr unsigned long long int HashStringToInt (const char* str, unsigned long
 {
     return (*str == 0) ? hash : 101 * HashStringToInt (str + 1) + *str;
 }
+//===============================================================================
+// Defaults for one type of widget. They are built once per type by running
+// setDefaultProperties() for two different IDs, and every widget of that type
+// then copies them from here. Properties that differ between the two runs
+// are the ones with the ID appended, such as names and default channels, and
+// those get the widget's own ID added back on. Types whose defaults depend
+// on the ID in any other way are never cached.
+//===============================================================================
+namespace
+{
+    struct DefaultProperty
+    {
+        enum Kind { shared, lineNumber, numberedText, numberedArray };
+
+        Identifier name;
+        Kind kind = shared;
+        var value;                  //the value, or the text before the ID for numbered properties
+        BigInteger numberedItems;   //for arrays, the items that end in the ID
+    };
+
+    struct WidgetTypeDefaults
+    {
+        Array<DefaultProperty> properties;
+        bool isCacheable = true;
+    };
+
+    const int firstSampleID = 1000003, secondSampleID = 2000003;
+
+    bool getNumberedPrefix (const var& first, const var& second, var& prefix)
+    {
+        if (! first.isString() || ! second.isString())
+            return false;
+
+        const String firstText = first.toString(), firstSuffix (firstSampleID);
+
+        if (! firstText.endsWith (firstSuffix))
+            return false;
+
+        prefix = firstText.dropLastCharacters (firstSuffix.length());
+        return second.toString() == prefix.toString() + String (secondSampleID);
+    }
+
+    DefaultProperty compareDefaults (const Identifier& name, const var& first, const var& second, bool& isCacheable)
+    {
+        DefaultProperty property;
+        property.name = name;
+        property.value = first;
+
+        if (first == second)
+            return property;
+
+        if ((first.isInt() || first.isDouble()) && (int) first == firstSampleID && (int) second == secondSampleID)
+        {
+            property.kind = DefaultProperty::lineNumber;
+            return property;
+        }
+
+        if (getNumberedPrefix (first, second, property.value))
+        {
+            property.kind = DefaultProperty::numberedText;
+            return property;
+        }
+
+        if (first.isArray() && second.isArray() && first.size() == second.size())
+        {
+            property.kind = DefaultProperty::numberedArray;
+            property.value = first.clone();
+
+            for (int i = 0; i < first.size(); ++i)
+            {
+                if (first[i] == second[i])
+                    continue;
+
+                var prefix;
+
+                if (! getNumberedPrefix (first[i], second[i], prefix))
+                    isCacheable = false;
+
+                property.value[i] = prefix;
+                property.numberedItems.setBit (i);
+            }
+
+            return property;
+        }
+
+        isCacheable = false;
+        return property;
+    }
+
+    const WidgetTypeDefaults& getWidgetTypeDefaults (const String& widgetType)
+    {
+        static CriticalSection lock;
+        static std::map<String, std::unique_ptr<WidgetTypeDefaults>> defaultsForType;
+
+        const ScopedLock sl (lock);
+
+        //the first word of every line is looked up, widget or not, so unknown words stop being cached at some point
+        if (defaultsForType.size() >= 256 && defaultsForType.find (widgetType) == defaultsForType.end())
+        {
+            static const WidgetTypeDefaults uncached { {}, false };
+            return uncached;
+        }
+
+        auto& defaults = defaultsForType[widgetType];
+
+        if (defaults == nullptr)
+        {
+            defaults.reset (new WidgetTypeDefaults());
+
+            ValueTree first ("defaults"), second ("defaults");
+            CabbageWidgetData::setDefaultProperties (first, widgetType, firstSampleID);
+            CabbageWidgetData::setDefaultProperties (second, widgetType, secondSampleID);
+
+            defaults->isCacheable = first.getNumProperties() == second.getNumProperties();
+
+            for (int i = 0; i < first.getNumProperties() && defaults->isCacheable; ++i)
+            {
+                const Identifier name = first.getPropertyName (i);
+
+                if (! second.hasProperty (name))
+                    defaults->isCacheable = false;
+                else
+                    defaults->properties.add (compareDefaults (name, first[name], second[name], defaults->isCacheable));
+            }
+        }
+
+        return *defaults;
+    }
+}
+
 //===============================================================================
 void CabbageWidgetData::setWidgetState (ValueTree widgetData, const String lineFromCsd, int ID)
+{
+    StringArray strTokens;
+    strTokens.addTokens (lineFromCsd, " ", "\"");
+    const String widgetType = strTokens[0].trim();
+
+    const WidgetTypeDefaults& defaults = getWidgetTypeDefaults (widgetType);
+
+    if (defaults.isCacheable)
+    {
+        for (auto& property : defaults.properties)
+        {
+            switch (property.kind)
+            {
+                case DefaultProperty::shared:
+                    setProperty (widgetData, property.name, property.value);
+                    break;
+
+                case DefaultProperty::lineNumber:
+                    setProperty (widgetData, property.name, ID);
+                    break;
+
+                case DefaultProperty::numberedText:
+                    setProperty (widgetData, property.name, property.value.toString() + String (ID));
+                    break;
+
+                case DefaultProperty::numberedArray:
+                {
+                    var items;
+
+                    for (int i = 0; i < property.value.size(); ++i)
+                        items.append (property.numberedItems[i] ? var (property.value[i].toString() + String (ID))
+                                                                : property.value[i]);
+
+                    setProperty (widgetData, property.name, items);
+                    break;
+                }
+            }
+        }
+    }
+    else
+    {
+        setDefaultProperties (widgetData, widgetType, ID);
+    }
+
+    //parse the text now that all default values have been assigned
+    setCustomWidgetState (widgetData, lineFromCsd);
+}
+
+//===============================================================================
+void CabbageWidgetData::setDefaultProperties (ValueTree widgetData, const String& widgetType, int ID)
 {
     setProperty (widgetData, CabbageIdentifierIds::scalex, 1);
     setProperty (widgetData, CabbageIdentifierIds::scaley, 1);
@@ -73,16 +255,10 @@ void CabbageWidgetData::setWidgetState (ValueTree widgetData, const String lineF
     setProperty(widgetData, CabbageIdentifierIds::opcode6dir64, "");
     setProperty(widgetData, CabbageIdentifierIds::openGL, 0);
 
-
-    StringArray strTokens;
-    strTokens.addTokens (lineFromCsd, " ", "\"");
-
-    if(strTokens.size()>0)
-        setProperty (widgetData, CabbageIdentifierIds::type, strTokens[0].trim());
+    if(widgetType.isNotEmpty())
+        setProperty (widgetData, CabbageIdentifierIds::type, widgetType);
 
     setProperty (widgetData, CabbageIdentifierIds::widgetarray, "");
-
-    const String widgetType = strTokens[0].trim();
     
     if (widgetType == CabbageWidgetTypes::hslider)
         setHSliderProperties (widgetData, ID);
@@ -276,9 +452,6 @@ void CabbageWidgetData::setWidgetState (ValueTree widgetData, const String lineF
     {
         setProperty (widgetData, CabbageIdentifierIds::type, widgetType);
     }
-
-    //parse the text now that all default values ahve been assigned
-    setCustomWidgetState (widgetData, lineFromCsd);
 }
 
 //===========================================================================================
@@ -479,6 +652,7 @@ void CabbageWidgetData::setCustomWidgetState (ValueTree widgetData, const String
             case HashStringToInt ("scrollbars"):
             case HashStringToInt ("sidechain"):
             case HashStringToInt ("sliderSkew"):
+            case HashStringToInt ("smoothing"):
             case HashStringToInt ("surrogatelinenumber"):
             case HashStringToInt ("textBox"):
             case HashStringToInt ("titleBarGradient"):
@@ -565,6 +739,8 @@ void CabbageWidgetData::setCustomWidgetState (ValueTree widgetData, const String
                 break;
             case HashStringToInt ("popup"):
             case HashStringToInt ("numberOfSteps"):
+            case HashStringToInt ("stepsPerBeat"):
+            case HashStringToInt ("automationRamp"):
             case HashStringToInt ("showstepnumbers"):
             case HashStringToInt ("bpm"):
             case HashStringToInt ("cellWidth"):
@@ -1407,6 +1583,65 @@ var CabbageWidgetData::getProperty (ValueTree widgetData, Identifier name)
     return widgetData.getProperty (name);
 }
 
+Identifier CabbageWidgetData::getLineIdentifier (int lineNumber)
+{
+    static CriticalSection lock;
+    static Array<Identifier> lineIdentifiers;
+
+    if (lineNumber < 0)
+        return Identifier ("WidgetFromLine_" + String (lineNumber));
+
+    const ScopedLock sl (lock);
+
+    while (lineIdentifiers.size() <= lineNumber)
+        lineIdentifiers.add (Identifier ("WidgetFromLine_" + String (lineIdentifiers.size())));
+
+    return lineIdentifiers.getReference (lineNumber);
+}
+
+//===========================================================================================
+static void addVarMemoryUsage (const var& value, std::set<const void*>& counted, size_t& total)
+{
+    if (value.isString())
+    {
+        //copies of a String share its text, so each block of text is only counted once
+        const String text (value.toString());
+
+        if (text.isNotEmpty() && counted.insert (text.getCharPointer().getAddress()).second)
+            total += text.getNumBytesAsUTF8() + 1 + 2 * sizeof (void*);
+    }
+    else if (const auto* array = value.getArray())
+    {
+        if (counted.insert (array).second)
+        {
+            total += sizeof (Array<var>) + (size_t) array->size() * sizeof (var);
+
+            for (auto& item : *array)
+                addVarMemoryUsage (item, counted, total);
+        }
+    }
+}
+
+size_t CabbageWidgetData::getMemoryUsage (const ValueTree& widgets)
+{
+    std::set<const void*> counted;
+    size_t total = 0;
+
+    std::function<void (const ValueTree&)> addTree = [&] (const ValueTree& tree)
+    {
+        total += sizeof (NamedValueSet) + (size_t) tree.getNumProperties() * sizeof (NamedValueSet::NamedValue);
+
+        for (int i = 0; i < tree.getNumProperties(); ++i)
+            addVarMemoryUsage (tree[tree.getPropertyName (i)], counted, total);
+
+        for (const auto& child : tree)
+            addTree (child);
+    };
+
+    addTree (widgets);
+    return total;
+}
+
 //================================================================================================
 ValueTree CabbageWidgetData::getValueTreeForComponent (ValueTree widgetData, String name, bool searchByChannel)
 {
@@ -45,6 +45,12 @@ public:
     //============================================================================
     static void setWidgetState (ValueTree widgetData, const String lineFromCsd, int ID);
     static void setCustomWidgetState (ValueTree widgetData, const String lineFromCsd);
+    //builds every default for a type from scratch, setWidgetState() copies them from a per-type table instead
+    static void setDefaultProperties (ValueTree widgetData, const String& widgetType, int ID);
+    //the same Identifier for a line number every time, rather than a new one in the string pool
+    static Identifier getLineIdentifier (int lineNumber);
+    //approximate heap bytes used by a tree of widgets, counting shared strings and arrays once
+    static size_t getMemoryUsage (const ValueTree& widgets);
     //============================================================================
     // these methods are implemented in CabbageWidgetDataInitMethods.h
     static void setCheckBoxProperties (ValueTree widgetData, int ID);
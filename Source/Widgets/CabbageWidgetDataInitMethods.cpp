@@ -285,6 +285,7 @@ void CabbageWidgetData::setEventSequencerProperties (ValueTree widgetData, int I
     setProperty (widgetData, CabbageIdentifierIds::visible, 1);
     setProperty (widgetData, CabbageIdentifierIds::value, 1);
     setProperty (widgetData, CabbageIdentifierIds::numberofsteps, 16);
+    setProperty (widgetData, CabbageIdentifierIds::stepsperbeat, 0);
     setProperty (widgetData, CabbageIdentifierIds::bpm, 60);
     setProperty (widgetData, CabbageIdentifierIds::cellwidth, 0);
     setProperty (widgetData, CabbageIdentifierIds::cellheight, 0);
@@ -151,11 +151,18 @@ void CabbageXYPad::changeListenerCallback (ChangeBroadcaster* source)
 {
     if (XYPadAutomator* xyAuto = dynamic_cast<XYPadAutomator*> (source))
     {
-        juce::Point<float> pos (getValueAsPosition (juce::Point<float> (xyAuto->getPosition().getX(), xyAuto->getPosition().getY())));
+        //the automator has already set the parameters, this only follows it on screen
+        const juce::Point<double> position = xyAuto->getPosition();
+        juce::Point<float> pos (getValueAsPosition (position.toFloat()));
         pos.addXY (-ball.getWidth() / 2, -ball.getWidth() / 2);
         ball.setBounds (pos.getX(), pos.getY(), 20, 20);
 
-        setValues (xyAuto->getPosition().getX(), xyAuto->getPosition().getY());
+        const float x = (float) position.getX();
+        const float y = minY + (maxY - (float) position.getY());
+        xAxis.setValue (x, dontSendNotification);
+        yAxis.setValue (y, dontSendNotification);
+        xValueLabel.setText (createValueText (x, 3, xPrefix, xPostfix), dontSendNotification);
+        yValueLabel.setText (createValueText (y, 3, yPrefix, yPostfix), dontSendNotification);
 
         if (xyAuto->getShouldRepaintBackground() == true)
         {
@@ -329,44 +336,74 @@ XYPadAutomator::XYPadAutomator (String xyName, CabbagePluginParameter* xParam, C
 {}
 
 
-void XYPadAutomator::timerCallback()
+void XYPadAutomator::start (const Line<float>& dragLine)
 {
-    xValue += xValueIncrement;
-    position.setX (xValue);
+    const SpinLock::ScopedLockType sl (motionLock);
+    xValue = dragLine.getEndX();
+    yValue = dragLine.getEndY();
+    //the ball used to move 5% of the drag line on each 20ms timer tick
+    xVelocity = (dragLine.getEndX() - dragLine.getStartX()) * 2.5;
+    yVelocity = (dragLine.getEndY() - dragLine.getStartY()) * 2.5;
+    xPosition = xValue;
+    yPosition = yValue;
+    repaintBackground = true;
+    running = true;
+}
 
-    yValue += yValueIncrement;
-    position.setY (yValue);
+void XYPadAutomator::stop()
+{
+    running = false;
+}
 
-    // If a border is hit then the increment value should be reversed...
-    if (xValue <= xMin)
-    {
-        xValue = xMin;
-        xValueIncrement *= -1;
-    }
-    else if (xValue >= xMax)
-    {
-        xValue = xMax;
-        xValueIncrement *= -1;
-    }
+void XYPadAutomator::advance (double seconds)
+{
+    const SpinLock::ScopedTryLockType sl (motionLock);
 
-    if (yValue <= yMin)
-    {
-        yValue = yMin;
-        yValueIncrement *= -1;
-    }
-    else if (yValue >= yMax)
+    if (! sl.isLocked() || ! running.load())
+        return;
+
+    xValue += xVelocity * seconds;
+    yValue += yVelocity * seconds;
+
+    // If a border is hit then the direction should be reversed...
+    if (xValue <= xMin || xValue >= xMax)
     {
-        yValue = yMax;
-        yValueIncrement *= -1;
+        xValue = jlimit ((double) xMin, (double) xMax, xValue);
+        xVelocity *= -1;
     }
 
-    if (owner->editorIsOpen && xParam != nullptr && yParam != nullptr) //only update GUI is editor is open
+    if (yValue <= yMin || yValue >= yMax)
     {
-        sendSynchronousChangeMessage();
+        yValue = jlimit ((double) yMin, (double) yMax, yValue);
+        yVelocity *= -1;
     }
-    else
+
+    xPosition = xValue;
+    yPosition = yValue;
+
+    if (xParam != nullptr && yParam != nullptr)
     {
-        xParam->setValue (xValue / xMax);
-        yParam->setValue (yValue / yMax);
+        const auto values = getNormalisedValues();
+        xParam->setValue (values.getX());
+        yParam->setValue (values.getY());
     }
 }
+
+void XYPadAutomator::notifyHost()
+{
+    if (xParam == nullptr || yParam == nullptr)
+        return;
+
+    //the audio thread has already set these values, this only lets the host see and record them
+    const auto values = getNormalisedValues();
+    xParam->setValueNotifyingHost (values.getX());
+    yParam->setValueNotifyingHost (values.getY());
+}
+
+juce::Point<float> XYPadAutomator::getNormalisedValues() const
+{
+    //y runs top to bottom on screen, see CabbageXYPad::setValues()
+    const auto position = getPosition();
+    return { xParam->getNormalisableRange().convertTo0to1 (jlimit (xMin, xMax, (float) position.getX())),
+             yParam->getNormalisableRange().convertTo0to1 (jlimit (yMin, yMax, (float) (yMin + (yMax - position.getY())))) };
+}
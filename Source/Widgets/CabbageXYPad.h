@@ -124,108 +124,73 @@ public:
 };
 
 //=============================================================================
-class XYPadAutomator : public ChangeBroadcaster, public Timer
+// Throws the xypad ball along the line it was right-dragged. The processor
+// advances it on every k-cycle by sample time, so the motion is the same with
+// the editor closed and in offline renders. The editor is sent a change
+// message from the message thread, and only reads the position back.
+class XYPadAutomator : public ChangeBroadcaster
 {
     String name;
     CabbagePluginParameter* xParam, *yParam;
-    float xValue = 0;
-    float yValue = 0;
-    float xValueIncrement = 1;
-    float yValueIncrement = 1;
-    Line<float> dragLine;
-    bool isPluginEditorOpen = false;
+    float xMin = 0, xMax = 1, yMin = 0, yMax = 1;
     bool repaintBackground = false;
-    juce::Point<double> position;
-    float xMin, xMax, yMin, yMax, velocity;
     CabbagePluginProcessor* owner;
 
+    //motion state, owned by the audio thread while running
+    SpinLock motionLock;
+    double xValue = 0, yValue = 0;
+    double xVelocity = 0, yVelocity = 0;
+    std::atomic<bool> running { false };
+    std::atomic<double> xPosition { 0 }, yPosition { 0 };
+
+    juce::Point<float> getNormalisedValues() const;
+
 public:
     XYPadAutomator (String name, CabbagePluginParameter* xParam, CabbagePluginParameter* yParam, CabbagePluginProcessor* _owner);
 
     ~XYPadAutomator() override
     {
-        stopTimer();
         removeAllChangeListeners();
     }
 
-    void timerCallback() override;
-    String getName()
-    {
-        return name;
-    }
-    void setDragLine (const Line<float>& newDragLine)
-    {
-        this->dragLine = newDragLine;
-    }
-    void setIsPluginEditorOpen (bool isEditorOpen)
+    //message thread
+    void start (const Line<float>& dragLine);
+    void stop();
+
+    //audio thread, moves the ball on by a number of seconds and updates the host parameters
+    void advance (double seconds);
+
+    //message thread, tells the host about the values advance() last set. Called
+    //from the processor's timer, so the host hears about them at its rate
+    void notifyHost();
+
+    bool isRunning() const
     {
-        this->isPluginEditorOpen = isEditorOpen;
+        return running.load();
     }
-    void setName (const String& newName)
+    String getName()
     {
-        this->name = newName;
+        return name;
     }
-    void setPosition (const juce::Point<double>& newPosition)
+    void setRange (float newXMin, float newXMax, float newYMin, float newYMax)
     {
-        this->position = newPosition;
+        xMin = newXMin;
+        xMax = newXMax;
+        yMin = newYMin;
+        yMax = newYMax;
     }
     void setRepaintBackground (bool paintBackground)
     {
         this->repaintBackground = paintBackground;
     }
-    void setVelocity (float newVelocity)
-    {
-        this->velocity = newVelocity;
-    }
-    void setXMax (float newXMax)
-    {
-        this->xMax = newXMax;
-    }
-    void setXMin (float newXMin)
-    {
-        this->xMin = newXMin;
-    }
-    void setXValue (float newXValue)
-    {
-        this->xValue = newXValue;
-    }
-    void setXValueIncrement (float newXValueIncrement)
-    {
-        this->xValueIncrement = newXValueIncrement;
-    }
-    void setYMax (float newYMax)
-    {
-        this->yMax = newYMax;
-    }
-    void setYMin (float newYMin)
-    {
-        this->yMin = newYMin;
-    }
-    void setYValue (float newYValue)
-    {
-        this->yValue = newYValue;
-    }
-    void setYValueIncrement (float newYValueIncrement)
-    {
-        this->yValueIncrement = newYValueIncrement;
-    }
-    bool getIsPluginEditorOpen() const
-    {
-        return isPluginEditorOpen;
-    }
-    const juce::Point<double>& getPosition() const
-    {
-        return position;
-    }
     bool getShouldRepaintBackground() const
     {
         return repaintBackground;
     }
-    float getXValueIncrement() const
+    juce::Point<double> getPosition() const
     {
-        return xValueIncrement;
+        return { xPosition.load(), yPosition.load() };
     }
-
 };
 
 #endif  // CABBAGEXYPAD_H_INCLUDED